@@ -20,6 +20,12 @@ Make sure that the comment is aligned:
 PHP_ARG_ENABLE(ssdb-igbinary, whether to enable igbinary serializer support,
 [  --enable-ssdb-igbinary      Enable igbinary serializer support], no, no)
 
+PHP_ARG_WITH(ssdb-lz4, whether to enable lz4 compression support,
+[  --with-ssdb-lz4[=DIR]       Enable lz4 compression support], no, no)
+
+PHP_ARG_WITH(ssdb-zstd, whether to enable zstd compression support,
+[  --with-ssdb-zstd[=DIR]      Enable zstd compression support], no, no)
+
 if test "$PHP_SSDB" != "no"; then
   if test "$PHP_SSDB_IGBINARY" != "no"; then
     AC_MSG_CHECKING([for igbinary includes])
@@ -62,6 +68,58 @@ if test "$PHP_SSDB" != "no"; then
     AC_MSG_RESULT([disabled])
   fi
 
+  if test "$PHP_SSDB_LZ4" != "no"; then
+    AC_MSG_CHECKING([for lz4 includes])
+    for i in $PHP_SSDB_LZ4 /usr/local /usr; do
+      if test -r $i/include/lz4.h; then
+        LZ4_DIR=$i
+        break
+      fi
+    done
+    if test -z "$LZ4_DIR"; then
+      AC_MSG_ERROR([Cannot find lz4.h])
+    fi
+    AC_MSG_RESULT([$LZ4_DIR])
+
+    PHP_CHECK_LIBRARY(lz4, LZ4_compress_default,
+    [
+      PHP_ADD_INCLUDE($LZ4_DIR/include)
+      PHP_ADD_LIBRARY_WITH_PATH(lz4, $LZ4_DIR/$PHP_LIBDIR, SSDB_SHARED_LIBADD)
+      AC_DEFINE(HAVE_SSDB_LZ4,1,[Whether ssdb lz4 compression is enabled])
+    ],[
+      AC_MSG_ERROR([lz4 >= 1.7.3 not found])
+    ],[
+      -L$LZ4_DIR/$PHP_LIBDIR
+    ])
+  fi
+
+  if test "$PHP_SSDB_ZSTD" != "no"; then
+    AC_MSG_CHECKING([for zstd includes])
+    for i in $PHP_SSDB_ZSTD /usr/local /usr; do
+      if test -r $i/include/zstd.h; then
+        ZSTD_DIR=$i
+        break
+      fi
+    done
+    if test -z "$ZSTD_DIR"; then
+      AC_MSG_ERROR([Cannot find zstd.h])
+    fi
+    AC_MSG_RESULT([$ZSTD_DIR])
+
+    PHP_CHECK_LIBRARY(zstd, ZSTD_getFrameContentSize,
+    [
+      PHP_ADD_INCLUDE($ZSTD_DIR/include)
+      PHP_ADD_LIBRARY_WITH_PATH(zstd, $ZSTD_DIR/$PHP_LIBDIR, SSDB_SHARED_LIBADD)
+      AC_DEFINE(HAVE_SSDB_ZSTD,1,[Whether ssdb zstd compression is enabled])
+    ],[
+      AC_MSG_ERROR([zstd >= 1.3.0 not found])
+    ],[
+      -L$ZSTD_DIR/$PHP_LIBDIR
+    ])
+  fi
+
+  PHP_SUBST(SSDB_SHARED_LIBADD)
+
   dnl # --with-ssdb -> check with-path
   dnl SEARCH_PATH="/usr/local /usr"     # you might want to change this
   dnl SEARCH_FOR="/include/ssdb.h"  # you most likely want to change this
@@ -104,6 +162,15 @@ if test "$PHP_SSDB" != "no"; then
   PHP_NEW_EXTENSION(ssdb, ssdb_library.c \
                           ssdb_class.c \
                           ssdb_geo.c \
+                          ssdb_result.c \
+                          ssdb_scan.c \
+                          ssdb_pool.c \
+                          ssdb_shm.c \
+                          ssdb_compress.c \
+                          ssdb_msgpack.c \
+                          ssdb_cluster.c \
+                          ssdb_batch.c \
+                          ssdb_command.c \
                           geo/geohash.c \
                           geo/geohash_helper.c \
                           ssdb.c, $ext_shared)
@@ -46,15 +46,21 @@ PHP_MINFO_FUNCTION(ssdb);
 
 PHP_FUNCTION(ssdb_version);
 
-/* 
-  	Declare any global variables you may need between the BEGIN
-	and END macros here:     
-
 ZEND_BEGIN_MODULE_GLOBALS(ssdb)
-	long  global_value;
-	char *global_string;
+	HashTable pool;           //连接池 endpoint => SSDBPoolEndpoint*
+	long pool_max_idle;       //每个endpoint最多保留的空闲连接数,0为不启用连接池
+	long pool_min_idle;       //超时回收时至少保留的空闲连接数
+	long pool_idle_timeout;   //空闲连接超时时间,单位秒
+	zend_bool pool_ping;      //取出空闲连接时是否先ping检查
+	long shm_cache_size;      //跨请求共享内存缓存的总大小,0为不启用
+	long shm_cache_slot_size; //每个缓存项host:port+key+field+value的最大字节数
+	char *compression_dict;   //zstd字典文件路径,逗号分隔,第一个用于压缩
 ZEND_END_MODULE_GLOBALS(ssdb)
-*/
+
+ZEND_EXTERN_MODULE_GLOBALS(ssdb)
+
+PHP_FUNCTION(ssdb_pool_stats);
+PHP_FUNCTION(ssdb_shm_cache_stats);
 
 /* In every utility function you add that needs to use variables 
    in php_ssdb_globals, call TSRMLS_FETCH(); after declaring other 
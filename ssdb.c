@@ -27,11 +27,13 @@
 #include "ext/standard/info.h"
 #include "php_ssdb.h"
 
+#include "ssdb_library.h"
 #include "ssdb_class.h"
+#include "ssdb_pool.h"
+#include "ssdb_shm.h"
+#include "ssdb_compress.h"
 
-/* If you declare any globals in php_ssdb.h uncomment this:
 ZEND_DECLARE_MODULE_GLOBALS(ssdb)
-*/
 
 /* {{{ ssdb_functions[]
  *
@@ -39,10 +41,15 @@ ZEND_DECLARE_MODULE_GLOBALS(ssdb)
  */
 const zend_function_entry ssdb_functions[] = {
 	PHP_FE(ssdb_version, NULL)
+	PHP_FE(ssdb_pool_stats, NULL)
+	PHP_FE(ssdb_shm_cache_stats, NULL)
 	PHP_FE_END	/* Must be the last line in ssdb_functions[] */
 };
 /* }}} */
 
+static PHP_GINIT_FUNCTION(ssdb);
+static PHP_GSHUTDOWN_FUNCTION(ssdb);
+
 /* {{{ ssdb_module_entry
  */
 zend_module_entry ssdb_module_entry = {
@@ -59,7 +66,11 @@ zend_module_entry ssdb_module_entry = {
 #if ZEND_MODULE_API_NO >= 20010901
 	PHP_SSDB_VERSION,
 #endif
-	STANDARD_MODULE_PROPERTIES
+	PHP_MODULE_GLOBALS(ssdb),
+	PHP_GINIT(ssdb),
+	PHP_GSHUTDOWN(ssdb),
+	NULL,
+	STANDARD_MODULE_PROPERTIES_EX
 };
 /* }}} */
 
@@ -69,34 +80,58 @@ ZEND_GET_MODULE(ssdb)
 
 /* {{{ PHP_INI
  */
-/* Remove comments and fill if you need to have entries in php.ini
 PHP_INI_BEGIN()
-    STD_PHP_INI_ENTRY("ssdb.global_value",      "42", PHP_INI_ALL, OnUpdateLong, global_value, zend_ssdb_globals, ssdb_globals)
-    STD_PHP_INI_ENTRY("ssdb.global_string", "foobar", PHP_INI_ALL, OnUpdateString, global_string, zend_ssdb_globals, ssdb_globals)
+    STD_PHP_INI_ENTRY("ssdb.pool_max_idle",     "0",  PHP_INI_ALL, OnUpdateLong, pool_max_idle,     zend_ssdb_globals, ssdb_globals)
+    STD_PHP_INI_ENTRY("ssdb.pool_min_idle",     "0",  PHP_INI_ALL, OnUpdateLong, pool_min_idle,     zend_ssdb_globals, ssdb_globals)
+    STD_PHP_INI_ENTRY("ssdb.pool_idle_timeout", "60", PHP_INI_ALL, OnUpdateLong, pool_idle_timeout, zend_ssdb_globals, ssdb_globals)
+    STD_PHP_INI_BOOLEAN("ssdb.pool_ping",       "1",  PHP_INI_ALL, OnUpdateBool, pool_ping,         zend_ssdb_globals, ssdb_globals)
+    STD_PHP_INI_ENTRY("ssdb.shm_cache_size",      "0",    PHP_INI_SYSTEM, OnUpdateLong, shm_cache_size,      zend_ssdb_globals, ssdb_globals)
+    STD_PHP_INI_ENTRY("ssdb.shm_cache_slot_size", "4096", PHP_INI_SYSTEM, OnUpdateLong, shm_cache_slot_size, zend_ssdb_globals, ssdb_globals)
+    STD_PHP_INI_ENTRY("ssdb.compression_dict",    "",     PHP_INI_SYSTEM, OnUpdateString, compression_dict,  zend_ssdb_globals, ssdb_globals)
 PHP_INI_END()
-*/
 /* }}} */
 
-/* {{{ php_ssdb_init_globals
+/* {{{ PHP_GINIT_FUNCTION
  */
-/* Uncomment this function if you have INI entries
-static void php_ssdb_init_globals(zend_ssdb_globals *ssdb_globals)
+static PHP_GINIT_FUNCTION(ssdb)
 {
-	ssdb_globals->global_value = 0;
-	ssdb_globals->global_string = NULL;
+	ssdb_globals->pool_max_idle = 0;
+	ssdb_globals->pool_min_idle = 0;
+	ssdb_globals->pool_idle_timeout = 60;
+	ssdb_globals->pool_ping = 1;
+	ssdb_globals->shm_cache_size = 0;
+	ssdb_globals->shm_cache_slot_size = 4096;
+	ssdb_globals->compression_dict = NULL;
+	ssdb_pool_init(&ssdb_globals->pool);
+}
+/* }}} */
+
+/* {{{ PHP_GSHUTDOWN_FUNCTION
+ */
+static PHP_GSHUTDOWN_FUNCTION(ssdb)
+{
+	ssdb_pool_destroy(&ssdb_globals->pool);
 }
-*/
 /* }}} */
 
 /* {{{ PHP_MINIT_FUNCTION
  */
 PHP_MINIT_FUNCTION(ssdb)
 {
-	/* If you have INI entries, uncomment these lines 
 	REGISTER_INI_ENTRIES();
-	*/
 	register_ssdb_class(module_number TSRMLS_CC);
 
+	//在master进程中分配,fork出的worker共享
+	if (SSDB_G(shm_cache_size) > 0
+			&& ssdb_shm_init(SSDB_G(shm_cache_size), SSDB_G(shm_cache_slot_size)) < 0) {
+		zend_error(E_WARNING, "ssdb: unable to allocate %ld bytes of shared memory cache", SSDB_G(shm_cache_size));
+	}
+
+	//字典在master进程中加载一次,加载失败时COMPRESSION_ZSTD_DICT不可用
+	if (SSDB_G(compression_dict) && *SSDB_G(compression_dict)) {
+		ssdb_compress_dict_init(SSDB_G(compression_dict));
+	}
+
 	return SUCCESS;
 }
 /* }}} */
@@ -105,9 +140,9 @@ PHP_MINIT_FUNCTION(ssdb)
  */
 PHP_MSHUTDOWN_FUNCTION(ssdb)
 {
-	/* uncomment this line if you have INI entries
+	ssdb_shm_shutdown();
+	ssdb_compress_dict_shutdown();
 	UNREGISTER_INI_ENTRIES();
-	*/
 	return SUCCESS;
 }
 /* }}} */
@@ -126,6 +161,7 @@ PHP_RINIT_FUNCTION(ssdb)
  */
 PHP_RSHUTDOWN_FUNCTION(ssdb)
 {
+	ssdb_request_shutdown(TSRMLS_C);
 	return SUCCESS;
 }
 /* }}} */
@@ -143,9 +179,7 @@ PHP_MINFO_FUNCTION(ssdb)
 	php_info_print_table_row(2, "contact", "ixqbar@gmail.com or qq174171262");
 	php_info_print_table_end();
 
-	/* Remove comments if you have entries in php.ini
 	DISPLAY_INI_ENTRIES();
-	*/
 }
 /* }}} */
 
@@ -157,6 +191,19 @@ PHP_FUNCTION(ssdb_version)
 }
 /* }}} */
 
+/* {{{ ssdb_pool_stats
+ */
+PHP_FUNCTION(ssdb_pool_stats)
+{
+	ssdb_pool_stats(return_value TSRMLS_CC);
+}
+
+PHP_FUNCTION(ssdb_shm_cache_stats)
+{
+	ssdb_shm_stats(return_value);
+}
+/* }}} */
+
 /*
  * Local variables:
  * tab-width: 4
@@ -0,0 +1,345 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2014 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: xingqiba ixqbar@gmail.com                                                             |
+  +----------------------------------------------------------------------+
+*/
+
+#include "php.h"
+#include "ext/standard/php_smart_str.h"
+#include "Zend/zend_exceptions.h"
+
+#include "ssdb_library.h"
+#include "ssdb_batch.h"
+
+zend_class_entry *ssdb_promise_ce;
+
+static zend_object_handlers ssdb_promise_handlers;
+
+static const SSDBBatchCommand ssdb_batch_commands[] = {
+	{"get",  "multi_get",  9,  SSDB_UNSERIALIZE,      SSDB_CONVERT_TO_STRING},
+	{"hget", "multi_hget", 10, SSDB_UNSERIALIZE,      SSDB_CONVERT_TO_STRING},
+	{"zget", "multi_zget", 10, SSDB_UNSERIALIZE_NONE, SSDB_CONVERT_TO_LONG},
+	{NULL}
+};
+
+#define SSDB_PROMISE_FETCH(promise) SSDBPromise *promise = (SSDBPromise *) zend_object_store_get_object(getThis() TSRMLS_CC)
+
+static void ssdb_promise_free(void *object TSRMLS_DC) {
+	SSDBPromise *promise = (SSDBPromise *) object;
+
+	if (promise->value) {
+		zval_ptr_dtor(&promise->value);
+	}
+
+	if (promise->key) {
+		efree(promise->key);
+	}
+
+	zend_object_std_dtor(&promise->std TSRMLS_CC);
+	efree(promise);
+}
+
+static zend_object_value ssdb_promise_create(zend_class_entry *ce TSRMLS_DC) {
+	zend_object_value retval;
+	SSDBPromise *promise = ecalloc(1, sizeof(SSDBPromise));
+
+	zend_object_std_init(&promise->std, ce TSRMLS_CC);
+#if PHP_VERSION_ID < 50399
+	zend_hash_copy(promise->std.properties, &ce->default_properties, (copy_ctor_func_t) zval_add_ref, NULL, sizeof(zval *));
+#else
+	object_properties_init(&promise->std, ce);
+#endif
+
+	retval.handle = zend_objects_store_put(promise,
+			(zend_objects_store_dtor_t) zend_objects_destroy_object,
+			(zend_objects_free_object_storage_t) ssdb_promise_free,
+			NULL TSRMLS_CC);
+	retval.handlers = &ssdb_promise_handlers;
+
+	return retval;
+}
+
+//用multi_*的结果设置组内全部promise,result为NULL时结果都是NULL
+static void ssdb_batch_resolve(SSDBBatchGroup *group, zval *result TSRMLS_DC) {
+	HashPosition pos;
+	zval **z_promise, **found;
+
+	for (zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(group->promises), &pos);
+			zend_hash_get_current_data_ex(Z_ARRVAL_P(group->promises), (void **) &z_promise, &pos) == SUCCESS;
+			zend_hash_move_forward_ex(Z_ARRVAL_P(group->promises), &pos)) {
+		SSDBPromise *promise = (SSDBPromise *) zend_object_store_get_object(*z_promise TSRMLS_CC);
+
+		promise->resolved = 1;
+
+		if (result
+				&& Z_TYPE_P(result) == IS_ARRAY
+				&& zend_symtable_find(Z_ARRVAL_P(result), promise->key, promise->key_len + 1, (void **) &found) == SUCCESS) {
+			Z_ADDREF_PP(found);
+			promise->value = *found;
+		}
+	}
+}
+
+static void ssdb_batch_free_groups(SSDBBatchGroup *group) {
+	while (group != NULL) {
+		SSDBBatchGroup *next = group->next;
+
+		if (group->name) efree(group->name);
+		zval_ptr_dtor(&group->keys);
+		zval_ptr_dtor(&group->seen);
+		zval_ptr_dtor(&group->promises);
+		efree(group);
+
+		group = next;
+	}
+}
+
+static SSDBBatchGroup *ssdb_batch_group(SSDBBatch *batch, const SSDBBatchCommand *command, const char *name, int name_len) {
+	SSDBBatchGroup *group;
+
+	for (group = batch->head; group != NULL; group = group->next) {
+		if (group->command == command
+				&& group->name_len == name_len
+				&& 0 == memcmp(group->name, name, name_len)) {
+			return group;
+		}
+	}
+
+	group = ecalloc(1, sizeof(SSDBBatchGroup));
+	group->command  = command;
+	group->name     = estrndup(name, name_len);
+	group->name_len = name_len;
+	MAKE_STD_ZVAL(group->keys);
+	array_init(group->keys);
+	MAKE_STD_ZVAL(group->seen);
+	array_init(group->seen);
+	MAKE_STD_ZVAL(group->promises);
+	array_init(group->promises);
+
+	if (batch->tail) {
+		batch->tail->next = group;
+	} else {
+		batch->head = group;
+	}
+	batch->tail = group;
+
+	return group;
+}
+
+void ssdb_batch_begin(SSDBSock *ssdb_sock) {
+	if (ssdb_sock->batch == NULL) {
+		ssdb_sock->batch = ecalloc(1, sizeof(SSDBBatch));
+	}
+
+	ssdb_sock->batch->depth++;
+}
+
+//最外层的endBatch发送全部合并的命令并结束batch
+int ssdb_batch_end(SSDBSock *ssdb_sock TSRMLS_DC) {
+	if (ssdb_sock->batch == NULL) {
+		return FAILURE;
+	}
+
+	if (--ssdb_sock->batch->depth > 0) {
+		return SUCCESS;
+	}
+
+	ssdb_batch_exec(ssdb_sock TSRMLS_CC);
+	efree(ssdb_sock->batch);
+	ssdb_sock->batch = NULL;
+
+	return SUCCESS;
+}
+
+//argv为已加前缀的get key或hget/zget的名称和key,不能合并时返回FAILURE
+int ssdb_batch_add(SSDBSock *ssdb_sock, long sock_id, const SSDBArg *argv, int argc, zval *return_value TSRMLS_DC) {
+	const SSDBBatchCommand *command;
+	SSDBBatchGroup *group;
+	SSDBPromise *promise;
+	const SSDBArg *key;
+	zval *z_promise;
+
+	if (ssdb_sock->batch == NULL || ssdb_sock->pipeline) {
+		return FAILURE;
+	}
+
+	for (command = ssdb_batch_commands; command->name; command++) {
+		if (0 == strcmp(command->name, argv[0].str)) {
+			break;
+		}
+	}
+
+	if (command->name == NULL) {
+		return FAILURE;
+	}
+
+	key   = &argv[argc - 1];
+	group = argc > 2
+		? ssdb_batch_group(ssdb_sock->batch, command, argv[1].str, argv[1].len)
+		: ssdb_batch_group(ssdb_sock->batch, command, "", 0);
+
+	//重复的key只发送一次
+	if (!zend_symtable_exists(Z_ARRVAL_P(group->seen), (char *) key->str, key->len + 1)) {
+		add_assoc_null_ex(group->seen, (char *) key->str, key->len + 1);
+		add_next_index_stringl(group->keys, (char *) key->str, key->len, 1);
+	}
+
+	object_init_ex(return_value, ssdb_promise_ce);
+	promise = (SSDBPromise *) zend_object_store_get_object(return_value TSRMLS_CC);
+	promise->sock_id = sock_id;
+	promise->key     = estrndup(key->str, key->len);
+	promise->key_len = key->len;
+
+	MAKE_STD_ZVAL(z_promise);
+	ZVAL_ZVAL(z_promise, return_value, 1, 0);
+	add_next_index_zval(group->promises, z_promise);
+
+	return SUCCESS;
+}
+
+//全部multi_*命令一次写出,再按顺序读取响应
+void ssdb_batch_exec(SSDBSock *ssdb_sock TSRMLS_DC) {
+	SSDBBatchGroup *head, *group;
+	smart_str buf = {0};
+	char *cmd = NULL;
+	int cmd_len, sent = 0, result_set;
+
+	if (ssdb_sock->batch == NULL || ssdb_sock->batch->head == NULL) {
+		return;
+	}
+
+	//取下已有的组,反序列化时新加入的命令进入下一轮
+	head = ssdb_sock->batch->head;
+	ssdb_sock->batch->head = NULL;
+	ssdb_sock->batch->tail = NULL;
+
+	for (group = head; group != NULL; group = group->next) {
+		cmd_len = ssdb_cmd_format_by_zval(ssdb_sock, &cmd,
+				(char *) group->command->multi, group->command->multi_len,
+				group->name, group->name_len,
+				group->keys, 0, 0, 0);
+		if (cmd_len > 0) {
+			smart_str_appendl(&buf, cmd, cmd_len);
+			efree(cmd);
+			group->sent = 1;
+		}
+	}
+
+	ssdb_sock->cmd_defer = 0;
+	if (buf.len > 0 && ssdb_sock->status == SSDB_SOCK_STATUS_CONNECTED) {
+		sent = ssdb_sock_write(ssdb_sock, buf.c, buf.len) >= 0;
+	}
+	smart_str_free(&buf);
+
+	//需要普通数组查找结果
+	result_set = ssdb_sock->result_set;
+	ssdb_sock->result_set = 0;
+
+	for (group = head; group != NULL; group = group->next) {
+		zval *result = NULL;
+
+		if (sent && group->sent) {
+			MAKE_STD_ZVAL(result);
+			ZVAL_NULL(result);
+			ssdb_map_response(0, result, NULL, NULL, 1 TSRMLS_CC, ssdb_sock, SSDB_FILTER_KEY_PREFIX_NONE, group->command->unserialize, group->command->convert_type);
+		}
+
+		ssdb_batch_resolve(group, result TSRMLS_CC);
+
+		if (result) {
+			zval_ptr_dtor(&result);
+		}
+	}
+
+	ssdb_sock->result_set = result_set;
+	ssdb_batch_free_groups(head);
+}
+
+//其他命令写出之前调用,按调用顺序先发送并读取已合并的命令
+void ssdb_batch_settle(SSDBSock *ssdb_sock TSRMLS_DC) {
+	int cmd_noreply;
+
+	if (ssdb_sock->batch == NULL || ssdb_sock->batch->head == NULL) {
+		return;
+	}
+
+	//本命令的noreply不影响batch的响应
+	cmd_noreply = ssdb_sock->cmd_noreply;
+	ssdb_sock->cmd_noreply = 0;
+	ssdb_batch_exec(ssdb_sock TSRMLS_CC);
+	ssdb_sock->cmd_noreply = cmd_noreply;
+}
+
+//连接关闭时未发送的promise结果都为NULL
+void ssdb_batch_discard(SSDBSock *ssdb_sock TSRMLS_DC) {
+	SSDBBatchGroup *group;
+
+	if (ssdb_sock->batch == NULL) {
+		return;
+	}
+
+	for (group = ssdb_sock->batch->head; group != NULL; group = group->next) {
+		ssdb_batch_resolve(group, NULL TSRMLS_CC);
+	}
+
+	ssdb_batch_free_groups(ssdb_sock->batch->head);
+	efree(ssdb_sock->batch);
+	ssdb_sock->batch = NULL;
+}
+
+//结果未返回时先发送所在连接上的batch
+PHP_METHOD(SSDBPromise, value) {
+	SSDBSock *ssdb_sock;
+	int resource_type;
+	SSDB_PROMISE_FETCH(promise);
+
+	if (!promise->resolved) {
+		ssdb_sock = (SSDBSock *) zend_list_find(promise->sock_id, &resource_type);
+		if (ssdb_sock && resource_type == le_ssdb_sock) {
+			ssdb_batch_exec(ssdb_sock TSRMLS_CC);
+		}
+		promise->resolved = 1;
+	}
+
+	if (promise->value) {
+		RETURN_ZVAL(promise->value, 1, 0);
+	}
+
+	RETURN_NULL();
+}
+
+PHP_METHOD(SSDBPromise, isResolved) {
+	SSDB_PROMISE_FETCH(promise);
+
+	RETURN_BOOL(promise->resolved);
+}
+
+const zend_function_entry ssdb_promise_methods[] = {
+	PHP_ME(SSDBPromise, value,      NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBPromise, isResolved, NULL, ZEND_ACC_PUBLIC)
+	{NULL, NULL, NULL}
+};
+
+void register_ssdb_promise_class(TSRMLS_D) {
+	zend_class_entry ce;
+
+	INIT_CLASS_ENTRY(ce, "SSDBPromise", ssdb_promise_methods);
+	ssdb_promise_ce = zend_register_internal_class(&ce TSRMLS_CC);
+	ssdb_promise_ce->create_object = ssdb_promise_create;
+	ssdb_promise_ce->ce_flags |= ZEND_ACC_FINAL_CLASS;
+
+	memcpy(&ssdb_promise_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
+	ssdb_promise_handlers.clone_obj = NULL;
+}
@@ -0,0 +1,74 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2014 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: xingqiba ixqbar@gmail.com                                                             |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef EXT_SSDB_SSDB_BATCH_H_
+#define EXT_SSDB_SSDB_BATCH_H_
+
+#include "ssdb_library.h"
+
+//batch中可合并的单key读命令
+typedef struct {
+	const char *name;
+	const char *multi;
+	int multi_len;
+	int unserialize;
+	int convert_type;
+} SSDBBatchCommand;
+
+//同一个multi_*命令(multi_get或同一个hash/zset)的key和等待结果的promise
+typedef struct _SSDBBatchGroup {
+	const SSDBBatchCommand *command;
+	char *name;
+	int name_len;
+	zval *keys;
+	zval *seen;
+	zval *promises;
+	int sent;
+	struct _SSDBBatchGroup *next;
+} SSDBBatchGroup;
+
+typedef struct _SSDBBatch {
+	int depth;
+	SSDBBatchGroup *head;
+	SSDBBatchGroup *tail;
+} SSDBBatch;
+
+//get/hget/zget在batch中返回的结果句柄
+typedef struct {
+	zend_object std;
+	long sock_id;
+	char *key;
+	int key_len;
+	zval *value;
+	int resolved;
+} SSDBPromise;
+
+extern zend_class_entry *ssdb_promise_ce;
+
+void ssdb_batch_begin(SSDBSock *ssdb_sock);
+int ssdb_batch_end(SSDBSock *ssdb_sock TSRMLS_DC);
+int ssdb_batch_add(SSDBSock *ssdb_sock, long sock_id, const SSDBArg *argv, int argc, zval *return_value TSRMLS_DC);
+void ssdb_batch_exec(SSDBSock *ssdb_sock TSRMLS_DC);
+void ssdb_batch_settle(SSDBSock *ssdb_sock TSRMLS_DC);
+void ssdb_batch_discard(SSDBSock *ssdb_sock TSRMLS_DC);
+void register_ssdb_promise_class(TSRMLS_D);
+
+PHP_METHOD(SSDBPromise, value);
+PHP_METHOD(SSDBPromise, isResolved);
+
+#endif /* EXT_SSDB_SSDB_BATCH_H_ */
@@ -25,6 +25,13 @@
 #include "ssdb_library.h"
 #include "ssdb_class.h"
 #include "ssdb_geo.h"
+#include "ssdb_result.h"
+#include "ssdb_scan.h"
+#include "ssdb_cluster.h"
+#include "ssdb_command.h"
+#include "ssdb_batch.h"
+#include "ssdb_shm.h"
+#include "ssdb_compress.h"
 
 #include "geo/geohash.h"
 #include "geo/geohash_helper.h"
@@ -80,6 +87,24 @@ PHP_SSDB_API int ssdb_sock_get(zval *id, SSDBSock **ssdb_sock TSRMLS_DC, int no_
 		return -1;
     }
 
+    //新命令开始,回收上一个命令的临时内存
+    ssdb_arena_reset(*ssdb_sock);
+
+    //noreply()和defer()只对紧接着的一个命令有效
+    (*ssdb_sock)->noreply_once = (*ssdb_sock)->noreply_next;
+    (*ssdb_sock)->noreply_next = 0;
+    (*ssdb_sock)->cmd_noreply = 0;
+    (*ssdb_sock)->defer_once = (*ssdb_sock)->defer_next;
+    (*ssdb_sock)->defer_next = 0;
+    (*ssdb_sock)->cmd_defer = 0;
+    if ((*ssdb_sock)->cache_hit) {
+        ssdb_response_free((*ssdb_sock)->cache_hit);
+        (*ssdb_sock)->cache_hit = NULL;
+    }
+    (*ssdb_sock)->cache_key = NULL;
+    (*ssdb_sock)->cache_store = 0;
+    (*ssdb_sock)->cache_shm = 0;
+
     if ((*ssdb_sock)->lazy_connect) {
         (*ssdb_sock)->lazy_connect = 0;
         if (ssdb_open_socket(*ssdb_sock, 1) < 0) {
@@ -90,6 +115,20 @@ PHP_SSDB_API int ssdb_sock_get(zval *id, SSDBSock **ssdb_sock TSRMLS_DC, int no_
     return Z_LVAL_PP(socket);
 }
 
+//把连接保存到SSDB对象的socket属性
+PHP_SSDB_API int ssdb_sock_attach(zval *object, SSDBSock *ssdb_sock TSRMLS_DC) {
+	int id;
+
+#if PHP_VERSION_ID >= 50400
+	id = zend_list_insert(ssdb_sock, le_ssdb_sock TSRMLS_CC);
+#else
+	id = zend_list_insert(ssdb_sock, le_ssdb_sock);
+#endif
+	add_property_resource(object, "socket", id);
+
+	return id;
+}
+
 //连接
 PHP_SSDB_API int ssdb_connect(INTERNAL_FUNCTION_PARAMETERS, int persistent) {
 	SSDBSock *ssdb_sock  = NULL;
@@ -97,7 +136,7 @@ PHP_SSDB_API int ssdb_connect(INTERNAL_FUNCTION_PARAMETERS, int persistent) {
 	zval **socket;
 
 	char *host = NULL, *persistent_id = NULL;
-	int host_len = 0, persistent_id_len = 0, id;
+	int host_len = 0, persistent_id_len = 0;
 	long port = 0, timeout = 0, retry_interval = 0;
 
 	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os|llsl",
@@ -135,12 +174,7 @@ PHP_SSDB_API int ssdb_connect(INTERNAL_FUNCTION_PARAMETERS, int persistent) {
 		return FAILURE;
 	}
 
-#if PHP_VERSION_ID >= 50400
-	id = zend_list_insert(ssdb_sock, le_ssdb_sock TSRMLS_CC);
-#else
-	id = zend_list_insert(ssdb_sock, le_ssdb_sock);
-#endif
-	add_property_resource(object, "socket", id);
+	ssdb_sock_attach(object, ssdb_sock TSRMLS_CC);
 
 	return SUCCESS;
 }
@@ -206,6 +240,7 @@ PHP_METHOD(SSDB, option) {
 #ifdef HAVE_SSDB_IGBINARY
 				|| val_long == SSDB_SERIALIZER_IGBINARY
 #endif
+				|| val_long == SSDB_SERIALIZER_MSGPACK
 				|| val_long == SSDB_SERIALIZER_PHP) {
 				ssdb_sock->serializer = val_long;
 				RETVAL_TRUE;
@@ -213,6 +248,57 @@ PHP_METHOD(SSDB, option) {
 				RETVAL_FALSE;
 			}
 			break;
+		case SSDB_OPT_COMPRESSION:
+			val_long = atol(val_str);
+			if (ssdb_compression_supported(val_long)) {
+				ssdb_sock->compression = val_long;
+				RETVAL_TRUE;
+			} else {
+				RETVAL_FALSE;
+			}
+			break;
+		case SSDB_OPT_COMPRESSION_THRESHOLD:
+			val_long = atol(val_str);
+			if (val_long >= 0 && val_long <= INT_MAX) {
+				ssdb_sock->compression_threshold = val_long;
+				RETVAL_TRUE;
+			} else {
+				RETVAL_FALSE;
+			}
+			break;
+		case SSDB_OPT_RESULT_SET:
+			ssdb_sock->result_set = atol(val_str) ? 1 : 0;
+			RETVAL_TRUE;
+			break;
+		case SSDB_OPT_SCAN_PREFETCH:
+			ssdb_sock->scan_prefetch = atol(val_str) ? 1 : 0;
+			RETVAL_TRUE;
+			break;
+		case SSDB_OPT_NOREPLY:
+			ssdb_sock->noreply = atol(val_str) ? 1 : 0;
+			RETVAL_TRUE;
+			break;
+		case SSDB_OPT_READ_CACHE:
+			ssdb_sock->read_cache = atol(val_str) ? 1 : 0;
+			if (!ssdb_sock->read_cache) {
+				ssdb_read_cache_reset(ssdb_sock);
+			}
+			RETVAL_TRUE;
+			break;
+		case SSDB_OPT_SHM_CACHE:
+			val_long = atol(val_str);
+			ssdb_sock->shm_cache_ttl = val_long > 0 ? val_long : 0;
+			RETVAL_BOOL(0 == val_long || ssdb_shm_enabled());
+			break;
+		case SSDB_OPT_READ_POLICY:
+			val_long = atol(val_str);
+			if (val_long >= SSDB_READ_MASTER && val_long <= SSDB_READ_LATENCY) {
+				ssdb_sock->read_policy = val_long;
+				RETVAL_TRUE;
+			} else {
+				RETVAL_FALSE;
+			}
+			break;
 		default:
 			RETVAL_FALSE;
 	}
@@ -240,6 +326,91 @@ PHP_METHOD(SSDB, pconnect) {
 	}
 }
 
+//多个endpoint同时连接
+PHP_METHOD(SSDB, connectMulti) {
+	SSDBSock *ssdb_sock = NULL;
+	zval *object, *z_endpoints, **z_endpoint;
+	zval **socket;
+	HashPosition pos;
+	char **hosts;
+	long *ports, timeout = 0;
+	zend_bool keep_all = 0;
+	int num = 0, i, result;
+
+	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Oa|lb",
+			&object, ssdb_ce,
+			&z_endpoints,
+			&timeout,
+			&keep_all) == FAILURE) {
+		RETURN_FALSE;
+	}
+
+	if (timeout < 0L || timeout > INT_MAX) {
+		zend_throw_exception(ssdb_exception_ce, "Invalid timeout", 0 TSRMLS_CC);
+		RETURN_FALSE;
+	}
+
+	if (timeout == 0) {
+		timeout = 30;
+	}
+
+	if (zend_hash_num_elements(Z_ARRVAL_P(z_endpoints)) == 0) {
+		RETURN_FALSE;
+	}
+
+	hosts = ecalloc(zend_hash_num_elements(Z_ARRVAL_P(z_endpoints)), sizeof(char *));
+	ports = ecalloc(zend_hash_num_elements(Z_ARRVAL_P(z_endpoints)), sizeof(long));
+
+	//host:port 或 host
+	for (zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(z_endpoints), &pos);
+			zend_hash_get_current_data_ex(Z_ARRVAL_P(z_endpoints), (void **) &z_endpoint, &pos) == SUCCESS;
+			zend_hash_move_forward_ex(Z_ARRVAL_P(z_endpoints), &pos)) {
+		char *sep;
+
+		if (Z_TYPE_PP(z_endpoint) != IS_STRING || Z_STRLEN_PP(z_endpoint) == 0) {
+			continue;
+		}
+
+		sep = zend_memrchr(Z_STRVAL_PP(z_endpoint), ':', Z_STRLEN_PP(z_endpoint));
+		if (sep) {
+			hosts[num] = estrndup(Z_STRVAL_PP(z_endpoint), sep - Z_STRVAL_PP(z_endpoint));
+			ports[num] = atol(sep + 1);
+		} else {
+			hosts[num] = estrndup(Z_STRVAL_PP(z_endpoint), Z_STRLEN_PP(z_endpoint));
+			ports[num] = 8888;
+		}
+		num++;
+	}
+
+	if (num > 0) {
+		if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 1) > 0) {
+			if (zend_hash_find(Z_OBJPROP_P(object), "socket", sizeof("socket"), (void **)&socket) == SUCCESS) {
+				zend_list_delete(Z_LVAL_PP(socket));
+			}
+		}
+
+		ssdb_sock = ssdb_create_sock(hosts[0], strlen(hosts[0]), ports[0], timeout, 0, NULL, 0, 0);
+		result = ssdb_connect_multi(ssdb_sock, hosts, ports, num, keep_all);
+	} else {
+		result = -1;
+	}
+
+	for (i = 0; i < num; i++) {
+		efree(hosts[i]);
+	}
+	efree(hosts);
+	efree(ports);
+
+	if (result < 0) {
+		if (ssdb_sock) ssdb_free_socket(ssdb_sock);
+		RETURN_FALSE;
+	}
+
+	ssdb_sock_attach(object, ssdb_sock TSRMLS_CC);
+
+	RETURN_TRUE;
+}
+
 PHP_METHOD(SSDB, request) {
 	zval **z_args;
 	SSDBSock *ssdb_sock;
@@ -270,6 +441,9 @@ PHP_METHOD(SSDB, request) {
 
 	efree(z_args);
 
+	//原始命令无法判断写入的key,丢弃全部读缓存,共享内存中删除第一个参数对应的key
+	ssdb_read_cache_reset(ssdb_sock);
+	ssdb_read_cache_forget_raw(ssdb_sock, buf.c, buf.len);
 	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, buf.c, buf.len);
 
 	ssdb_list_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX, SSDB_UNSERIALIZE_NONE);
@@ -304,84 +478,14 @@ PHP_METHOD(SSDB, auth) {
 	ssdb_bool_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
 }
 
-PHP_METHOD(SSDB, ping) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *cmd = NULL;
-	int cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "O",
-			&object, ssdb_ce) == FAILURE) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("ping"), NULL);
-
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_bool_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-//ssdb-server >= 1.9.0
-PHP_METHOD(SSDB, version) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *cmd = NULL;
-	int cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "O",
-			&object, ssdb_ce) == FAILURE) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("version"), NULL);
-
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_string_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, dbsize) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *cmd = NULL;
-	int cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "O",
-			&object, ssdb_ce) == FAILURE) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("dbsize"), NULL);
-
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
+//命令表中的命令,见ssdb_command.h
+SSDB_COMMAND_LIST(SSDB_COMMAND_METHOD)
 
 PHP_METHOD(SSDB, set) {
 	zval *object;
 	SSDBSock *ssdb_sock;
 	char *key = NULL, *value = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, value_len = 0, value_free = 0, cmd_len = 0;
+	int key_len = 0, value_len = 0, value_free = 0, cmd_len = 0;
 	zval *z_value;
 	long expire = 0;
 
@@ -399,65 +503,30 @@ PHP_METHOD(SSDB, set) {
 		RETURN_NULL();
 	}
 
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
+	ssdb_key_prefix(ssdb_sock, &key, &key_len);
 	value_free = ssdb_serialize(ssdb_sock, z_value, &value, &value_len);
+	ssdb_read_cache_forget(ssdb_sock, key, key_len);
 
 	if (0 == expire) {
 		cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("set"), key, key_len, value, value_len, NULL);
 	} else {
-		char *expire_str = NULL;
-		int expire_str_len = spprintf(&expire_str, 0, "%ld", expire);
-		cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("setx"), key, key_len, value, value_len, expire_str, expire_str_len, NULL);
-		efree(expire_str);
+		cmd_len = ssdb_cmd_format(ssdb_sock, &cmd, "sssl", ZEND_STRL("setx"), key, key_len, value, value_len, expire);
 	}
 
-	if (key_free) efree(key);
 	if (value_free) STR_FREE(value);
 	if (0 == cmd_len) RETURN_NULL();
 
+	ssdb_noreply_begin(ssdb_sock);
 	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
 
 	ssdb_bool_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
 }
 
-PHP_METHOD(SSDB, getset) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *value = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, value_len = 0, value_free = 0, cmd_len = 0;
-	zval *z_value;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osz",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&z_value) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	value_free = ssdb_serialize(ssdb_sock, z_value, &value, &value_len);
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("getset"), key, key_len, value, value_len, NULL);
-
-	if (key_free) efree(key);
-	if (value_free) STR_FREE(value);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_string_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
 PHP_METHOD(SSDB, countbit) {
 	zval *object;
 	SSDBSock *ssdb_sock;
 	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0, num_args = ZEND_NUM_ARGS();
+	int key_len = 0, cmd_len = 0, num_args = ZEND_NUM_ARGS();
 	long offset_index, offset_size;
 
 	if (zend_parse_method_parameters(num_args TSRMLS_CC, getThis(), "Os|ll",
@@ -473,32 +542,19 @@ PHP_METHOD(SSDB, countbit) {
 		RETURN_NULL();
 	}
 
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
+	ssdb_key_prefix(ssdb_sock, &key, &key_len);
 
 	if (1 == num_args) {
 		cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("countbit"), key, key_len, NULL);
 	} else if (2 == num_args) {
-		char *offset_index_str = NULL;
-		int offset_index_str_len = spprintf(&offset_index_str, 0, "%ld", offset_index);
-		cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("countbit"), key, key_len, offset_index_str, offset_index_str_len, NULL);
-		efree(offset_index_str);
+		cmd_len = ssdb_cmd_format(ssdb_sock, &cmd, "ssl", ZEND_STRL("countbit"), key, key_len, offset_index);
 	} else {
-		char *offset_index_str = NULL;
-		char *offset_size_str = NULL;
-
-		int offset_index_str_len = spprintf(&offset_index_str, 0, "%ld", offset_index);
-		int offset_size_str_len = spprintf(&offset_size_str, 0, "%ld", offset_size);
-
-		cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("countbit"), key, key_len, offset_index_str, offset_index_str_len, offset_size_str, offset_size_str_len, NULL);
-
-		efree(offset_index_str);
-		efree(offset_size_str);
+		cmd_len = ssdb_cmd_format(ssdb_sock, &cmd, "ssll", ZEND_STRL("countbit"), key, key_len, offset_index, offset_size);
 	}
 
-	if (key_free) efree(key);
 	if (0 == cmd_len) RETURN_NULL();
 
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
+	SSDB_SOCKET_WRITE_READ_COMMAND(ssdb_sock, cmd, cmd_len);
 
 	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
 }
@@ -507,7 +563,7 @@ PHP_METHOD(SSDB, substr) {
 	zval *object;
 	SSDBSock *ssdb_sock;
 	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0, num_args = ZEND_NUM_ARGS();
+	int key_len = 0, cmd_len = 0, num_args = ZEND_NUM_ARGS();
 	long offset_index, offset_size;
 
 	if (zend_parse_method_parameters(num_args TSRMLS_CC, getThis(), "Os|ll",
@@ -523,50 +579,32 @@ PHP_METHOD(SSDB, substr) {
 		RETURN_NULL();
 	}
 
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
+	ssdb_key_prefix(ssdb_sock, &key, &key_len);
 
 	if (1 == num_args) {
 		cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("substr"), key, key_len, NULL);
 	} else if (2 == num_args) {
-		char *offset_index_str = NULL;
-		int offset_index_str_len = spprintf(&offset_index_str, 0, "%ld", offset_index);
-		cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("substr"), key, key_len, offset_index_str, offset_index_str_len, NULL);
-		efree(offset_index_str);
+		cmd_len = ssdb_cmd_format(ssdb_sock, &cmd, "ssl", ZEND_STRL("substr"), key, key_len, offset_index);
 	} else {
-		char *offset_index_str = NULL;
-		char *offset_size_str = NULL;
-
-		int offset_index_str_len = spprintf(&offset_index_str, 0, "%ld", offset_index);
-		int offset_size_str_len = spprintf(&offset_size_str, 0, "%ld", offset_size);
-
-		cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("substr"), key, key_len, offset_index_str, offset_index_str_len, offset_size_str, offset_size_str_len, NULL);
-
-		efree(offset_index_str);
-		efree(offset_size_str);
+		cmd_len = ssdb_cmd_format(ssdb_sock, &cmd, "ssll", ZEND_STRL("substr"), key, key_len, offset_index, offset_size);
 	}
 
-	if (key_free) efree(key);
 	if (0 == cmd_len) RETURN_NULL();
 
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
+	SSDB_SOCKET_WRITE_READ_COMMAND(ssdb_sock, cmd, cmd_len);
 
 	ssdb_string_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
 }
 
-PHP_METHOD(SSDB, setbit) {
-	zval *object;
+PHP_METHOD(SSDB, multi_set) {
+	zval *object, *z_args;
 	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-	long offset_index, offset_value;
+	SSDBWriteVec vec;
 
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osll",
+	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Oz",
 			&object, ssdb_ce,
-			&key, &key_len,
-			&offset_index,
-			&offset_value) == FAILURE
-			|| 0 == key_len
-			|| (offset_value != 0 && offset_value != 1)) {
+			&z_args) == FAILURE
+			|| Z_TYPE_P(z_args) != IS_ARRAY) {
 		RETURN_NULL();
 	}
 
@@ -574,38 +612,29 @@ PHP_METHOD(SSDB, setbit) {
 		RETURN_NULL();
 	}
 
-	char *offset_index_str = NULL;
-	int offset_index_str_len = spprintf(&offset_index_str, 0, "%ld", offset_index);
-
-	char *offset_value_str = NULL;
-	int offset_value_str_len = spprintf(&offset_value_str, 0, "%ld", offset_value);
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("setbit"), key, key_len, offset_index_str, offset_index_str_len, offset_value_str, offset_value_str_len, NULL);
-
-	efree(offset_index_str);
-	efree(offset_value_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
+	ssdb_read_cache_forget_zval(ssdb_sock, z_args, 1);
+	ssdb_wvec_init(&vec, SSDB_WRITEV_THRESHOLD);
+	if (0 == ssdb_cmd_vec_by_zval(ssdb_sock, &vec, "multi_set", 9, "", 0, z_args, 1, 1, 1)) {
+		ssdb_wvec_free(&vec);
+		RETURN_NULL();
+	}
 
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
+	ssdb_noreply_begin(ssdb_sock);
+	SSDB_SOCKET_WRITEV_COMMAND(ssdb_sock, &vec);
 
 	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
 }
 
-PHP_METHOD(SSDB, setnx) {
-	zval *object;
+PHP_METHOD(SSDB, multi_get) {
+	zval *object, *z_args;
 	SSDBSock *ssdb_sock;
-	char *key = NULL, *value = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, value_len = 0, value_free = 0, cmd_len = 0;
-	zval *z_value;
+	char *cmd = NULL;
+	int cmd_len = 0;
 
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osz",
+	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Oz",
 			&object, ssdb_ce,
-			&key, &key_len,
-			&z_value) == FAILURE
-			|| 0 == key_len) {
+			&z_args) == FAILURE
+			|| Z_TYPE_P(z_args) != IS_ARRAY) {
 		RETURN_NULL();
 	}
 
@@ -613,30 +642,25 @@ PHP_METHOD(SSDB, setnx) {
 		RETURN_NULL();
 	}
 
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	value_free = ssdb_serialize(ssdb_sock, z_value, &value, &value_len);
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("setnx"), key, key_len, value, value_len, NULL);
+	cmd_len = ssdb_cmd_format_by_zval(ssdb_sock, &cmd, "multi_get", 9, "", 0, z_args, 0, 1, 0);
 
-	if (key_free) efree(key);
-	if (value_free) STR_FREE(value);
 	if (0 == cmd_len) RETURN_NULL();
 
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
+	SSDB_SOCKET_WRITE_READ_COMMAND(ssdb_sock, cmd, cmd_len);
 
-	ssdb_bool_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
+	ssdb_map_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX, SSDB_UNSERIALIZE, SSDB_CONVERT_TO_STRING);
 }
 
-PHP_METHOD(SSDB, del) {
-	zval *object;
+PHP_METHOD(SSDB, multi_del) {
+	zval *object, *z_args;
 	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
+	char *cmd = NULL;
+	int cmd_len = 0;
 
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os",
+	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Oz",
 			&object, ssdb_ce,
-			&key, &key_len) == FAILURE
-			|| 0 == key_len) {
+			&z_args) == FAILURE
+			|| Z_TYPE_P(z_args) != IS_ARRAY) {
 		RETURN_NULL();
 	}
 
@@ -644,27 +668,30 @@ PHP_METHOD(SSDB, del) {
 		RETURN_NULL();
 	}
 
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("del"), key, key_len, NULL);
+	ssdb_read_cache_forget_zval(ssdb_sock, z_args, 0);
+	cmd_len = ssdb_cmd_format_by_zval(ssdb_sock, &cmd, "multi_del", 9, "", 0, z_args, 0, 1, 0);
 
-	if (key_free) efree(key);
 	if (0 == cmd_len) RETURN_NULL();
 
+	ssdb_noreply_begin(ssdb_sock);
 	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
 
-	ssdb_bool_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
+	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
 }
 
-PHP_METHOD(SSDB, exists) {
-	zval *object;
+PHP_METHOD(SSDB, multi_hset) {
+	zval *object, *z_args;
 	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
+	char *hash_key = NULL;
+	int hash_key_len = 0, cmd_len = 0;
+	SSDBWriteVec vec;
 
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os",
+	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osz",
 			&object, ssdb_ce,
-			&key, &key_len) == FAILURE
-			|| 0 == key_len) {
+			&hash_key, &hash_key_len,
+			&z_args) == FAILURE
+			|| 0 == hash_key_len
+			|| Z_TYPE_P(z_args) != IS_ARRAY) {
 		RETURN_NULL();
 	}
 
@@ -672,1794 +699,33 @@ PHP_METHOD(SSDB, exists) {
 		RETURN_NULL();
 	}
 
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("exists"), key, key_len, NULL);
+	ssdb_key_prefix(ssdb_sock, &hash_key, &hash_key_len);
+	ssdb_read_cache_forget(ssdb_sock, hash_key, hash_key_len);
+	ssdb_wvec_init(&vec, SSDB_WRITEV_THRESHOLD);
+	cmd_len = ssdb_cmd_vec_by_zval(ssdb_sock, &vec, ZEND_STRL("multi_hset"), hash_key, hash_key_len, z_args, 1, 0, 1);
 
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
+	if (0 == cmd_len) {
+		ssdb_wvec_free(&vec);
+		RETURN_NULL();
+	}
 
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
+	ssdb_noreply_begin(ssdb_sock);
+	SSDB_SOCKET_WRITEV_COMMAND(ssdb_sock, &vec);
 
-	ssdb_bool_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
+	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
 }
 
-PHP_METHOD(SSDB, get) {
-	zval *object;
+PHP_METHOD(SSDB, multi_hget) {
+	zval *object, *z_args;
 	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os",
-			&object, ssdb_ce,
-			&key, &key_len) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("get"), key, key_len, NULL);
-
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_string_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, strlen) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os",
-			&object, ssdb_ce,
-			&key, &key_len) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("strlen"), key, key_len, NULL);
-
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, getbit) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-	long offset = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os|l",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&offset) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *offset_str = NULL;
-	int offset_str_len = spprintf(&offset_str, 0, "%ld", offset);
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("getbit"), key, key_len, offset_str, offset_str_len, NULL);
-
-	efree(offset_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, ttl) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os",
-			&object, ssdb_ce,
-			&key, &key_len) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("ttl"), key, key_len, NULL);
-
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, incr) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-	long incr_number = 1;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os|l",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&incr_number) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *incr_number_str = NULL;
-	int incr_number_str_len = spprintf(&incr_number_str, 0, "%ld", incr_number);
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("incr"), key, key_len, incr_number_str, incr_number_str_len, NULL);
-
-	efree(incr_number_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, expire) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-	long expire;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osl",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&expire) == FAILURE) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *expire_str = NULL;
-	int expire_str_len = spprintf(&expire_str, 0, "%ld", expire);
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("expire"), key, key_len, expire_str, expire_str_len, NULL);
-
-	efree(expire_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_bool_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, keys) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key_start = NULL, *key_stop = NULL, *cmd = NULL;
-	int key_start_len = 0, key_start_free = 0, key_stop_len = 0, key_stop_free = 0, cmd_len = 0;
-	long limit;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Ossl",
-			&object, ssdb_ce,
-			&key_start, &key_start_len,
-			&key_stop, &key_stop_len,
-			&limit) == FAILURE
-			|| limit <= 0) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *limit_str = NULL;
-	int limit_str_len = spprintf(&limit_str, 0, "%ld", limit);
-
-	if (key_start_len) {
-		key_start_free = ssdb_key_prefix(ssdb_sock, &key_start, &key_start_len);
-	}
-
-	if (key_stop_len) {
-		key_stop_free = ssdb_key_prefix(ssdb_sock, &key_stop, &key_stop_len);
-	}
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("keys"), key_start, key_start_len, key_stop, key_stop_len, limit_str, limit_str_len, NULL);
-
-	efree(limit_str);
-	if (key_start_free) efree(key_start);
-	if (key_stop_free) efree(key_stop);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_list_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX, SSDB_UNSERIALIZE_NONE);
-}
-
-PHP_METHOD(SSDB, scan) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key_start = NULL, *key_stop = NULL, *cmd = NULL;
-	int key_start_len = 0, key_start_free = 0, key_stop_len = 0, key_stop_free = 0, cmd_len = 0;
-	long limit;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Ossl",
-			&object, ssdb_ce,
-			&key_start, &key_start_len,
-			&key_stop, &key_stop_len,
-			&limit) == FAILURE
-			|| limit <= 0) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *limit_str = NULL;
-	int limit_str_len = spprintf(&limit_str, 0, "%ld", limit);
-
-	if (key_start_len) {
-		key_start_free = ssdb_key_prefix(ssdb_sock, &key_start, &key_start_len);
-	}
-
-	if (key_stop_len) {
-		key_stop_free = ssdb_key_prefix(ssdb_sock, &key_stop, &key_stop_len);
-	}
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("scan"), key_start, key_start_len, key_stop, key_stop_len, limit_str, limit_str_len, NULL);
-
-	efree(limit_str);
-	if (key_start_free) efree(key_start);
-	if (key_stop_free) efree(key_stop);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_map_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX, SSDB_UNSERIALIZE, SSDB_CONVERT_TO_STRING);
-}
-
-PHP_METHOD(SSDB, rscan) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key_start = NULL, *key_stop = NULL, *cmd = NULL;
-	int key_start_len = 0, key_start_free = 0, key_stop_len = 0, key_stop_free = 0, cmd_len = 0;
-	long limit;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Ossl",
-			&object, ssdb_ce,
-			&key_start, &key_start_len,
-			&key_stop, &key_stop_len,
-			&limit) == FAILURE
-			|| limit <= 0) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *limit_str = NULL;
-	int limit_str_len = spprintf(&limit_str, 0, "%ld", limit);
-
-	if (key_start_len) {
-		key_start_free = ssdb_key_prefix(ssdb_sock, &key_start, &key_start_len);
-	}
-
-	if (key_stop_len) {
-		key_stop_free = ssdb_key_prefix(ssdb_sock, &key_stop, &key_stop_len);
-	}
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("rscan"), key_start, key_start_len, key_stop, key_stop_len, limit_str, limit_str_len, NULL);
-
-	efree(limit_str);
-	if (key_start_free) efree(key_start);
-	if (key_stop_free) efree(key_stop);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_map_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX, SSDB_UNSERIALIZE, SSDB_CONVERT_TO_STRING);
-}
-
-PHP_METHOD(SSDB, multi_set) {
-	zval *object, *z_args;
-	SSDBSock *ssdb_sock;
-	char *cmd = NULL;
-	int cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Oz",
-			&object, ssdb_ce,
-			&z_args) == FAILURE
-			|| Z_TYPE_P(z_args) != IS_ARRAY) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	cmd_len = ssdb_cmd_format_by_zval(ssdb_sock, &cmd, "multi_set", 9, "", 0, z_args, 1, 1, 1);
-
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, multi_get) {
-	zval *object, *z_args;
-	SSDBSock *ssdb_sock;
-	char *cmd = NULL;
-	int cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Oz",
-			&object, ssdb_ce,
-			&z_args) == FAILURE
-			|| Z_TYPE_P(z_args) != IS_ARRAY) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	cmd_len = ssdb_cmd_format_by_zval(ssdb_sock, &cmd, "multi_get", 9, "", 0, z_args, 0, 1, 0);
-
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_map_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX, SSDB_UNSERIALIZE, SSDB_CONVERT_TO_STRING);
-}
-
-PHP_METHOD(SSDB, multi_del) {
-	zval *object, *z_args;
-	SSDBSock *ssdb_sock;
-	char *cmd = NULL;
-	int cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Oz",
-			&object, ssdb_ce,
-			&z_args) == FAILURE
-			|| Z_TYPE_P(z_args) != IS_ARRAY) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	cmd_len = ssdb_cmd_format_by_zval(ssdb_sock, &cmd, "multi_del", 9, "", 0, z_args, 0, 1, 0);
-
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, hset) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *hash_key = NULL, *key = NULL, *key_value = NULL, *cmd = NULL;
-	int hash_key_len = 0, hash_key_free = 0, key_len = 0, key_value_len = 0, key_value_free = 0, cmd_len = 0;
-	zval *z_value;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Ossz",
-			&object, ssdb_ce,
-			&hash_key, &hash_key_len,
-			&key, &key_len,
-			&z_value) == FAILURE
-			|| 0 == hash_key_len
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	hash_key_free = ssdb_key_prefix(ssdb_sock, &hash_key, &hash_key_len);
-	key_value_free = ssdb_serialize(ssdb_sock, z_value, &key_value, &key_value_len);
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("hset"), hash_key, hash_key_len, key, key_len, key_value, key_value_len, NULL);
-
-	if (hash_key_free) efree(hash_key);
-	if (key_value_free) STR_FREE(key_value);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_bool_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, hget) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *hash_key = NULL, *key = NULL, *cmd = NULL;
-	int hash_key_len = 0, hash_key_free = 0, key_len = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Oss",
-			&object, ssdb_ce,
-			&hash_key, &hash_key_len,
-			&key, &key_len) == FAILURE
-			|| 0 == hash_key_len
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	hash_key_free = ssdb_key_prefix(ssdb_sock, &hash_key, &hash_key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("hget"), hash_key, hash_key_len, key, key_len, NULL);
-
-	if (hash_key_free) efree(hash_key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_string_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, hdel) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *hash_key = NULL, *key = NULL, *cmd = NULL;
-	int hash_key_len = 0, hash_key_free = 0, key_len = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Oss",
-			&object, ssdb_ce,
-			&hash_key, &hash_key_len,
-			&key, &key_len) == FAILURE
-			|| 0 == hash_key_len
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	hash_key_free = ssdb_key_prefix(ssdb_sock, &hash_key, &hash_key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("hdel"), hash_key, hash_key_len, key, key_len, NULL);
-
-	if (hash_key_free) efree(hash_key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_bool_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, hincr) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *hash_key = NULL, *key = NULL, *cmd = NULL;
-	int hash_key_len = 0, hash_key_free = 0, key_len = 0, cmd_len = 0;
-	long incr_number = 1;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Oss|l",
-			&object, ssdb_ce,
-			&hash_key, &hash_key_len,
-			&key, &key_len,
-			&incr_number) == FAILURE
-			|| 0 == hash_key_len
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *incr_number_str = NULL;
-	int incr_number_str_len = spprintf(&incr_number_str, 0, "%ld", incr_number);
-
-	hash_key_free = ssdb_key_prefix(ssdb_sock, &hash_key, &hash_key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("hincr"), hash_key, hash_key_len, key, key_len, incr_number_str, incr_number_str_len, NULL);
-
-	efree(incr_number_str);
-	if (hash_key_free) efree(hash_key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, hexists) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *hash_key = NULL, *key = NULL, *cmd = NULL;
-	int hash_key_len = 0, hash_key_free = 0, key_len = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Oss",
-			&object, ssdb_ce,
-			&hash_key, &hash_key_len,
-			&key, &key_len) == FAILURE
-			|| 0 == hash_key_len
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	hash_key_free = ssdb_key_prefix(ssdb_sock, &hash_key, &hash_key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("hexists"), hash_key, hash_key_len, key, key_len, NULL);
-
-	if (hash_key_free) efree(hash_key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_bool_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, hsize) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *hash_key = NULL, *cmd = NULL;
-	int hash_key_len = 0, hash_key_free = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os",
-			&object, ssdb_ce,
-			&hash_key, &hash_key_len) == FAILURE
-			|| 0 == hash_key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	hash_key_free = ssdb_key_prefix(ssdb_sock, &hash_key, &hash_key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("hsize"), hash_key, hash_key_len, NULL);
-
-	if (hash_key_free) efree(hash_key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, hlist) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key_start = NULL, *key_stop = NULL, *cmd = NULL;
-	int key_start_len = 0, key_start_free = 0, key_stop_len = 0, key_stop_free = 0, cmd_len = 0;
-	long limit;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Ossl",
-			&object, ssdb_ce,
-			&key_start, &key_start_len,
-			&key_stop, &key_stop_len,
-			&limit) == FAILURE
-			|| limit <= 0) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *limit_str = NULL;
-	int limit_str_len = spprintf(&limit_str, 0, "%ld", limit);
-
-	if (key_start_len) {
-		key_start_free = ssdb_key_prefix(ssdb_sock, &key_start, &key_start_len);
-	}
-
-	if (key_stop_len) {
-		key_stop_free = ssdb_key_prefix(ssdb_sock, &key_stop, &key_stop_len);
-	}
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("hlist"), key_start, key_start_len, key_stop, key_stop_len, limit_str, limit_str_len, NULL);
-
-	efree(limit_str);
-	if (key_start_free) efree(key_start);
-	if (key_stop_free) efree(key_stop);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_list_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX, SSDB_UNSERIALIZE_NONE);
-}
-
-PHP_METHOD(SSDB, hrlist) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key_start = NULL, *key_stop = NULL, *cmd = NULL;
-	int key_start_len = 0, key_start_free = 0, key_stop_len = 0, key_stop_free = 0, cmd_len = 0;
-	long limit;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Ossl",
-			&object, ssdb_ce,
-			&key_start, &key_start_len,
-			&key_stop, &key_stop_len,
-			&limit) == FAILURE
-			|| limit <= 0) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *limit_str = NULL;
-	int limit_str_len = spprintf(&limit_str, 0, "%ld", limit);
-
-	if (key_start_len) {
-		key_start_free = ssdb_key_prefix(ssdb_sock, &key_start, &key_start_len);
-	}
-
-	if (key_stop_len) {
-		key_stop_free = ssdb_key_prefix(ssdb_sock, &key_stop, &key_stop_len);
-	}
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("hrlist"), key_start, key_start_len, key_stop, key_stop_len, limit_str, limit_str_len, NULL);
-
-	efree(limit_str);
-	if (key_start_free) efree(key_start);
-	if (key_stop_free) efree(key_stop);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_list_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX, SSDB_UNSERIALIZE_NONE);
-}
-
-PHP_METHOD(SSDB, hkeys) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *hash_key = NULL, *key_start = NULL, *key_stop = NULL, *cmd = NULL;
-	int hash_key_len = 0, hash_key_free = 0, key_start_len = 0, key_stop_len = 0, cmd_len = 0;
-	long limit = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osssl",
-			&object, ssdb_ce,
-			&hash_key, &hash_key_len,
-			&key_start, &key_start_len,
-			&key_stop, &key_stop_len,
-			&limit) == FAILURE
-			|| 0 == hash_key_len
-			|| limit <= 0) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *limit_str = NULL;
-	int limit_str_len = spprintf(&limit_str, 0, "%ld", limit);
-
-	hash_key_free = ssdb_key_prefix(ssdb_sock, &hash_key, &hash_key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("hkeys"), hash_key, hash_key_len, key_start, key_start_len, key_stop, key_stop_len, limit_str, limit_str_len, NULL);
-
-	efree(limit_str);
-	if (hash_key_free) efree(hash_key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_list_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX, SSDB_UNSERIALIZE_NONE);
-}
-
-PHP_METHOD(SSDB, hgetall) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *hash_key = NULL, *cmd = NULL;
-	int hash_key_len = 0, hash_key_free = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os",
-			&object, ssdb_ce,
-			&hash_key, &hash_key_len) == FAILURE
-			|| 0 == hash_key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	hash_key_free = ssdb_key_prefix(ssdb_sock, &hash_key, &hash_key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("hgetall"), hash_key, hash_key_len, NULL);
-
-	if (hash_key_free) efree(hash_key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_map_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX_NONE, SSDB_UNSERIALIZE, SSDB_CONVERT_TO_STRING);
-}
-
-PHP_METHOD(SSDB, hscan) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *hash_key = NULL, *key_start = NULL, *key_stop = NULL, *cmd = NULL;
-	int hash_key_len = 0, hash_key_free = 0, key_start_len = 0, key_stop_len = 0, cmd_len = 0;
-	long limit = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osssl",
-			&object, ssdb_ce,
-			&hash_key, &hash_key_len,
-			&key_start, &key_start_len,
-			&key_stop, &key_stop_len,
-			&limit) == FAILURE
-			|| 0 == hash_key_len
-			|| limit <= 0) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *limit_str = NULL;
-	int limit_str_len = spprintf(&limit_str, 0, "%ld", limit);
-
-	hash_key_free = ssdb_key_prefix(ssdb_sock, &hash_key, &hash_key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("hscan"), hash_key, hash_key_len, key_start, key_start_len, key_stop, key_stop_len, limit_str, limit_str_len, NULL);
-
-	efree(limit_str);
-	if (hash_key_free) efree(hash_key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_map_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX_NONE, SSDB_UNSERIALIZE, SSDB_CONVERT_TO_STRING);
-}
-
-PHP_METHOD(SSDB, hrscan) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *hash_key = NULL, *key_start = NULL, *key_stop = NULL, *cmd = NULL;
-	int hash_key_len = 0, hash_key_free = 0, key_start_len = 0, key_stop_len = 0, cmd_len = 0;
-	long limit = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osssl",
-			&object, ssdb_ce,
-			&hash_key, &hash_key_len,
-			&key_start, &key_start_len,
-			&key_stop, &key_stop_len,
-			&limit) == FAILURE
-			|| 0 == hash_key_len
-			|| limit <= 0) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *limit_str = NULL;
-	int limit_str_len = spprintf(&limit_str, 0, "%ld", limit);
-
-	hash_key_free = ssdb_key_prefix(ssdb_sock, &hash_key, &hash_key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("hrscan"), hash_key, hash_key_len, key_start, key_start_len, key_stop, key_stop_len, limit_str, limit_str_len, NULL);
-
-	efree(limit_str);
-	if (hash_key_free) efree(hash_key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_map_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX_NONE, SSDB_UNSERIALIZE, SSDB_CONVERT_TO_STRING);
-}
-
-PHP_METHOD(SSDB, hclear) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *hash_key = NULL, *cmd = NULL;
-	int hash_key_len = 0, hash_key_free = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os",
-			&object, ssdb_ce,
-			&hash_key, &hash_key_len) == FAILURE
-			|| 0 == hash_key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	hash_key_free = ssdb_key_prefix(ssdb_sock, &hash_key, &hash_key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("hclear"), hash_key, hash_key_len, NULL);
-
-	if (hash_key_free) efree(hash_key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, multi_hset) {
-	zval *object, *z_args;
-	SSDBSock *ssdb_sock;
-	char *hash_key = NULL, *cmd = NULL;
-	int hash_key_len = 0, hash_key_free = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osz",
-			&object, ssdb_ce,
-			&hash_key, &hash_key_len,
-			&z_args) == FAILURE
-			|| 0 == hash_key_len
-			|| Z_TYPE_P(z_args) != IS_ARRAY) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	hash_key_free = ssdb_key_prefix(ssdb_sock, &hash_key, &hash_key_len);
-	cmd_len = ssdb_cmd_format_by_zval(ssdb_sock, &cmd, ZEND_STRL("multi_hset"), hash_key, hash_key_len, z_args, 1, 0, 1);
-
-	if (hash_key_free) efree(hash_key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, multi_hget) {
-	zval *object, *z_args;
-	SSDBSock *ssdb_sock;
-	char *hash_key = NULL, *cmd = NULL;
-	int hash_key_len = 0, hash_key_free = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osz",
-			&object, ssdb_ce,
-			&hash_key, &hash_key_len,
-			&z_args) == FAILURE
-			|| 0 == hash_key_len
-			|| Z_TYPE_P(z_args) != IS_ARRAY) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	hash_key_free = ssdb_key_prefix(ssdb_sock, &hash_key, &hash_key_len);
-	cmd_len = ssdb_cmd_format_by_zval(ssdb_sock, &cmd, ZEND_STRL("multi_hget"), hash_key, hash_key_len, z_args, 0, 0, 0);
-
-	if (hash_key_free) efree(hash_key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_map_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX_NONE, SSDB_UNSERIALIZE, SSDB_CONVERT_TO_STRING);
-}
-
-PHP_METHOD(SSDB, multi_hdel) {
-	zval *object, *z_args;
-	SSDBSock *ssdb_sock;
-	char *hash_key = NULL, *cmd = NULL;
-	int hash_key_len = 0, hash_key_free = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osz",
-			&object, ssdb_ce,
-			&hash_key, &hash_key_len,
-			&z_args) == FAILURE
-			|| 0 == hash_key_len
-			|| Z_TYPE_P(z_args) != IS_ARRAY) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	hash_key_free = ssdb_key_prefix(ssdb_sock, &hash_key, &hash_key_len);
-	cmd_len = ssdb_cmd_format_by_zval(ssdb_sock, &cmd, ZEND_STRL("multi_hdel"), hash_key, hash_key_len, z_args, 0, 0, 0);
-
-	if (hash_key_free) efree(hash_key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, zset) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *member_key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, member_key_len = 0, cmd_len = 0;
-	long member_score;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Ossl",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&member_key, &member_key_len,
-			&member_score) == FAILURE
-			|| 0 == key_len
-			|| 0 == member_key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *member_score_str = NULL;
-	int member_score_str_len = spprintf(&member_score_str, 0, "%ld", member_score);
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zset"), key, key_len, member_key, member_key_len, member_score_str, member_score_str_len, NULL);
-
-	efree(member_score_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_bool_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, zget) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *member_key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, member_key_len = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Oss",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&member_key, &member_key_len) == FAILURE
-			|| 0 == key_len
-			|| 0 == member_key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zget"), key, key_len, member_key, member_key_len, NULL);
-
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, zdel) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *member_key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, member_key_len = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Oss",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&member_key, &member_key_len) == FAILURE
-			|| 0 == key_len
-			|| 0 == member_key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zdel"), key, key_len, member_key, member_key_len, NULL);
-
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_bool_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, zincr) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *member_key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, member_key_len = 0, cmd_len = 0;
-	long member_score;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Ossl",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&member_key, &member_key_len,
-			&member_score) == FAILURE
-			|| 0 == key_len
-			|| 0 == member_key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *member_score_str = NULL;
-	int member_score_str_len = spprintf(&member_score_str, 0, "%ld", member_score);
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zincr"), key, key_len, member_key, member_key_len, member_score_str, member_score_str_len, NULL);
-
-	efree(member_score_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, zsize) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-	long member_score;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os",
-			&object, ssdb_ce,
-			&key, &key_len) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zsize"), key, key_len, NULL);
-
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, zlist) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key_start = NULL, *key_stop = NULL, *cmd = NULL;
-	int key_start_len = 0, key_start_free = 0, key_stop_len = 0, key_stop_free = 0, cmd_len = 0;
-	long limit;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Ossl",
-			&object, ssdb_ce,
-			&key_start, &key_start_len,
-			&key_stop, &key_stop_len,
-			&limit) == FAILURE
-			|| limit <= 0) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *limit_str = NULL;
-	int limit_str_len = spprintf(&limit_str, 0, "%ld", limit);
-
-	if (key_start_len) {
-		key_start_free = ssdb_key_prefix(ssdb_sock, &key_start, &key_start_len);
-	}
-
-	if (key_stop_len) {
-		key_stop_free = ssdb_key_prefix(ssdb_sock, &key_stop, &key_stop_len);
-	}
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zlist"), key_start, key_start_len, key_stop, key_stop_len, limit_str, limit_str_len, NULL);
-
-	efree(limit_str);
-	if (key_start_free) efree(key_start);
-	if (key_stop_free) efree(key_stop);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_list_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX, SSDB_UNSERIALIZE_NONE);
-}
-
-PHP_METHOD(SSDB, zrlist) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key_start = NULL, *key_stop = NULL, *cmd = NULL;
-	int key_start_len = 0, key_start_free = 0, key_stop_len = 0, key_stop_free = 0, cmd_len = 0;
-	long limit;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Ossl",
-			&object, ssdb_ce,
-			&key_start, &key_start_len,
-			&key_stop, &key_stop_len,
-			&limit) == FAILURE
-			|| limit <= 0) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *limit_str = NULL;
-	int limit_str_len = spprintf(&limit_str, 0, "%ld", limit);
-
-	if (key_start_len) {
-		key_start_free = ssdb_key_prefix(ssdb_sock, &key_start, &key_start_len);
-	}
-
-	if (key_stop_len) {
-		key_stop_free = ssdb_key_prefix(ssdb_sock, &key_stop, &key_stop_len);
-	}
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zrlist"), key_start, key_start_len, key_stop, key_stop_len, limit_str, limit_str_len, NULL);
-
-	efree(limit_str);
-	if (key_start_free) efree(key_start);
-	if (key_stop_free) efree(key_stop);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_list_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX, SSDB_UNSERIALIZE_NONE);
-}
-
-PHP_METHOD(SSDB, zexists) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *member_key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, member_key_len = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Oss",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&member_key, &member_key_len) == FAILURE
-			|| 0 == key_len
-			|| 0 == member_key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zexists"), key, key_len, member_key, member_key_len, NULL);
-
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_bool_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, zkeys) {
-	zval *object, *score_start, *score_end;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *key_start = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, key_start_len = 0, cmd_len = 0;
-	long limit;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osszzl",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&key_start, &key_start_len,
-			&score_start,
-			&score_end,
-			&limit) == FAILURE
-			|| 0 == key_len
-			|| limit <= 0) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	if (IS_STRING != Z_TYPE_P(score_start)
-		&& IS_LONG != Z_TYPE_P(score_start)
-		&& IS_DOUBLE != Z_TYPE_P(score_start)) {
-		zend_throw_exception(ssdb_exception_ce, "error params type", 0 TSRMLS_CC);
-		RETURN_NULL();
-	}
-
-	if (IS_STRING != Z_TYPE_P(score_end)
-		&& IS_LONG != Z_TYPE_P(score_end)
-		&& IS_DOUBLE != Z_TYPE_P(score_end)) {
-		zend_throw_exception(ssdb_exception_ce, "error params type", 0 TSRMLS_CC);
-		RETURN_NULL();
-	}
-
-	convert_to_string(score_start);
-	convert_to_string(score_end);
-
-	char *limit_str = NULL;
-	int limit_str_len = spprintf(&limit_str, 0, "%ld", limit);
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zkeys"), key, key_len, key_start, key_start_len, Z_STRVAL_P(score_start), Z_STRLEN_P(score_start),  Z_STRVAL_P(score_end), Z_STRLEN_P(score_end), limit_str, limit_str_len, NULL);
-
-	efree(limit_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_list_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX, SSDB_UNSERIALIZE_NONE);
-}
-
-PHP_METHOD(SSDB, zscan) {
-	zval *object, *score_start, *score_end;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *key_start = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, key_start_len = 0, cmd_len = 0;
-	long limit = -1;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osszzl",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&key_start, &key_start_len,
-			&score_start,
-			&score_end,
-			&limit) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	if (IS_STRING != Z_TYPE_P(score_start)
-		&& IS_LONG != Z_TYPE_P(score_start)
-		&& IS_DOUBLE != Z_TYPE_P(score_start)) {
-		zend_throw_exception(ssdb_exception_ce, "error params type", 0 TSRMLS_CC);
-		RETURN_NULL();
-	}
-
-	if (IS_STRING != Z_TYPE_P(score_end)
-		&& IS_LONG != Z_TYPE_P(score_end)
-		&& IS_DOUBLE != Z_TYPE_P(score_end)) {
-		zend_throw_exception(ssdb_exception_ce, "error params type", 0 TSRMLS_CC);
-		RETURN_NULL();
-	}
-
-	convert_to_string(score_start);
-	convert_to_string(score_end);
-
-	char *limit_str = NULL;
-	int limit_str_len = spprintf(&limit_str, 0, "%ld", limit);
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zscan"), key, key_len, key_start, key_start_len, Z_STRVAL_P(score_start), Z_STRLEN_P(score_start), Z_STRVAL_P(score_end), Z_STRLEN_P(score_end), limit_str, limit_str_len, NULL);
-
-	efree(limit_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_map_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX_NONE, SSDB_UNSERIALIZE_NONE, SSDB_CONVERT_TO_LONG);
-}
-
-PHP_METHOD(SSDB, zrscan) {
-	zval *object, *score_start, *score_end;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *key_start = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, key_start_len = 0, cmd_len = 0;
-	long limit = -1;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osszzl",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&key_start, &key_start_len,
-			&score_start,
-			&score_end,
-			&limit) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	if (IS_STRING != Z_TYPE_P(score_start)
-		&& IS_LONG != Z_TYPE_P(score_start)
-		&& IS_DOUBLE != Z_TYPE_P(score_start)) {
-		zend_throw_exception(ssdb_exception_ce, "error params type", 0 TSRMLS_CC);
-		RETURN_NULL();
-	}
-
-	if (IS_STRING != Z_TYPE_P(score_end)
-		&& IS_LONG != Z_TYPE_P(score_end)
-		&& IS_DOUBLE != Z_TYPE_P(score_end)) {
-		zend_throw_exception(ssdb_exception_ce, "error params type", 0 TSRMLS_CC);
-		RETURN_NULL();
-	}
-
-	convert_to_string(score_start);
-	convert_to_string(score_end);
-
-	char *limit_str = NULL;
-	int limit_str_len = spprintf(&limit_str, 0, "%ld", limit);
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zrscan"), key, key_len, key_start, key_start_len, Z_STRVAL_P(score_start), Z_STRLEN_P(score_start), Z_STRVAL_P(score_end), Z_STRLEN_P(score_end), limit_str, limit_str_len, NULL);
-
-	efree(limit_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_map_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX_NONE, SSDB_UNSERIALIZE_NONE, SSDB_CONVERT_TO_LONG);
-}
-
-PHP_METHOD(SSDB, zrank) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *member_key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, member_key_len = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Oss",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&member_key, &member_key_len) == FAILURE
-			|| 0 == key_len
-			|| 0 == member_key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zrank"), key, key_len, member_key, member_key_len, NULL);
-
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, zrrank) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *member_key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, member_key_len = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Oss",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&member_key, &member_key_len) == FAILURE
-			|| 0 == key_len
-			|| 0 == member_key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zrrank"), key, key_len, member_key, member_key_len, NULL);
-
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, zrange) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-	long start_offset, limit;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osll",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&start_offset,
-			&limit) == FAILURE
-			|| 0 == key_len
-			|| limit <= 0) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *start_offset_str = NULL;
-	int start_offset_str_len = spprintf(&start_offset_str, 0, "%ld", start_offset);
-
-	char *limit_str = NULL;
-	int limit_str_len = spprintf(&limit_str, 0, "%ld", limit);
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zrange"), key, key_len, start_offset_str, start_offset_str_len, limit_str, limit_str_len, NULL);
-
-	efree(start_offset_str);
-	efree(limit_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_map_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX_NONE, SSDB_UNSERIALIZE_NONE, SSDB_CONVERT_TO_LONG);
-}
-
-PHP_METHOD(SSDB, zrrange) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-	long start_offset, limit;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osll",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&start_offset,
-			&limit) == FAILURE
-			|| 0 == key_len
-			|| limit <= 0) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *start_offset_str = NULL;
-	int start_offset_str_len = spprintf(&start_offset_str, 0, "%ld", start_offset);
-
-	char *limit_str = NULL;
-	int limit_str_len = spprintf(&limit_str, 0, "%ld", limit);
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zrrange"), key, key_len, start_offset_str, start_offset_str_len, limit_str, limit_str_len, NULL);
-
-	efree(start_offset_str);
-	efree(limit_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_map_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX_NONE, SSDB_UNSERIALIZE_NONE, SSDB_CONVERT_TO_LONG);
-}
-
-PHP_METHOD(SSDB, zclear) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os",
-			&object, ssdb_ce,
-			&key, &key_len) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zclear"), key, key_len, NULL);
-
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, zcount) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-	long score_start, score_end;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osll",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&score_start,
-			&score_end) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *score_start_str = NULL;
-	int score_start_str_len = spprintf(&score_start_str, 0, "%ld", score_start);
-
-	char *score_end_str = NULL;
-	int score_end_str_len = spprintf(&score_end_str, 0, "%ld", score_end);
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zcount"), key, key_len, score_start_str, score_start_str_len, score_end_str, score_end_str_len, NULL);
-
-	efree(score_start_str);
-	efree(score_end_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, zsum) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-	long score_start, score_end;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osll",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&score_start,
-			&score_end) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *score_start_str = NULL;
-	int score_start_str_len = spprintf(&score_start_str, 0, "%ld", score_start);
-
-	char *score_end_str = NULL;
-	int score_end_str_len = spprintf(&score_end_str, 0, "%ld", score_end);
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zsum"), key, key_len, score_start_str, score_start_str_len, score_end_str, score_end_str_len, NULL);
-
-	efree(score_start_str);
-	efree(score_end_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, zavg) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-	long score_start, score_end;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osll",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&score_start,
-			&score_end) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *score_start_str = NULL;
-	int score_start_str_len = spprintf(&score_start_str, 0, "%ld", score_start);
-
-	char *score_end_str = NULL;
-	int score_end_str_len = spprintf(&score_end_str, 0, "%ld", score_end);
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zavg"), key, key_len, score_start_str, score_start_str_len, score_end_str, score_end_str_len, NULL);
-
-	efree(score_start_str);
-	efree(score_end_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_double_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, zremrangebyrank) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-	long start_offset, end_offset;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osll",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&start_offset,
-			&end_offset) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *start_offset_str = NULL;
-	int start_offset_str_len = spprintf(&start_offset_str, 0, "%ld", start_offset);
-
-	char *end_offset_str = NULL;
-	int end_offset_str_len = spprintf(&end_offset_str, 0, "%ld", end_offset);
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zremrangebyrank"), key, key_len, start_offset_str, start_offset_str_len, end_offset_str, end_offset_str_len, NULL);
-
-	efree(start_offset_str);
-	efree(end_offset_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, zremrangebyscore) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-	long start_score, end_score;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osll",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&start_score,
-			&end_score) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *start_score_str = NULL;
-	int start_score_str_len = spprintf(&start_score_str, 0, "%ld", start_score);
-
-	char *end_score_str = NULL;
-	int end_score_str_len= spprintf(&end_score_str, 0, "%ld", end_score);
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zremrangebyscore"), key, key_len, start_score_str, start_score_str_len, end_score_str, end_score_str_len, NULL);
-
-	efree(start_score_str);
-	efree(end_score_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, multi_zset) {
-	zval *object, *z_args;
-	SSDBSock *ssdb_sock;
-	char *set_key = NULL, *cmd = NULL;
-	int set_key_len = 0, set_key_free = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osz",
-			&object, ssdb_ce,
-			&set_key, &set_key_len,
-			&z_args) == FAILURE
-			|| 0 == set_key_len
-			|| Z_TYPE_P(z_args) != IS_ARRAY) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	set_key_free = ssdb_key_prefix(ssdb_sock, &set_key, &set_key_len);
-	cmd_len = ssdb_cmd_format_by_zval(ssdb_sock, &cmd, ZEND_STRL("multi_zset"), set_key, set_key_len, z_args, 1, 0, 0);
-
-	if (set_key_free) efree(set_key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, multi_zget) {
-	zval *object, *z_args;
-	SSDBSock *ssdb_sock;
-	char *set_key = NULL, *cmd = NULL;
-	int set_key_len = 0, set_key_free = 0, cmd_len = 0;
+	char *hash_key = NULL, *cmd = NULL;
+	int hash_key_len = 0, cmd_len = 0;
 
 	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osz",
 			&object, ssdb_ce,
-			&set_key, &set_key_len,
+			&hash_key, &hash_key_len,
 			&z_args) == FAILURE
-			|| 0 == set_key_len
+			|| 0 == hash_key_len
 			|| Z_TYPE_P(z_args) != IS_ARRAY) {
 		RETURN_NULL();
 	}
@@ -2468,28 +734,27 @@ PHP_METHOD(SSDB, multi_zget) {
 		RETURN_NULL();
 	}
 
-	set_key_free = ssdb_key_prefix(ssdb_sock, &set_key, &set_key_len);
-	cmd_len = ssdb_cmd_format_by_zval(ssdb_sock, &cmd, ZEND_STRL("multi_zget"), set_key, set_key_len, z_args, 0, 0, 0);
+	ssdb_key_prefix(ssdb_sock, &hash_key, &hash_key_len);
+	cmd_len = ssdb_cmd_format_by_zval(ssdb_sock, &cmd, ZEND_STRL("multi_hget"), hash_key, hash_key_len, z_args, 0, 0, 0);
 
-	if (set_key_free) efree(set_key);
 	if (0 == cmd_len) RETURN_NULL();
 
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
+	SSDB_SOCKET_WRITE_READ_COMMAND(ssdb_sock, cmd, cmd_len);
 
-	ssdb_map_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX_NONE, SSDB_UNSERIALIZE_NONE, SSDB_CONVERT_TO_LONG);
+	ssdb_map_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX_NONE, SSDB_UNSERIALIZE, SSDB_CONVERT_TO_STRING);
 }
 
-PHP_METHOD(SSDB, multi_zdel) {
+PHP_METHOD(SSDB, multi_hdel) {
 	zval *object, *z_args;
 	SSDBSock *ssdb_sock;
-	char *set_key = NULL, *cmd = NULL;
-	int set_key_len = 0, set_key_free = 0, cmd_len = 0;
+	char *hash_key = NULL, *cmd = NULL;
+	int hash_key_len = 0, cmd_len = 0;
 
 	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osz",
 			&object, ssdb_ce,
-			&set_key, &set_key_len,
+			&hash_key, &hash_key_len,
 			&z_args) == FAILURE
-			|| 0 == set_key_len
+			|| 0 == hash_key_len
 			|| Z_TYPE_P(z_args) != IS_ARRAY) {
 		RETURN_NULL();
 	}
@@ -2498,66 +763,31 @@ PHP_METHOD(SSDB, multi_zdel) {
 		RETURN_NULL();
 	}
 
-	set_key_free = ssdb_key_prefix(ssdb_sock, &set_key, &set_key_len);
-	cmd_len = ssdb_cmd_format_by_zval(ssdb_sock, &cmd, ZEND_STRL("multi_zdel"), set_key, set_key_len, z_args, 0, 0, 0);
+	ssdb_key_prefix(ssdb_sock, &hash_key, &hash_key_len);
+	ssdb_read_cache_forget(ssdb_sock, hash_key, hash_key_len);
+	cmd_len = ssdb_cmd_format_by_zval(ssdb_sock, &cmd, ZEND_STRL("multi_hdel"), hash_key, hash_key_len, z_args, 0, 0, 0);
 
-	if (set_key_free) efree(set_key);
 	if (0 == cmd_len) RETURN_NULL();
 
+	ssdb_noreply_begin(ssdb_sock);
 	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
 
 	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
 }
 
-PHP_METHOD(SSDB, zpop_front) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-	long size = 1;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os|l",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&size) == FAILURE
-			|| 0 == key_len
-			|| size <= 0) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-
-	char *size_str = NULL;
-	int size_str_len = spprintf(&size_str, 0, "%ld", size);
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zpop_front"), key, key_len, size_str, size_str_len, NULL);
-
-	efree(size_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_map_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX_NONE, SSDB_UNSERIALIZE_NONE, SSDB_CONVERT_TO_LONG);
-}
-
-PHP_METHOD(SSDB, zpop_back) {
-	zval *object;
+PHP_METHOD(SSDB, multi_zset) {
+	zval *object, *z_args;
 	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-	long size = 1;
+	char *set_key = NULL;
+	int set_key_len = 0, cmd_len = 0;
+	SSDBWriteVec vec;
 
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os|l",
+	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osz",
 			&object, ssdb_ce,
-			&key, &key_len,
-			&size) == FAILURE
-			|| 0 == key_len
-			|| size <= 0) {
+			&set_key, &set_key_len,
+			&z_args) == FAILURE
+			|| 0 == set_key_len
+			|| Z_TYPE_P(z_args) != IS_ARRAY) {
 		RETURN_NULL();
 	}
 
@@ -2565,307 +795,33 @@ PHP_METHOD(SSDB, zpop_back) {
 		RETURN_NULL();
 	}
 
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-
-	char *size_str = NULL;
-	int size_str_len = spprintf(&size_str, 0, "%ld", size);
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zpop_back"), key, key_len, size_str, size_str_len, NULL);
-
-	efree(size_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_map_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX_NONE, SSDB_UNSERIALIZE_NONE, SSDB_CONVERT_TO_LONG);
-}
-
-PHP_METHOD(SSDB, qsize) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os",
-			&object, ssdb_ce,
-			&key, &key_len) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
+	ssdb_key_prefix(ssdb_sock, &set_key, &set_key_len);
+	ssdb_wvec_init(&vec, SSDB_WRITEV_THRESHOLD);
+	cmd_len = ssdb_cmd_vec_by_zval(ssdb_sock, &vec, ZEND_STRL("multi_zset"), set_key, set_key_len, z_args, 1, 0, 0);
 
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
+	if (0 == cmd_len) {
+		ssdb_wvec_free(&vec);
 		RETURN_NULL();
 	}
 
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("qsize"), key, key_len, NULL);
-
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
+	ssdb_noreply_begin(ssdb_sock);
+	SSDB_SOCKET_WRITEV_COMMAND(ssdb_sock, &vec);
 
 	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
 }
 
-PHP_METHOD(SSDB, qlist) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key_start = NULL, *key_stop = NULL, *cmd = NULL;
-	int key_start_len = 0, key_start_free = 0, key_stop_len = 0, key_stop_free = 0, cmd_len = 0;
-	long limit;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Ossl",
-			&object, ssdb_ce,
-			&key_start, &key_start_len,
-			&key_stop, &key_stop_len,
-			&limit) == FAILURE
-			|| limit <= 0) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *limit_str = NULL;
-	int limit_str_len = spprintf(&limit_str, 0, "%ld", limit);
-
-	if (key_start_len) {
-		key_start_free = ssdb_key_prefix(ssdb_sock, &key_start, &key_start_len);
-	}
-
-	if (key_stop_len) {
-		key_stop_free = ssdb_key_prefix(ssdb_sock, &key_stop, &key_stop_len);
-	}
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("qlist"), key_start, key_start_len, key_stop, key_stop_len, limit_str, limit_str_len, NULL);
-
-	efree(limit_str);
-	if (key_start_free) efree(key_start);
-	if (key_stop_free) efree(key_stop);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_list_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX, SSDB_UNSERIALIZE_NONE);
-}
-
-PHP_METHOD(SSDB, qrlist) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key_start = NULL, *key_stop = NULL, *cmd = NULL;
-	int key_start_len = 0, key_start_free = 0, key_stop_len = 0, key_stop_free = 0, cmd_len = 0;
-	long limit;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Ossl",
-			&object, ssdb_ce,
-			&key_start, &key_start_len,
-			&key_stop, &key_stop_len,
-			&limit) == FAILURE
-			|| limit <= 0) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *limit_str = NULL;
-	int limit_str_len = spprintf(&limit_str, 0, "%ld", limit);
-
-	if (key_start_len) {
-		key_start_free = ssdb_key_prefix(ssdb_sock, &key_start, &key_start_len);
-	}
-
-	if (key_stop_len) {
-		key_stop_free = ssdb_key_prefix(ssdb_sock, &key_stop, &key_stop_len);
-	}
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("qrlist"), key_start, key_start_len, key_stop, key_stop_len, limit_str, limit_str_len, NULL);
-
-	efree(limit_str);
-	if (key_start_free) efree(key_start);
-	if (key_stop_free) efree(key_stop);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_list_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX, SSDB_UNSERIALIZE_NONE);
-}
-
-PHP_METHOD(SSDB, qclear) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os",
-			&object, ssdb_ce,
-			&key, &key_len) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("qclear"), key, key_len, NULL);
-
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_bool_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, qfront) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os",
-			&object, ssdb_ce,
-			&key, &key_len) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("qfront"), key, key_len, NULL);
-
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_string_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, qback) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os",
-			&object, ssdb_ce,
-			&key, &key_len) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("qback"), key, key_len, NULL);
-
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_string_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, qget) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-	long offset = 0;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os|l",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&offset) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *offset_str = NULL;
-	int offset_str_len = spprintf(&offset_str, 0, "%ld", offset);
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("qget"), key, key_len, offset_str, offset_str_len, NULL);
-
-	efree(offset_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_string_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, qset) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *value = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, value_len = 0, value_free = 0, cmd_len = 0;
-	long offset_index;
-	zval *z_value;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Oslz",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&offset_index,
-			&z_value) == FAILURE
-			|| 0 == key_len) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	char *offset_index_str = NULL;
-	int offset_index_str_len = spprintf(&offset_index_str, 0, "%ld", offset_index);
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	value_free = ssdb_serialize(ssdb_sock, z_value, &value, &value_len);
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("qset"), key, key_len, offset_index_str, offset_index_str_len, value, value_len, NULL);
-
-	efree(offset_index_str);
-	if (key_free) efree(key);
-	if (value_free) efree(value);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_bool_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, qrange) {
-	zval *object;
+PHP_METHOD(SSDB, multi_zget) {
+	zval *object, *z_args;
 	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-	long start_offset, limit;
+	char *set_key = NULL, *cmd = NULL;
+	int set_key_len = 0, cmd_len = 0;
 
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osll",
+	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osz",
 			&object, ssdb_ce,
-			&key, &key_len,
-			&start_offset,
-			&limit) == FAILURE
-			|| 0 == key_len
-			|| limit <= 0) {
+			&set_key, &set_key_len,
+			&z_args) == FAILURE
+			|| 0 == set_key_len
+			|| Z_TYPE_P(z_args) != IS_ARRAY) {
 		RETURN_NULL();
 	}
 
@@ -2873,38 +829,28 @@ PHP_METHOD(SSDB, qrange) {
 		RETURN_NULL();
 	}
 
-	char *start_offset_str = NULL;
-	int start_offset_str_len = spprintf(&start_offset_str, 0, "%ld", start_offset);
-
-	char *limit_str = NULL;
-	int limit_str_len = spprintf(&limit_str, 0, "%ld", limit);
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("qrange"), key, key_len, start_offset_str, start_offset_str_len, limit_str, limit_str_len, NULL);
+	ssdb_key_prefix(ssdb_sock, &set_key, &set_key_len);
+	cmd_len = ssdb_cmd_format_by_zval(ssdb_sock, &cmd, ZEND_STRL("multi_zget"), set_key, set_key_len, z_args, 0, 0, 0);
 
-	efree(start_offset_str);
-	efree(limit_str);
-	if (key_free) efree(key);
 	if (0 == cmd_len) RETURN_NULL();
 
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
+	SSDB_SOCKET_WRITE_READ_COMMAND(ssdb_sock, cmd, cmd_len);
 
-	ssdb_list_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX_NONE, SSDB_UNSERIALIZE);
+	ssdb_map_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX_NONE, SSDB_UNSERIALIZE_NONE, SSDB_CONVERT_TO_LONG);
 }
 
-PHP_METHOD(SSDB, qslice) {
-	zval *object;
+PHP_METHOD(SSDB, multi_zdel) {
+	zval *object, *z_args;
 	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-	long start_offset, end_offset;
+	char *set_key = NULL, *cmd = NULL;
+	int set_key_len = 0, cmd_len = 0;
 
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osll",
+	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osz",
 			&object, ssdb_ce,
-			&key, &key_len,
-			&start_offset,
-			&end_offset) == FAILURE
-			|| 0 == key_len) {
+			&set_key, &set_key_len,
+			&z_args) == FAILURE
+			|| 0 == set_key_len
+			|| Z_TYPE_P(z_args) != IS_ARRAY) {
 		RETURN_NULL();
 	}
 
@@ -2912,30 +858,22 @@ PHP_METHOD(SSDB, qslice) {
 		RETURN_NULL();
 	}
 
-	char *start_offset_str = NULL;
-	int start_offset_str_len = spprintf(&start_offset_str, 0, "%ld", start_offset);
-
-	char *end_offset_str = NULL;
-	int end_offset_str_len = spprintf(&end_offset_str, 0, "%ld", end_offset);
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("qslice"), key, key_len, start_offset_str, start_offset_str_len, end_offset_str, end_offset_str_len, NULL);
+	ssdb_key_prefix(ssdb_sock, &set_key, &set_key_len);
+	cmd_len = ssdb_cmd_format_by_zval(ssdb_sock, &cmd, ZEND_STRL("multi_zdel"), set_key, set_key_len, z_args, 0, 0, 0);
 
-	efree(start_offset_str);
-	efree(end_offset_str);
-	if (key_free) efree(key);
 	if (0 == cmd_len) RETURN_NULL();
 
+	ssdb_noreply_begin(ssdb_sock);
 	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
 
-	ssdb_list_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, SSDB_FILTER_KEY_PREFIX_NONE, SSDB_UNSERIALIZE);
+	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
 }
 
 PHP_METHOD(SSDB, qpush) {
 	zval *object;
 	SSDBSock *ssdb_sock;
 	char *key = NULL, *value = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, value_len = 0, value_free = 0, cmd_len = 0;
+	int key_len = 0, value_len = 0, value_free = 0, cmd_len = 0;
 	zval *z_value;
 
 	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osz",
@@ -2963,7 +901,7 @@ PHP_METHOD(SSDB, qpush) {
 		RETURN_NULL();
 	}
 
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
+	ssdb_key_prefix(ssdb_sock, &key, &key_len);
 
 	if (IS_ARRAY != Z_TYPE_P(z_value)) {
 		value_free = ssdb_serialize(ssdb_sock, z_value, &value, &value_len);
@@ -2973,9 +911,9 @@ PHP_METHOD(SSDB, qpush) {
 		cmd_len = ssdb_cmd_format_by_zval(ssdb_sock, &cmd, ZEND_STRL("qpush"), key, key_len, z_value, 0, 0, 1);
 	}
 
-	if (key_free) efree(key);
 	if (0 == cmd_len) RETURN_NULL();
 
+	ssdb_noreply_begin(ssdb_sock);
 	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
 
 	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
@@ -2985,7 +923,7 @@ PHP_METHOD(SSDB, qpush_front) {
 	zval *object;
 	SSDBSock *ssdb_sock;
 	char *key = NULL, *value = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, value_len = 0, value_free = 0, cmd_len = 0;
+	int key_len = 0, value_len = 0, value_free = 0, cmd_len = 0;
 	zval *z_value;
 
 	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osz",
@@ -3013,7 +951,7 @@ PHP_METHOD(SSDB, qpush_front) {
 		RETURN_NULL();
 	}
 
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
+	ssdb_key_prefix(ssdb_sock, &key, &key_len);
 
 	if (IS_ARRAY != Z_TYPE_P(z_value)) {
 		value_free = ssdb_serialize(ssdb_sock, z_value, &value, &value_len);
@@ -3023,9 +961,9 @@ PHP_METHOD(SSDB, qpush_front) {
 		cmd_len = ssdb_cmd_format_by_zval(ssdb_sock, &cmd, ZEND_STRL("qpush_front"), key, key_len, z_value, 0, 0, 1);
 	}
 
-	if (key_free) efree(key);
 	if (0 == cmd_len) RETURN_NULL();
 
+	ssdb_noreply_begin(ssdb_sock);
 	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
 
 	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
@@ -3035,7 +973,7 @@ PHP_METHOD(SSDB, qpush_back) {
 	zval *object;
 	SSDBSock *ssdb_sock;
 	char *key = NULL, *value = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, value_len = 0, value_free = 0, cmd_len = 0;
+	int key_len = 0, value_len = 0, value_free = 0, cmd_len = 0;
 	zval *z_value;
 
 	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osz",
@@ -3063,7 +1001,7 @@ PHP_METHOD(SSDB, qpush_back) {
 		RETURN_NULL();
 	}
 
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
+	ssdb_key_prefix(ssdb_sock, &key, &key_len);
 
 	if (IS_ARRAY != Z_TYPE_P(z_value)) {
 		value_free = ssdb_serialize(ssdb_sock, z_value, &value, &value_len);
@@ -3073,9 +1011,9 @@ PHP_METHOD(SSDB, qpush_back) {
 		cmd_len = ssdb_cmd_format_by_zval(ssdb_sock, &cmd, ZEND_STRL("qpush_back"), key, key_len, z_value, 0, 0, 1);
 	}
 
-	if (key_free) efree(key);
 	if (0 == cmd_len) RETURN_NULL();
 
+	ssdb_noreply_begin(ssdb_sock);
 	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
 
 	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
@@ -3085,7 +1023,7 @@ PHP_METHOD(SSDB, qpop) {
 	zval *object;
 	SSDBSock *ssdb_sock;
 	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
+	int key_len = 0, cmd_len = 0;
 	long size = 0;
 
 	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os|l",
@@ -3101,20 +1039,14 @@ PHP_METHOD(SSDB, qpop) {
 		RETURN_NULL();
 	}
 
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
+	ssdb_key_prefix(ssdb_sock, &key, &key_len);
 
 	if (size) {
-		char *size_str = NULL;
-		int size_str_len = spprintf(&size_str, 0, "%ld", size);
-
-		cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("qpop"), key, key_len, size_str, size_str_len, NULL);
-
-		efree(size_str);
+		cmd_len = ssdb_cmd_format(ssdb_sock, &cmd, "ssl", ZEND_STRL("qpop"), key, key_len, size);
 	} else {
 		cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("qpop"), key, key_len, NULL);
 	}
 
-	if (key_free) efree(key);
 	if (0 == cmd_len) RETURN_NULL();
 
 	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
@@ -3130,7 +1062,7 @@ PHP_METHOD(SSDB, qpop_front) {
 	zval *object;
 	SSDBSock *ssdb_sock;
 	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
+	int key_len = 0, cmd_len = 0;
 	long size = 0;
 
 	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os|l",
@@ -3146,20 +1078,14 @@ PHP_METHOD(SSDB, qpop_front) {
 		RETURN_NULL();
 	}
 
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
+	ssdb_key_prefix(ssdb_sock, &key, &key_len);
 
 	if (size) {
-		char *size_str = NULL;
-		int size_str_len = spprintf(&size_str, 0, "%ld", size);
-
-		cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("qpop_front"), key, key_len, size_str, size_str_len, NULL);
-
-		efree(size_str);
+		cmd_len = ssdb_cmd_format(ssdb_sock, &cmd, "ssl", ZEND_STRL("qpop_front"), key, key_len, size);
 	} else {
 		cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("qpop_front"), key, key_len, NULL);
 	}
 
-	if (key_free) efree(key);
 	if (0 == cmd_len) RETURN_NULL();
 
 	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
@@ -3175,7 +1101,7 @@ PHP_METHOD(SSDB, qpop_back) {
 	zval *object;
 	SSDBSock *ssdb_sock;
 	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
+	int key_len = 0, cmd_len = 0;
 	long size = 0;
 
 	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os|l",
@@ -3191,20 +1117,14 @@ PHP_METHOD(SSDB, qpop_back) {
 		RETURN_NULL();
 	}
 
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
+	ssdb_key_prefix(ssdb_sock, &key, &key_len);
 
 	if (size) {
-		char *size_str = NULL;
-		int size_str_len = spprintf(&size_str, 0, "%ld", size);
-
-		cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("qpop_back"), key, key_len, size_str, size_str_len, NULL);
-
-		efree(size_str);
+		cmd_len = ssdb_cmd_format(ssdb_sock, &cmd, "ssl", ZEND_STRL("qpop_back"), key, key_len, size);
 	} else {
 		cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("qpop_back"), key, key_len, NULL);
 	}
 
-	if (key_free) efree(key);
 	if (0 == cmd_len) RETURN_NULL();
 
 	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
@@ -3216,78 +1136,6 @@ PHP_METHOD(SSDB, qpop_back) {
 	}
 }
 
-PHP_METHOD(SSDB, qtrim_front) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-	long size = 1;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os|l",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&size) == FAILURE
-			|| 0 == key_len
-			|| size <= 0) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-
-	char *size_str = NULL;
-	int size_str_len = spprintf(&size_str, 0, "%ld", size);
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("qtrim_front"), key, key_len, size_str, size_str_len, NULL);
-
-	efree(size_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
-PHP_METHOD(SSDB, qtrim_back) {
-	zval *object;
-	SSDBSock *ssdb_sock;
-	char *key = NULL, *cmd = NULL;
-	int key_len = 0, key_free = 0, cmd_len = 0;
-	long size = 1;
-
-	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Os|l",
-			&object, ssdb_ce,
-			&key, &key_len,
-			&size) == FAILURE
-			|| 0 == key_len
-			|| size <= 0) {
-		RETURN_NULL();
-	}
-
-	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
-		RETURN_NULL();
-	}
-
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-
-	char *size_str = NULL;
-	int size_str_len = spprintf(&size_str, 0, "%ld", size);
-
-	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("qtrim_back"), key, key_len, size_str, size_str_len, NULL);
-
-	efree(size_str);
-	if (key_free) efree(key);
-	if (0 == cmd_len) RETURN_NULL();
-
-	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
-
-	ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
-}
-
 PHP_METHOD(SSDB, read) {
 	zval *object;
 	SSDBSock *ssdb_sock;
@@ -3310,8 +1158,24 @@ PHP_METHOD(SSDB, read) {
 		RETURN_NULL();
 	}
 
+	if (ssdb_sock->pipeline) {
+		zend_throw_exception(ssdb_exception_ce, "Command not supported in pipeline mode", 0 TSRMLS_CC);
+		RETURN_NULL();
+	}
+
+	//先读掉noreply命令的响应,避免当作read()的数据返回
+	ssdb_sock_discard(ssdb_sock);
+
 	char *buf = emalloc(sizeof (char *) * (buf_len + 1));
 
+	//先消费接收缓冲区中残留的数据
+	if (ssdb_sock->rbuf_len > ssdb_sock->rbuf_pos) {
+		read_buf_len = MIN(buf_len, ssdb_sock->rbuf_len - ssdb_sock->rbuf_pos);
+		memcpy(buf, ssdb_sock->rbuf + ssdb_sock->rbuf_pos, read_buf_len);
+		ssdb_sock->rbuf_pos += read_buf_len;
+		buf_len -= read_buf_len;
+	}
+
 	while (1) {
 		if (buf_len <= 0
 				|| 1 == php_stream_eof(ssdb_sock->stream)) {
@@ -3350,6 +1214,15 @@ PHP_METHOD(SSDB, write) {
 		RETURN_FALSE;
 	}
 
+	if (ssdb_sock->pipeline) {
+		zend_throw_exception(ssdb_exception_ce, "Command not supported in pipeline mode", 0 TSRMLS_CC);
+		RETURN_FALSE;
+	}
+
+	//原始命令无法判断写入的key,丢弃全部读缓存,共享内存中删除每条命令第一个参数对应的key
+	ssdb_read_cache_reset(ssdb_sock);
+	ssdb_read_cache_forget_raw(ssdb_sock, buf, buf_len);
+
 	if (ssdb_sock_write(ssdb_sock, buf, buf_len) != buf_len) {
 		RETURN_FALSE;
 	}
@@ -3361,7 +1234,7 @@ PHP_METHOD(SSDB, geo_set) {
 	zval *object;
 	SSDBSock *ssdb_sock;
 	char *key = NULL, *member_key = NULL;
-	int key_len = 0, key_free = 0, member_key_len = 0;
+	int key_len = 0, member_key_len = 0;
 	double latitude, longitude;
 
 	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Ossdd",
@@ -3379,6 +1252,11 @@ PHP_METHOD(SSDB, geo_set) {
 		RETURN_NULL();
 	}
 
+	if (ssdb_sock->pipeline) {
+		zend_throw_exception(ssdb_exception_ce, "Command not supported in pipeline mode", 0 TSRMLS_CC);
+		RETURN_NULL();
+	}
+
 	if (!ssdb_geo_set(ssdb_sock, key, key_len, member_key, member_key_len, latitude, longitude, INTERNAL_FUNCTION_PARAM_PASSTHRU)) {
 		RETURN_NULL();
 	}
@@ -3403,6 +1281,11 @@ PHP_METHOD(SSDB, geo_get) {
 		RETURN_NULL();
 	}
 
+	if (ssdb_sock->pipeline) {
+		zend_throw_exception(ssdb_exception_ce, "Command not supported in pipeline mode", 0 TSRMLS_CC);
+		RETURN_NULL();
+	}
+
 	if (!ssdb_geo_get(ssdb_sock, key, key_len, member_key, member_key_len, INTERNAL_FUNCTION_PARAM_PASSTHRU)) {
 		RETURN_NULL();
 	}
@@ -3433,6 +1316,11 @@ PHP_METHOD(SSDB, geo_neighbour) {
 		RETURN_NULL();
 	}
 
+	if (ssdb_sock->pipeline) {
+		zend_throw_exception(ssdb_exception_ce, "Command not supported in pipeline mode", 0 TSRMLS_CC);
+		RETURN_NULL();
+	}
+
 	if (!ssdb_geo_neighbours(ssdb_sock, key, key_len, member_key, member_key_len, radius_meters, return_limit, zscan_limit, INTERNAL_FUNCTION_PARAM_PASSTHRU)) {
 		RETURN_NULL();
 	}
@@ -3460,11 +1348,223 @@ PHP_METHOD(SSDB, geo_distance) {
 		RETURN_NULL();
 	}
 
+	if (ssdb_sock->pipeline) {
+		zend_throw_exception(ssdb_exception_ce, "Command not supported in pipeline mode", 0 TSRMLS_CC);
+		RETURN_NULL();
+	}
+
 	if (!ssdb_geo_distance(ssdb_sock, key, key_len, member_a_key, member_a_key_len, member_b_key, member_b_key_len, INTERNAL_FUNCTION_PARAM_PASSTHRU)) {
 		RETURN_NULL();
 	}
 }
 
+PHP_METHOD(SSDB, pipeline) {
+	zval *object;
+	SSDBSock *ssdb_sock;
+
+	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "O", &object, ssdb_ce) == FAILURE) {
+		RETURN_NULL();
+	}
+
+	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
+		RETURN_NULL();
+	}
+
+	//pipeline中不再合并,先发送已合并的get
+	ssdb_batch_exec(ssdb_sock TSRMLS_CC);
+	ssdb_pipeline_begin(ssdb_sock);
+
+	RETURN_ZVAL(object, 1, 0);
+}
+
+//下一个写命令不等待响应
+PHP_METHOD(SSDB, noreply) {
+	zval *object;
+	SSDBSock *ssdb_sock;
+
+	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "O", &object, ssdb_ce) == FAILURE) {
+		RETURN_NULL();
+	}
+
+	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
+		RETURN_NULL();
+	}
+
+	ssdb_sock->noreply_next = 1;
+
+	RETURN_ZVAL(object, 1, 0);
+}
+
+//下一个写命令先缓存,flush或请求结束时发送
+PHP_METHOD(SSDB, defer) {
+	zval *object;
+	SSDBSock *ssdb_sock;
+
+	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "O", &object, ssdb_ce) == FAILURE) {
+		RETURN_NULL();
+	}
+
+	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
+		RETURN_NULL();
+	}
+
+	ssdb_sock->defer_next = 1;
+
+	RETURN_ZVAL(object, 1, 0);
+}
+
+PHP_METHOD(SSDB, flush) {
+	zval *object;
+	SSDBSock *ssdb_sock;
+	int num;
+
+	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "O", &object, ssdb_ce) == FAILURE) {
+		RETURN_NULL();
+	}
+
+	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
+		RETURN_NULL();
+	}
+
+	num = ssdb_defer_flush(ssdb_sock);
+	if (num < 0) {
+		RETURN_NULL();
+	}
+
+	RETURN_LONG(num);
+}
+
+//之后的get/hget/zget返回SSDBPromise,endBatch时合并成multi_*发送
+PHP_METHOD(SSDB, beginBatch) {
+	zval *object;
+	SSDBSock *ssdb_sock;
+
+	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "O", &object, ssdb_ce) == FAILURE) {
+		RETURN_NULL();
+	}
+
+	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
+		RETURN_NULL();
+	}
+
+	if (ssdb_sock->pipeline) {
+		zend_throw_exception(ssdb_exception_ce, "Command not supported in pipeline mode", 0 TSRMLS_CC);
+		RETURN_NULL();
+	}
+
+	ssdb_batch_begin(ssdb_sock);
+
+	RETURN_ZVAL(object, 1, 0);
+}
+
+PHP_METHOD(SSDB, endBatch) {
+	zval *object;
+	SSDBSock *ssdb_sock;
+
+	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "O", &object, ssdb_ce) == FAILURE) {
+		RETURN_NULL();
+	}
+
+	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
+		RETURN_NULL();
+	}
+
+	RETURN_BOOL(ssdb_batch_end(ssdb_sock TSRMLS_CC) == SUCCESS);
+}
+
+//回调中的get/hget/zget合并发送,返回回调的返回值
+PHP_METHOD(SSDB, batch) {
+	zval *object, *retval = NULL, **params[1];
+	zend_fcall_info fci;
+	zend_fcall_info_cache fcc;
+	SSDBSock *ssdb_sock;
+
+	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Of", &object, ssdb_ce, &fci, &fcc) == FAILURE) {
+		RETURN_NULL();
+	}
+
+	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
+		RETURN_NULL();
+	}
+
+	if (ssdb_sock->pipeline) {
+		zend_throw_exception(ssdb_exception_ce, "Command not supported in pipeline mode", 0 TSRMLS_CC);
+		RETURN_NULL();
+	}
+
+	ssdb_batch_begin(ssdb_sock);
+
+	params[0] = &object;
+	fci.params = params;
+	fci.param_count = 1;
+	fci.retval_ptr_ptr = &retval;
+	fci.no_separation = 0;
+
+	zend_call_function(&fci, &fcc TSRMLS_CC);
+
+	//回调中抛出异常时也发送,已返回的promise都能取到结果
+	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 1) >= 0) {
+		ssdb_batch_end(ssdb_sock TSRMLS_CC);
+	}
+
+	if (retval) {
+		RETURN_ZVAL(retval, 1, 1);
+	}
+}
+
+PHP_METHOD(SSDB, exec) {
+	zval *object;
+	SSDBSock *ssdb_sock;
+
+	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "O", &object, ssdb_ce) == FAILURE) {
+		RETURN_NULL();
+	}
+
+	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0
+			|| !ssdb_sock->pipeline) {
+		RETURN_NULL();
+	}
+
+	ssdb_pipeline_exec(ssdb_sock, return_value TSRMLS_CC);
+}
+
+PHP_METHOD(SSDB, scanIterator) {
+	zval *object;
+	SSDBSock *ssdb_sock;
+	char *type = NULL, *start = NULL, *end = NULL, *name = NULL;
+	int type_len = 0, start_len = 0, end_len = 0, name_len = 0;
+	long batch = SSDB_SCAN_DEFAULT_BATCH;
+
+	if (zend_parse_method_parameters(ZEND_NUM_ARGS() TSRMLS_CC, getThis(), "Osss|ls!",
+			&object, ssdb_ce,
+			&type, &type_len,
+			&start, &start_len,
+			&end, &end_len,
+			&batch,
+			&name, &name_len) == FAILURE
+			|| batch <= 0) {
+		RETURN_NULL();
+	}
+
+	if (ssdb_sock_get(object, &ssdb_sock TSRMLS_CC, 0) < 0) {
+		RETURN_NULL();
+	}
+
+	if (ssdb_sock->pipeline) {
+		zend_throw_exception(ssdb_exception_ce, "Command not supported in pipeline mode", 0 TSRMLS_CC);
+		RETURN_NULL();
+	}
+
+	if (ssdb_scan_iterator_init(return_value, object, ssdb_sock,
+			type, type_len,
+			start, start_len,
+			end, end_len,
+			batch,
+			name, name_len TSRMLS_CC) == FAILURE) {
+		RETURN_NULL();
+	}
+}
+
 PHP_METHOD(SSDB, close) {
 	zval *object;
 	SSDBSock *ssdb_sock;
@@ -3477,6 +1577,8 @@ PHP_METHOD(SSDB, close) {
 		RETURN_NULL();
 	}
 
+	ssdb_pipeline_discard(ssdb_sock);
+
     if (ssdb_disconnect_socket(ssdb_sock)) {
         RETURN_TRUE;
     }
@@ -3484,6 +1586,23 @@ PHP_METHOD(SSDB, close) {
     RETURN_FALSE;
 }
 
+//请求结束前发出defer的命令并读掉noreply命令的响应,长连接可以继续复用
+void ssdb_request_shutdown(TSRMLS_D) {
+	HashPosition pos;
+	zend_rsrc_list_entry *le;
+
+	for (zend_hash_internal_pointer_reset_ex(&EG(regular_list), &pos);
+			zend_hash_get_current_data_ex(&EG(regular_list), (void **) &le, &pos) == SUCCESS;
+			zend_hash_move_forward_ex(&EG(regular_list), &pos)) {
+		if (le->type != le_ssdb_sock) {
+			continue;
+		}
+
+		ssdb_sock_finish((SSDBSock *) le->ptr);
+		ssdb_read_cache_reset((SSDBSock *) le->ptr);
+	}
+}
+
 static void ssdb_destructor_socket(zend_rsrc_list_entry * rsrc TSRMLS_DC) {
 	SSDBSock *ssdb_sock = (SSDBSock *) rsrc->ptr;
 	ssdb_disconnect_socket(ssdb_sock TSRMLS_CC);
@@ -3496,6 +1615,7 @@ const zend_function_entry ssdb_class_methods[] = {
 	PHP_ME(SSDB, option,      NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(SSDB, pconnect,    NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(SSDB, connect,     NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDB, connectMulti, NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(SSDB, close,       NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(SSDB, auth,        NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(SSDB, ping,        NULL, ZEND_ACC_PUBLIC)
@@ -3599,6 +1719,20 @@ const zend_function_entry ssdb_class_methods[] = {
 	PHP_ME(SSDB, geo_get,  NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(SSDB, geo_neighbour, NULL, ZEND_ACC_PUBLIC)
 	PHP_ME(SSDB, geo_distance, NULL, ZEND_ACC_PUBLIC)
+	//pipeline
+	PHP_ME(SSDB, pipeline, NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDB, exec,     NULL, ZEND_ACC_PUBLIC)
+	//noreply
+	PHP_ME(SSDB, noreply,  NULL, ZEND_ACC_PUBLIC)
+	//defer
+	PHP_ME(SSDB, defer,    NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDB, flush,    NULL, ZEND_ACC_PUBLIC)
+	//batch
+	PHP_ME(SSDB, beginBatch, NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDB, endBatch,   NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDB, batch,      NULL, ZEND_ACC_PUBLIC)
+	//iterator
+	PHP_ME(SSDB, scanIterator, NULL, ZEND_ACC_PUBLIC)
 	{NULL, NULL, NULL}
 };
 
@@ -3627,11 +1761,34 @@ void register_ssdb_class(int module_number TSRMLS_DC) {
 	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("OPT_PREFIX"),          SSDB_OPT_PREFIX TSRMLS_CC);
 	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("OPT_READ_TIMEOUT"),    SSDB_OPT_READ_TIMEOUT TSRMLS_CC);
 	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("OPT_SERIALIZER"),      SSDB_OPT_SERIALIZER TSRMLS_CC);
+	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("OPT_RESULT_SET"),      SSDB_OPT_RESULT_SET TSRMLS_CC);
+	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("OPT_SCAN_PREFETCH"),   SSDB_OPT_SCAN_PREFETCH TSRMLS_CC);
+	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("OPT_READ_POLICY"),     SSDB_OPT_READ_POLICY TSRMLS_CC);
+	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("OPT_NOREPLY"),         SSDB_OPT_NOREPLY TSRMLS_CC);
+	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("OPT_READ_CACHE"),      SSDB_OPT_READ_CACHE TSRMLS_CC);
+	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("OPT_SHM_CACHE"),       SSDB_OPT_SHM_CACHE TSRMLS_CC);
+	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("OPT_COMPRESSION"),     SSDB_OPT_COMPRESSION TSRMLS_CC);
+	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("OPT_COMPRESSION_THRESHOLD"), SSDB_OPT_COMPRESSION_THRESHOLD TSRMLS_CC);
 	zend_declare_class_constant_stringl(ssdb_ce, ZEND_STRL("VERSION"),             ZEND_STRL(PHP_SSDB_VERSION) TSRMLS_CC);
 
 	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("SERIALIZER_NONE"),     SSDB_SERIALIZER_NONE TSRMLS_CC);
 	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("SERIALIZER_PHP"),      SSDB_SERIALIZER_PHP TSRMLS_CC);
 	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("SERIALIZER_IGBINARY"), SSDB_SERIALIZER_IGBINARY TSRMLS_CC);
+	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("SERIALIZER_MSGPACK"),  SSDB_SERIALIZER_MSGPACK TSRMLS_CC);
+	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("COMPRESSION_NONE"),    SSDB_COMPRESSION_NONE TSRMLS_CC);
+	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("COMPRESSION_LZ4"),     SSDB_COMPRESSION_LZ4 TSRMLS_CC);
+	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("COMPRESSION_ZSTD"),    SSDB_COMPRESSION_ZSTD TSRMLS_CC);
+	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("COMPRESSION_ZSTD_DICT"), SSDB_COMPRESSION_ZSTD_DICT TSRMLS_CC);
+
+	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("READ_MASTER"),            SSDB_READ_MASTER TSRMLS_CC);
+	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("READ_ROUND_ROBIN"),       SSDB_READ_ROUND_ROBIN TSRMLS_CC);
+	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("READ_LEAST_OUTSTANDING"), SSDB_READ_LEAST_OUTSTANDING TSRMLS_CC);
+	zend_declare_class_constant_long(ssdb_ce,    ZEND_STRL("READ_LATENCY"),           SSDB_READ_LATENCY TSRMLS_CC);
 
 	zend_register_class_alias_ex(ZEND_STRL("SimpleSSDB"), ssdb_ce TSRMLS_CC);
+
+	register_ssdb_result_set_class(TSRMLS_C);
+	register_ssdb_scan_iterator_class(TSRMLS_C);
+	register_ssdb_cluster_class(TSRMLS_C);
+	register_ssdb_promise_class(TSRMLS_C);
 }
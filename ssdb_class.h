@@ -22,10 +22,19 @@
 #define SSDB_OPT_PREFIX		  1
 #define SSDB_OPT_READ_TIMEOUT 2
 #define SSDB_OPT_SERIALIZER   3
+#define SSDB_OPT_RESULT_SET   4
+#define SSDB_OPT_SCAN_PREFETCH 5
+#define SSDB_OPT_READ_POLICY  6
+#define SSDB_OPT_NOREPLY      7
+#define SSDB_OPT_READ_CACHE   8
+#define SSDB_OPT_SHM_CACHE    9
+#define SSDB_OPT_COMPRESSION  10
+#define SSDB_OPT_COMPRESSION_THRESHOLD 11
 
 PHP_METHOD(SSDB, __construct);
 PHP_METHOD(SSDB, pconnect);
 PHP_METHOD(SSDB, connect);
+PHP_METHOD(SSDB, connectMulti);
 PHP_METHOD(SSDB, auth);
 PHP_METHOD(SSDB, ping);
 PHP_METHOD(SSDB, option);
@@ -125,9 +134,24 @@ PHP_METHOD(SSDB, geo_set);
 PHP_METHOD(SSDB, geo_get);
 PHP_METHOD(SSDB, geo_neighbour);
 PHP_METHOD(SSDB, geo_distance);
+//pipeline
+PHP_METHOD(SSDB, pipeline);
+PHP_METHOD(SSDB, exec);
+//noreply
+PHP_METHOD(SSDB, noreply);
+//defer
+PHP_METHOD(SSDB, defer);
+PHP_METHOD(SSDB, flush);
+//batch
+PHP_METHOD(SSDB, beginBatch);
+PHP_METHOD(SSDB, endBatch);
+PHP_METHOD(SSDB, batch);
+//iterator
+PHP_METHOD(SSDB, scanIterator);
 //close
 PHP_METHOD(SSDB, close);
 
 void register_ssdb_class(int module_number TSRMLS_DC);
+void ssdb_request_shutdown(TSRMLS_D);
 
 #endif /* EXT_SSDB_SSDB_CLASS_H_ */
@@ -0,0 +1,632 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2014 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: xingqiba ixqbar@gmail.com                                                             |
+  +----------------------------------------------------------------------+
+*/
+
+#include "php.h"
+#include "ext/standard/md5.h"
+#include "Zend/zend_exceptions.h"
+
+#include <stdint.h>
+
+#include "ssdb_library.h"
+#include "ssdb_class.h"
+#include "ssdb_cluster.h"
+
+zend_class_entry *ssdb_cluster_ce;
+
+static zend_object_handlers ssdb_cluster_handlers;
+
+#define SSDB_CLUSTER_FETCH(cluster) SSDBCluster *cluster = (SSDBCluster *) zend_object_store_get_object(getThis() TSRMLS_CC)
+
+//没有key或需要遍历全部key的命令
+static const char *ssdb_cluster_unsupported[] = {
+	"keys", "scan", "rscan", "hlist", "hrlist", "zlist", "zrlist", "qlist", "qrlist",
+	"dbsize", "version", "request", "read", "write", "pipeline", "exec", "scaniterator",
+	"connect", "pconnect", "connectmulti",
+	NULL
+};
+
+static void ssdb_cluster_free(void *object TSRMLS_DC) {
+	SSDBCluster *cluster = (SSDBCluster *) object;
+	int i;
+
+	for (i = 0; i < cluster->num; i++) {
+		zval_ptr_dtor(&cluster->nodes[i]);
+		efree(cluster->names[i]);
+	}
+
+	if (cluster->nodes) efree(cluster->nodes);
+	if (cluster->names) efree(cluster->names);
+	if (cluster->ring) efree(cluster->ring);
+	if (cluster->prefix) efree(cluster->prefix);
+
+	zend_object_std_dtor(&cluster->std TSRMLS_CC);
+	efree(cluster);
+}
+
+static zend_object_value ssdb_cluster_create(zend_class_entry *ce TSRMLS_DC) {
+	zend_object_value retval;
+	SSDBCluster *cluster = ecalloc(1, sizeof(SSDBCluster));
+
+	zend_object_std_init(&cluster->std, ce TSRMLS_CC);
+#if PHP_VERSION_ID < 50399
+	zend_hash_copy(cluster->std.properties, &ce->default_properties, (copy_ctor_func_t) zval_add_ref, NULL, sizeof(zval *));
+#else
+	object_properties_init(&cluster->std, ce);
+#endif
+
+	retval.handle = zend_objects_store_put(cluster,
+			(zend_objects_store_dtor_t) zend_objects_destroy_object,
+			(zend_objects_free_object_storage_t) ssdb_cluster_free,
+			NULL TSRMLS_CC);
+	retval.handlers = &ssdb_cluster_handlers;
+
+	return retval;
+}
+
+static int ssdb_cluster_point_compare(const void *a, const void *b) {
+	unsigned int pa = ((const SSDBClusterPoint *) a)->point;
+	unsigned int pb = ((const SSDBClusterPoint *) b)->point;
+
+	return pa < pb ? -1 : (pa > pb ? 1 : 0);
+}
+
+static unsigned int ssdb_cluster_md5_point(const unsigned char *digest, int h) {
+	return ((unsigned int) digest[3 + h * 4] << 24)
+			| ((unsigned int) digest[2 + h * 4] << 16)
+			| ((unsigned int) digest[1 + h * 4] << 8)
+			| digest[h * 4];
+}
+
+//与libketama相同的环:每个节点160个点,每次md5生成4个点
+static void ssdb_cluster_ring_build(SSDBCluster *cluster) {
+	PHP_MD5_CTX context;
+	unsigned char digest[16];
+	char *buf = NULL;
+	int i, j, h, buf_len;
+
+	cluster->ring_num = cluster->num * SSDB_CLUSTER_KETAMA_POINTS;
+	cluster->ring = emalloc(cluster->ring_num * sizeof(SSDBClusterPoint));
+
+	for (i = 0; i < cluster->num; i++) {
+		for (j = 0; j < SSDB_CLUSTER_KETAMA_POINTS / 4; j++) {
+			buf_len = spprintf(&buf, 0, "%s-%d", cluster->names[i], j);
+			PHP_MD5Init(&context);
+			PHP_MD5Update(&context, (unsigned char *) buf, buf_len);
+			PHP_MD5Final(digest, &context);
+			efree(buf);
+
+			for (h = 0; h < 4; h++) {
+				SSDBClusterPoint *point = &cluster->ring[i * SSDB_CLUSTER_KETAMA_POINTS + j * 4 + h];
+				point->point = ssdb_cluster_md5_point(digest, h);
+				point->node = i;
+			}
+		}
+	}
+
+	qsort(cluster->ring, cluster->ring_num, sizeof(SSDBClusterPoint), ssdb_cluster_point_compare);
+}
+
+static int ssdb_cluster_ketama(SSDBCluster *cluster, const char *key, int key_len) {
+	PHP_MD5_CTX context;
+	unsigned char digest[16];
+	unsigned int point;
+	int low = 0, high = cluster->ring_num;
+
+	PHP_MD5Init(&context);
+	if (cluster->prefix) {
+		PHP_MD5Update(&context, (unsigned char *) cluster->prefix, cluster->prefix_len);
+	}
+	PHP_MD5Update(&context, (unsigned char *) key, key_len);
+	PHP_MD5Final(digest, &context);
+
+	point = ssdb_cluster_md5_point(digest, 0);
+
+	//第一个不小于point的点
+	while (low < high) {
+		int mid = low + (high - low) / 2;
+		if (cluster->ring[mid].point < point) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	return cluster->ring[low == cluster->ring_num ? 0 : low].node;
+}
+
+//Lamping & Veach jump consistent hash,key先做fnv-1a 64
+static int ssdb_cluster_jump(SSDBCluster *cluster, const char *key, int key_len) {
+	uint64_t hash = 14695981039346656037ULL;
+	int64_t b = -1, j = 0;
+	int i;
+
+	for (i = 0; i < cluster->prefix_len; i++) {
+		hash ^= (unsigned char) cluster->prefix[i];
+		hash *= 1099511628211ULL;
+	}
+
+	for (i = 0; i < key_len; i++) {
+		hash ^= (unsigned char) key[i];
+		hash *= 1099511628211ULL;
+	}
+
+	while (j < cluster->num) {
+		b = j;
+		hash = hash * 2862933555777941757ULL + 1;
+		j = (int64_t) ((b + 1) * ((double) (1LL << 31) / (double) ((hash >> 33) + 1)));
+	}
+
+	return (int) b;
+}
+
+static int ssdb_cluster_node_index(SSDBCluster *cluster, zval *z_key) {
+	zval copy;
+	int index;
+
+	if (Z_TYPE_P(z_key) == IS_STRING) {
+		return cluster->hash == SSDB_CLUSTER_HASH_KETAMA
+				? ssdb_cluster_ketama(cluster, Z_STRVAL_P(z_key), Z_STRLEN_P(z_key))
+				: ssdb_cluster_jump(cluster, Z_STRVAL_P(z_key), Z_STRLEN_P(z_key));
+	}
+
+	copy = *z_key;
+	zval_copy_ctor(&copy);
+	convert_to_string(&copy);
+	index = ssdb_cluster_node_index(cluster, &copy);
+	zval_dtor(&copy);
+
+	return index;
+}
+
+static int ssdb_cluster_key_index(SSDBCluster *cluster, char *key, uint key_len, ulong index) {
+	zval z_key;
+
+	if (key == NULL) {
+		ZVAL_LONG(&z_key, index);
+		return ssdb_cluster_node_index(cluster, &z_key);
+	}
+
+	ZVAL_STRINGL(&z_key, key, key_len - 1, 0);
+	return ssdb_cluster_node_index(cluster, &z_key);
+}
+
+static void ssdb_cluster_call(zval *node, const char *name, int name_len, int argc, zval **params, zval *return_value TSRMLS_DC) {
+	zval z_name;
+
+	ZVAL_STRINGL(&z_name, name, name_len, 0);
+	if (call_user_function(&Z_OBJCE_P(node)->function_table, &node, &z_name, return_value, argc, params TSRMLS_CC) == FAILURE) {
+		ZVAL_NULL(return_value);
+	}
+}
+
+//在全部节点上执行,全部返回true时返回true
+static void ssdb_cluster_broadcast(SSDBCluster *cluster, const char *name, int name_len, int argc, zval **params, zval *return_value TSRMLS_DC) {
+	zval result;
+	int i, ok = 1;
+
+	for (i = 0; i < cluster->num; i++) {
+		INIT_ZVAL(result);
+		ssdb_cluster_call(cluster->nodes[i], name, name_len, argc, params, &result TSRMLS_CC);
+		if (!zend_is_true(&result)) {
+			ok = 0;
+		}
+		zval_dtor(&result);
+		if (EG(exception)) {
+			break;
+		}
+	}
+
+	RETVAL_BOOL(ok);
+}
+
+PHP_METHOD(SSDBCluster, __construct) {
+	zval *z_endpoints, **z_endpoint;
+	HashPosition pos;
+	long hash = SSDB_CLUSTER_HASH_JUMP, timeout = 30;
+	SSDB_CLUSTER_FETCH(cluster);
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "a|ll", &z_endpoints, &hash, &timeout) == FAILURE) {
+		RETURN_FALSE;
+	}
+
+	if (cluster->num > 0 || zend_hash_num_elements(Z_ARRVAL_P(z_endpoints)) == 0) {
+		zend_throw_exception(ssdb_exception_ce, "Invalid endpoints", 0 TSRMLS_CC);
+		RETURN_FALSE;
+	}
+
+	if (timeout <= 0 || timeout > INT_MAX) {
+		timeout = 30;
+	}
+
+	cluster->hash  = hash == SSDB_CLUSTER_HASH_KETAMA ? SSDB_CLUSTER_HASH_KETAMA : SSDB_CLUSTER_HASH_JUMP;
+	cluster->nodes = ecalloc(zend_hash_num_elements(Z_ARRVAL_P(z_endpoints)), sizeof(zval *));
+	cluster->names = ecalloc(zend_hash_num_elements(Z_ARRVAL_P(z_endpoints)), sizeof(char *));
+
+	//host:port 或 host,节点在第一次使用时才连接
+	for (zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(z_endpoints), &pos);
+			zend_hash_get_current_data_ex(Z_ARRVAL_P(z_endpoints), (void **) &z_endpoint, &pos) == SUCCESS;
+			zend_hash_move_forward_ex(Z_ARRVAL_P(z_endpoints), &pos)) {
+		SSDBSock *ssdb_sock;
+		zval *node;
+		char *sep;
+		int host_len;
+		long port = 8888;
+
+		if (Z_TYPE_PP(z_endpoint) != IS_STRING || Z_STRLEN_PP(z_endpoint) == 0) {
+			continue;
+		}
+
+		sep = zend_memrchr(Z_STRVAL_PP(z_endpoint), ':', Z_STRLEN_PP(z_endpoint));
+		if (sep) {
+			host_len = sep - Z_STRVAL_PP(z_endpoint);
+			port = atol(sep + 1);
+		} else {
+			host_len = Z_STRLEN_PP(z_endpoint);
+		}
+
+		MAKE_STD_ZVAL(node);
+		object_init_ex(node, ssdb_ce);
+		ssdb_sock = ssdb_create_sock(Z_STRVAL_PP(z_endpoint), host_len, port, timeout, 0, NULL, 0, 1);
+		ssdb_sock_attach(node, ssdb_sock TSRMLS_CC);
+
+		cluster->nodes[cluster->num] = node;
+		spprintf(&cluster->names[cluster->num], 0, "%.*s:%ld", host_len, Z_STRVAL_PP(z_endpoint), port);
+		cluster->num++;
+	}
+
+	if (cluster->num == 0) {
+		zend_throw_exception(ssdb_exception_ce, "Invalid endpoints", 0 TSRMLS_CC);
+		RETURN_FALSE;
+	}
+
+	if (cluster->hash == SSDB_CLUSTER_HASH_KETAMA) {
+		ssdb_cluster_ring_build(cluster);
+	}
+}
+
+//按第一个参数(key或hash/zset/queue名称)转发到对应节点
+PHP_METHOD(SSDBCluster, __call) {
+	char *name, *lc_name;
+	int name_len, argc, i = 0;
+	zval *z_args, **z_arg, **params;
+	HashPosition pos;
+	SSDB_CLUSTER_FETCH(cluster);
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "sa", &name, &name_len, &z_args) == FAILURE) {
+		RETURN_NULL();
+	}
+
+	lc_name = zend_str_tolower_dup(name, name_len);
+	for (i = 0; ssdb_cluster_unsupported[i] != NULL; i++) {
+		if (0 == strcmp(lc_name, ssdb_cluster_unsupported[i])) {
+			efree(lc_name);
+			zend_throw_exception(ssdb_exception_ce, "Command not supported by SSDBCluster", 0 TSRMLS_CC);
+			RETURN_NULL();
+		}
+	}
+
+	argc = zend_hash_num_elements(Z_ARRVAL_P(z_args));
+	params = emalloc((argc + 1) * sizeof(zval *));
+	for (i = 0, zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(z_args), &pos);
+			zend_hash_get_current_data_ex(Z_ARRVAL_P(z_args), (void **) &z_arg, &pos) == SUCCESS;
+			zend_hash_move_forward_ex(Z_ARRVAL_P(z_args), &pos), i++) {
+		params[i] = *z_arg;
+	}
+
+	//auth/ping在所有节点上执行
+	if (0 == strcmp(lc_name, "auth") || 0 == strcmp(lc_name, "ping")) {
+		ssdb_cluster_broadcast(cluster, name, name_len, argc, params, return_value TSRMLS_CC);
+	} else if (argc > 0 && cluster->num > 0) {
+		ssdb_cluster_call(cluster->nodes[ssdb_cluster_node_index(cluster, params[0])], name, name_len, argc, params, return_value TSRMLS_CC);
+	}
+
+	efree(lc_name);
+
+	efree(params);
+}
+
+//返回key所在的SSDB对象
+PHP_METHOD(SSDBCluster, node) {
+	zval *z_key;
+	SSDB_CLUSTER_FETCH(cluster);
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "z", &z_key) == FAILURE || cluster->num == 0) {
+		RETURN_NULL();
+	}
+
+	RETURN_ZVAL(cluster->nodes[ssdb_cluster_node_index(cluster, z_key)], 1, 0);
+}
+
+PHP_METHOD(SSDBCluster, nodes) {
+	int i;
+	SSDB_CLUSTER_FETCH(cluster);
+
+	array_init_size(return_value, cluster->num);
+	for (i = 0; i < cluster->num; i++) {
+		Z_ADDREF_P(cluster->nodes[i]);
+		add_assoc_zval(return_value, cluster->names[i], cluster->nodes[i]);
+	}
+}
+
+PHP_METHOD(SSDBCluster, option) {
+	zval *z_option, *z_value, *params[2];
+	SSDB_CLUSTER_FETCH(cluster);
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "zz", &z_option, &z_value) == FAILURE) {
+		RETURN_NULL();
+	}
+
+	params[0] = z_option;
+	params[1] = z_value;
+	ssdb_cluster_broadcast(cluster, ZEND_STRL("option"), 2, params, return_value TSRMLS_CC);
+
+	//hash计算使用加前缀后的key
+	if (Z_TYPE_P(return_value) == IS_BOOL && Z_BVAL_P(return_value)
+			&& Z_TYPE_P(z_option) == IS_LONG && Z_LVAL_P(z_option) == SSDB_OPT_PREFIX) {
+		zval copy = *z_value;
+		zval_copy_ctor(&copy);
+		convert_to_string(&copy);
+
+		if (cluster->prefix) efree(cluster->prefix);
+		cluster->prefix = NULL;
+		cluster->prefix_len = 0;
+		if (Z_STRLEN(copy) > 0) {
+			cluster->prefix = estrndup(Z_STRVAL(copy), Z_STRLEN(copy));
+			cluster->prefix_len = Z_STRLEN(copy);
+		}
+		zval_dtor(&copy);
+	}
+}
+
+PHP_METHOD(SSDBCluster, close) {
+	SSDB_CLUSTER_FETCH(cluster);
+
+	ssdb_cluster_broadcast(cluster, ZEND_STRL("close"), 0, NULL, return_value TSRMLS_CC);
+}
+
+//multi_*命令按节点拆分,先向所有节点写出请求,再依次读取响应
+typedef struct {
+	SSDBSock *ssdb_sock;
+	zval *args;
+	int sent;
+	zval *result;
+} SSDBClusterBatch;
+
+static SSDBClusterBatch *ssdb_cluster_batch_split(SSDBCluster *cluster, zval *z_args, int with_value TSRMLS_DC) {
+	SSDBClusterBatch *batch = ecalloc(cluster->num, sizeof(SSDBClusterBatch));
+	HashPosition pos;
+	zval **z_item;
+	char *key;
+	uint key_len;
+	ulong index;
+	int node;
+
+	for (zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(z_args), &pos);
+			zend_hash_get_current_data_ex(Z_ARRVAL_P(z_args), (void **) &z_item, &pos) == SUCCESS;
+			zend_hash_move_forward_ex(Z_ARRVAL_P(z_args), &pos)) {
+		if (with_value) {
+			int type = zend_hash_get_current_key_ex(Z_ARRVAL_P(z_args), &key, &key_len, &index, 0, &pos);
+			node = ssdb_cluster_key_index(cluster, type == HASH_KEY_IS_STRING ? key : NULL, key_len, index);
+		} else {
+			node = ssdb_cluster_node_index(cluster, *z_item);
+		}
+
+		if (batch[node].args == NULL) {
+			MAKE_STD_ZVAL(batch[node].args);
+			array_init(batch[node].args);
+		}
+
+		Z_ADDREF_PP(z_item);
+		if (with_value) {
+			if (zend_hash_get_current_key_ex(Z_ARRVAL_P(z_args), &key, &key_len, &index, 0, &pos) == HASH_KEY_IS_STRING) {
+				add_assoc_zval_ex(batch[node].args, key, key_len, *z_item);
+			} else {
+				add_index_zval(batch[node].args, index, *z_item);
+			}
+		} else {
+			add_next_index_zval(batch[node].args, *z_item);
+		}
+	}
+
+	return batch;
+}
+
+//is_write为1时先丢弃各节点上这些key的读缓存
+static void ssdb_cluster_batch_send(SSDBCluster *cluster, SSDBClusterBatch *batch, char *cmd_name, int cmd_name_len, int with_value, int is_write TSRMLS_DC) {
+	SSDBWriteVec vec;
+	int i;
+
+	for (i = 0; i < cluster->num; i++) {
+		if (batch[i].args == NULL
+				|| ssdb_sock_get(cluster->nodes[i], &batch[i].ssdb_sock TSRMLS_CC, 0) < 0
+				|| batch[i].ssdb_sock->pipeline) {
+			continue;
+		}
+
+		if (is_write) {
+			ssdb_read_cache_forget_zval(batch[i].ssdb_sock, batch[i].args, with_value);
+		}
+		ssdb_wvec_init(&vec, SSDB_WRITEV_THRESHOLD);
+		if (ssdb_cmd_vec_by_zval(batch[i].ssdb_sock, &vec, cmd_name, cmd_name_len, "", 0, batch[i].args, with_value, 1, with_value) > 0
+				&& ssdb_sock_writev(batch[i].ssdb_sock, &vec) >= 0) {
+			batch[i].sent = 1;
+		}
+		ssdb_wvec_free(&vec);
+	}
+}
+
+static void ssdb_cluster_batch_free(SSDBCluster *cluster, SSDBClusterBatch *batch) {
+	int i;
+
+	for (i = 0; i < cluster->num; i++) {
+		if (batch[i].args) zval_ptr_dtor(&batch[i].args);
+		if (batch[i].result) zval_ptr_dtor(&batch[i].result);
+	}
+
+	efree(batch);
+}
+
+//读取各节点的long响应并求和,有节点失败时返回NULL
+static void ssdb_cluster_batch_sum(SSDBCluster *cluster, SSDBClusterBatch *batch, zval *return_value TSRMLS_DC) {
+	long total = 0;
+	int i, failed = 0;
+
+	for (i = 0; i < cluster->num; i++) {
+		if (batch[i].args == NULL) {
+			continue;
+		}
+
+		if (!batch[i].sent) {
+			failed = 1;
+			continue;
+		}
+
+		MAKE_STD_ZVAL(batch[i].result);
+		ZVAL_NULL(batch[i].result);
+		ssdb_long_number_response(0, batch[i].result, NULL, NULL, 1 TSRMLS_CC, batch[i].ssdb_sock);
+		if (Z_TYPE_P(batch[i].result) == IS_LONG) {
+			total += Z_LVAL_P(batch[i].result);
+		} else {
+			failed = 1;
+		}
+	}
+
+	if (failed) {
+		RETVAL_NULL();
+	} else {
+		RETVAL_LONG(total);
+	}
+}
+
+PHP_METHOD(SSDBCluster, multi_get) {
+	zval *z_args, **z_key, **z_value;
+	SSDBClusterBatch *batch;
+	HashPosition pos;
+	int i;
+	SSDB_CLUSTER_FETCH(cluster);
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "a", &z_args) == FAILURE || cluster->num == 0) {
+		RETURN_NULL();
+	}
+
+	batch = ssdb_cluster_batch_split(cluster, z_args, 0 TSRMLS_CC);
+	ssdb_cluster_batch_send(cluster, batch, ZEND_STRL("multi_get"), 0, 0 TSRMLS_CC);
+
+	for (i = 0; i < cluster->num; i++) {
+		int result_set;
+
+		if (!batch[i].sent) {
+			continue;
+		}
+
+		//合并需要普通数组
+		result_set = batch[i].ssdb_sock->result_set;
+		batch[i].ssdb_sock->result_set = 0;
+
+		MAKE_STD_ZVAL(batch[i].result);
+		ZVAL_NULL(batch[i].result);
+		ssdb_map_response(0, batch[i].result, NULL, NULL, 1 TSRMLS_CC, batch[i].ssdb_sock, SSDB_FILTER_KEY_PREFIX, SSDB_UNSERIALIZE, SSDB_CONVERT_TO_STRING);
+
+		batch[i].ssdb_sock->result_set = result_set;
+	}
+
+	//按原始key顺序合并
+	array_init_size(return_value, zend_hash_num_elements(Z_ARRVAL_P(z_args)));
+	for (zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(z_args), &pos);
+			zend_hash_get_current_data_ex(Z_ARRVAL_P(z_args), (void **) &z_key, &pos) == SUCCESS;
+			zend_hash_move_forward_ex(Z_ARRVAL_P(z_args), &pos)) {
+		zval copy = **z_key;
+		zval *result = batch[ssdb_cluster_node_index(cluster, *z_key)].result;
+
+		if (result == NULL || Z_TYPE_P(result) != IS_ARRAY) {
+			continue;
+		}
+
+		zval_copy_ctor(&copy);
+		convert_to_string(&copy);
+		if (zend_symtable_find(Z_ARRVAL_P(result), Z_STRVAL(copy), Z_STRLEN(copy) + 1, (void **) &z_value) == SUCCESS) {
+			Z_ADDREF_PP(z_value);
+			add_assoc_zval_ex(return_value, Z_STRVAL(copy), Z_STRLEN(copy) + 1, *z_value);
+		}
+		zval_dtor(&copy);
+	}
+
+	ssdb_cluster_batch_free(cluster, batch);
+}
+
+PHP_METHOD(SSDBCluster, multi_set) {
+	zval *z_args;
+	SSDBClusterBatch *batch;
+	SSDB_CLUSTER_FETCH(cluster);
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "a", &z_args) == FAILURE || cluster->num == 0) {
+		RETURN_NULL();
+	}
+
+	batch = ssdb_cluster_batch_split(cluster, z_args, 1 TSRMLS_CC);
+	ssdb_cluster_batch_send(cluster, batch, ZEND_STRL("multi_set"), 1, 1 TSRMLS_CC);
+	ssdb_cluster_batch_sum(cluster, batch, return_value TSRMLS_CC);
+	ssdb_cluster_batch_free(cluster, batch);
+}
+
+PHP_METHOD(SSDBCluster, multi_del) {
+	zval *z_args;
+	SSDBClusterBatch *batch;
+	SSDB_CLUSTER_FETCH(cluster);
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "a", &z_args) == FAILURE || cluster->num == 0) {
+		RETURN_NULL();
+	}
+
+	batch = ssdb_cluster_batch_split(cluster, z_args, 0 TSRMLS_CC);
+	ssdb_cluster_batch_send(cluster, batch, ZEND_STRL("multi_del"), 0, 1 TSRMLS_CC);
+	ssdb_cluster_batch_sum(cluster, batch, return_value TSRMLS_CC);
+	ssdb_cluster_batch_free(cluster, batch);
+}
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_ssdb_cluster_call, 0, 0, 2)
+	ZEND_ARG_INFO(0, name)
+	ZEND_ARG_INFO(0, arguments)
+ZEND_END_ARG_INFO()
+
+const zend_function_entry ssdb_cluster_methods[] = {
+	PHP_ME(SSDBCluster, __construct, NULL, ZEND_ACC_PUBLIC | ZEND_ACC_CTOR)
+	PHP_ME(SSDBCluster, __call,      arginfo_ssdb_cluster_call, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBCluster, node,        NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBCluster, nodes,       NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBCluster, option,      NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBCluster, close,       NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBCluster, multi_get,   NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBCluster, multi_set,   NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBCluster, multi_del,   NULL, ZEND_ACC_PUBLIC)
+	{NULL, NULL, NULL}
+};
+
+void register_ssdb_cluster_class(TSRMLS_D) {
+	zend_class_entry ce;
+
+	INIT_CLASS_ENTRY(ce, "SSDBCluster", ssdb_cluster_methods);
+	ssdb_cluster_ce = zend_register_internal_class(&ce TSRMLS_CC);
+	ssdb_cluster_ce->create_object = ssdb_cluster_create;
+
+	memcpy(&ssdb_cluster_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
+	ssdb_cluster_handlers.clone_obj = NULL;
+
+	zend_declare_class_constant_long(ssdb_cluster_ce, ZEND_STRL("HASH_JUMP"),   SSDB_CLUSTER_HASH_JUMP TSRMLS_CC);
+	zend_declare_class_constant_long(ssdb_cluster_ce, ZEND_STRL("HASH_KETAMA"), SSDB_CLUSTER_HASH_KETAMA TSRMLS_CC);
+}
@@ -0,0 +1,61 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2014 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: xingqiba ixqbar@gmail.com                                                             |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef EXT_SSDB_SSDB_CLUSTER_H_
+#define EXT_SSDB_SSDB_CLUSTER_H_
+
+#include "ssdb_library.h"
+
+#define SSDB_CLUSTER_HASH_JUMP   0
+#define SSDB_CLUSTER_HASH_KETAMA 1
+
+#define SSDB_CLUSTER_KETAMA_POINTS 160
+
+typedef struct {
+	unsigned int point;
+	int node;
+} SSDBClusterPoint;
+
+//按key一致性hash分片的多个SSDB连接
+typedef struct {
+	zend_object std;
+	zval **nodes;      //SSDB对象
+	char **names;      //host:port
+	int num;
+	int hash;
+	char *prefix;
+	int prefix_len;
+	SSDBClusterPoint *ring;
+	int ring_num;
+} SSDBCluster;
+
+extern zend_class_entry *ssdb_cluster_ce;
+
+void register_ssdb_cluster_class(TSRMLS_D);
+
+PHP_METHOD(SSDBCluster, __construct);
+PHP_METHOD(SSDBCluster, __call);
+PHP_METHOD(SSDBCluster, node);
+PHP_METHOD(SSDBCluster, nodes);
+PHP_METHOD(SSDBCluster, option);
+PHP_METHOD(SSDBCluster, close);
+PHP_METHOD(SSDBCluster, multi_get);
+PHP_METHOD(SSDBCluster, multi_set);
+PHP_METHOD(SSDBCluster, multi_del);
+
+#endif /* EXT_SSDB_SSDB_CLUSTER_H_ */
@@ -0,0 +1,287 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2014 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: xingqiba ixqbar@gmail.com                                                             |
+  +----------------------------------------------------------------------+
+*/
+
+#include "php.h"
+#include "Zend/zend_exceptions.h"
+
+#include "ssdb_library.h"
+#include "ssdb_class.h"
+#include "ssdb_command.h"
+#include "ssdb_batch.h"
+#include "ssdb_shm.h"
+
+#define SSDB_COMMAND_ENTRY(name, args, def, read_only, write, reply, filter_prefix, unserialize, convert_type) \
+	{#name, sizeof(#name) - 1, args, def, read_only, write, reply, filter_prefix, unserialize, convert_type},
+
+const SSDBCommand ssdb_commands[SSDB_CMD_MAX] = {
+	SSDB_COMMAND_LIST(SSDB_COMMAND_ENTRY)
+};
+
+#undef SSDB_COMMAND_ENTRY
+
+//按zpp 'l'的规则转换参数
+static int ssdb_command_arg_long(zval *z, int num, long *lval TSRMLS_DC) {
+	double dval;
+
+	switch (Z_TYPE_P(z)) {
+		case IS_LONG:
+		case IS_BOOL:
+			*lval = Z_LVAL_P(z);
+			return SUCCESS;
+		case IS_NULL:
+			*lval = 0;
+			return SUCCESS;
+		case IS_DOUBLE:
+			*lval = zend_dval_to_lval(Z_DVAL_P(z));
+			return SUCCESS;
+		case IS_STRING:
+			switch (is_numeric_string(Z_STRVAL_P(z), Z_STRLEN_P(z), lval, &dval, -1)) {
+				case IS_LONG:
+					return SUCCESS;
+				case IS_DOUBLE:
+					*lval = zend_dval_to_lval(dval);
+					return SUCCESS;
+			}
+			break;
+	}
+
+	php_error_docref(NULL TSRMLS_CC, E_WARNING, "expects parameter %d to be long, %s given", num, zend_zval_type_name(z));
+	return FAILURE;
+}
+
+//defer时按key累加的计数命令,最后一个参数为增量
+static int ssdb_command_summable(const SSDBCommand *command) {
+	return command == &ssdb_commands[SSDB_CMD_incr]
+		|| command == &ssdb_commands[SSDB_CMD_hincr]
+		|| command == &ssdb_commands[SSDB_CMD_zincr];
+}
+
+//开启读缓存后可以缓存响应的读命令
+static int ssdb_command_cacheable(const SSDBCommand *command) {
+	return command == &ssdb_commands[SSDB_CMD_get]
+		|| command == &ssdb_commands[SSDB_CMD_hget]
+		|| command == &ssdb_commands[SSDB_CMD_hgetall];
+}
+
+//共享内存缓存只用于get/hget
+static int ssdb_command_shm_cacheable(SSDBSock *ssdb_sock, const SSDBCommand *command) {
+	return ssdb_sock->shm_cache_ttl > 0
+		&& ssdb_shm_enabled()
+		&& command != &ssdb_commands[SSDB_CMD_hgetall];
+}
+
+void ssdb_command_dispatch(INTERNAL_FUNCTION_PARAMETERS, const SSDBCommand *command) {
+	zval **args[SSDB_COMMAND_MAX_ARGS], tmp[SSDB_COMMAND_MAX_ARGS], *z;
+	int tmp_used[SSDB_COMMAND_MAX_ARGS] = {0};
+	char kinds[SSDB_COMMAND_MAX_ARGS];
+	SSDBArg argv[SSDB_COMMAND_MAX_ARGS + 1];
+	char *val[SSDB_COMMAND_MAX_ARGS], *key, *cmd = NULL;
+	int val_free[SSDB_COMMAND_MAX_ARGS] = {0};
+	int argc = ZEND_NUM_ARGS(), min = -1, max = 0, i, key_len, val_len, cmd_len = 0, handled = 0, cacheable = 0, cached = 0, shm = 0;
+	long sock_id;
+	const char *spec;
+	SSDBSock *ssdb_sock = NULL;
+	long lval;
+
+	for (spec = command->args; *spec; spec++) {
+		if ('|' == *spec) {
+			min = max;
+			continue;
+		}
+		kinds[max++] = *spec;
+	}
+	if (min < 0) min = max;
+
+	if (argc < min || argc > max
+			|| (argc > 0 && zend_get_parameters_array_ex(argc, args) == FAILURE)) {
+		zend_wrong_param_count(TSRMLS_C);
+		RETURN_NULL();
+	}
+
+	argv[0].type = SSDB_ARG_STRING;
+	argv[0].str  = command->name;
+	argv[0].len  = command->name_len;
+
+	for (i = 0; i < max; i++) {
+		SSDBArg *arg = &argv[i + 1];
+
+		switch (kinds[i]) {
+			case 'k':
+			case 'K':
+			case 's':
+			case 'S':
+				z = *args[i];
+				if (IS_STRING != Z_TYPE_P(z)) {
+					if (IS_ARRAY == Z_TYPE_P(z) || IS_OBJECT == Z_TYPE_P(z) || IS_RESOURCE == Z_TYPE_P(z)) {
+						php_error_docref(NULL TSRMLS_CC, E_WARNING, "expects parameter %d to be string, %s given", i + 1, zend_zval_type_name(z));
+						goto fail;
+					}
+					tmp[i] = *z;
+					zval_copy_ctor(&tmp[i]);
+					convert_to_string(&tmp[i]);
+					tmp_used[i] = 1;
+					z = &tmp[i];
+				}
+
+				if (0 == Z_STRLEN_P(z) && ('k' == kinds[i] || 's' == kinds[i])) {
+					goto fail;
+				}
+
+				arg->type = SSDB_ARG_STRING;
+				arg->str  = Z_STRVAL_P(z);
+				arg->len  = Z_STRLEN_P(z);
+				break;
+			case 'z':
+				z = *args[i];
+				if (IS_STRING != Z_TYPE_P(z)
+					&& IS_LONG != Z_TYPE_P(z)
+					&& IS_DOUBLE != Z_TYPE_P(z)) {
+					zend_throw_exception(ssdb_exception_ce, "error params type", 0 TSRMLS_CC);
+					goto fail;
+				}
+
+				if (IS_STRING != Z_TYPE_P(z)) {
+					tmp[i] = *z;
+					zval_copy_ctor(&tmp[i]);
+					convert_to_string(&tmp[i]);
+					tmp_used[i] = 1;
+					z = &tmp[i];
+				}
+
+				arg->type = SSDB_ARG_STRING;
+				arg->str  = Z_STRVAL_P(z);
+				arg->len  = Z_STRLEN_P(z);
+				break;
+			case 'v':
+				//序列化需要连接上的serialize_type,取到连接后再处理
+				break;
+			default:
+				if (i >= argc) {
+					lval = command->def;
+				} else if (ssdb_command_arg_long(*args[i], i + 1, &lval TSRMLS_CC) == FAILURE) {
+					goto fail;
+				}
+
+				if (('p' == kinds[i] && lval <= 0)
+						|| ('b' == kinds[i] && lval != 0 && lval != 1)) {
+					goto fail;
+				}
+
+				arg->type = SSDB_ARG_LONG;
+				arg->lval = lval;
+				break;
+		}
+	}
+
+	if ((sock_id = ssdb_sock_get(getThis(), &ssdb_sock TSRMLS_CC, 0)) < 0) {
+		goto fail;
+	}
+
+	for (i = 0; i < max; i++) {
+		SSDBArg *arg = &argv[i + 1];
+
+		if ('k' == kinds[i] || ('K' == kinds[i] && arg->len > 0)) {
+			key = (char *) arg->str;
+			key_len = arg->len;
+			ssdb_key_prefix(ssdb_sock, &key, &key_len);
+			arg->str = key;
+			arg->len = key_len;
+		} else if ('v' == kinds[i]) {
+			val_free[i] = ssdb_serialize(ssdb_sock, *args[i], &val[i], &val_len);
+			arg->type = SSDB_ARG_STRING;
+			arg->str  = val[i];
+			arg->len  = val_len;
+		}
+	}
+
+	//batch中的get/hget/zget先返回promise,之后合并成multi_*发送
+	if (ssdb_sock->batch && ssdb_batch_add(ssdb_sock, sock_id, argv, max + 1, return_value TSRMLS_CC) == SUCCESS) {
+		handled = 1;
+		goto fail;
+	}
+
+	//写命令使该key的读缓存失效,读缓存命中时不发出命令
+	if (command->write) {
+		if (max > 0 && 'k' == kinds[0]) {
+			ssdb_read_cache_forget(ssdb_sock, argv[1].str, argv[1].len);
+		}
+	} else if (command->read_only && !ssdb_sock->pipeline && ssdb_command_cacheable(command)
+			&& !ssdb_defer_pending(ssdb_sock, argv[1].str, argv[1].len)) {
+		shm = ssdb_command_shm_cacheable(ssdb_sock, command);
+		if (ssdb_sock->read_cache || shm) {
+			ssdb_sock->cache_hit = ssdb_read_cache_get(ssdb_sock, argv, max + 1, shm);
+			cached = ssdb_sock->cache_hit != NULL;
+			cacheable = !cached;
+		}
+	}
+
+	//只有返回状态或计数的写命令可以不等待响应
+	if (command->write && (SSDB_REPLY_BOOL == command->reply || SSDB_REPLY_LONG == command->reply)) {
+		ssdb_noreply_begin(ssdb_sock);
+	}
+
+	if (ssdb_sock->cmd_defer && ssdb_command_summable(command)) {
+		ssdb_defer_sum(ssdb_sock, argv, max + 1);
+		ssdb_sock->cmd_defer = 0;
+		RETVAL_TRUE;
+		handled = 1;
+	} else if (!cached) {
+		cmd_len = ssdb_cmd_format_argv(ssdb_sock, &cmd, argv, max + 1);
+	}
+
+fail:
+	for (i = 0; i < max; i++) {
+		if (tmp_used[i]) zval_dtor(&tmp[i]);
+		if (val_free[i]) STR_FREE(val[i]);
+	}
+	if (handled) return;
+
+	if (!cached) {
+		if (0 == cmd_len) RETURN_NULL();
+
+		if (command->read_only) {
+			SSDB_SOCKET_WRITE_READ_COMMAND(ssdb_sock, cmd, cmd_len);
+		} else {
+			SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len);
+		}
+
+		//命令发出之后才记录,避免写入之前读取的其他响应
+		ssdb_sock->cache_store = cacheable;
+	}
+
+	switch (command->reply) {
+		case SSDB_REPLY_BOOL:
+			ssdb_bool_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
+			break;
+		case SSDB_REPLY_STRING:
+			ssdb_string_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
+			break;
+		case SSDB_REPLY_LONG:
+			ssdb_long_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
+			break;
+		case SSDB_REPLY_DOUBLE:
+			ssdb_double_number_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock);
+			break;
+		case SSDB_REPLY_LIST:
+			ssdb_list_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, command->filter_prefix, command->unserialize);
+			break;
+		case SSDB_REPLY_MAP:
+			ssdb_map_response(INTERNAL_FUNCTION_PARAM_PASSTHRU, ssdb_sock, command->filter_prefix, command->unserialize, command->convert_type);
+			break;
+	}
+}
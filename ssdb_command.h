@@ -0,0 +1,136 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2014 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: xingqiba ixqbar@gmail.com                                                             |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef EXT_SSDB_SSDB_COMMAND_H_
+#define EXT_SSDB_SSDB_COMMAND_H_
+
+#include "ssdb_library.h"
+
+#define SSDB_COMMAND_MAX_ARGS 8
+
+/*
+ * 参数描述,每个字符对应一个PHP参数,'|'之后为可选参数(只支持最后一个long参数可选,默认值为def)
+ * k: key,不能为空,加前缀
+ * K: key,可以为空,非空时加前缀
+ * s: 字符串,不能为空
+ * S: 字符串,可以为空
+ * v: 值,按serialize_type序列化
+ * z: 分值,只接受string/long/double
+ * l: long
+ * p: long,必须大于0
+ * b: long,只能是0或1
+ */
+typedef struct {
+	const char *name;
+	int name_len;
+	const char *args;
+	long def;
+	int read_only;
+	int write;
+	ssdb_reply_type reply;
+	int filter_prefix;
+	int unserialize;
+	int convert_type;
+} SSDBCommand;
+
+//read_only: 可以发往只读连接; write: 写命令,可以noreply/defer并使读缓存失效
+//X(name, args, def, read_only, write, reply, filter_prefix, unserialize, convert_type)
+#define SSDB_COMMAND_LIST(X) \
+	X(ping,             "",      0, 0, 0, SSDB_REPLY_BOOL,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(version,          "",      0, 0, 0, SSDB_REPLY_STRING,  SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) /* ssdb-server >= 1.9.0 */ \
+	X(dbsize,           "",      0, 0, 0, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(getset,           "kv",    0, 0, 1, SSDB_REPLY_STRING,  SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(setbit,           "klb",   0, 0, 1, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(setnx,            "kv",    0, 0, 1, SSDB_REPLY_BOOL,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(del,              "k",     0, 0, 1, SSDB_REPLY_BOOL,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(exists,           "k",     0, 1, 0, SSDB_REPLY_BOOL,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(get,              "k",     0, 1, 0, SSDB_REPLY_STRING,  SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(strlen,           "k",     0, 1, 0, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(getbit,           "k|l",   0, 1, 0, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(ttl,              "k",     0, 1, 0, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(incr,             "k|l",   1, 0, 1, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(expire,           "kl",    0, 0, 1, SSDB_REPLY_BOOL,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(keys,             "KKp",   0, 1, 0, SSDB_REPLY_LIST,    SSDB_FILTER_KEY_PREFIX,       SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(scan,             "KKp",   0, 1, 0, SSDB_REPLY_MAP,     SSDB_FILTER_KEY_PREFIX,       SSDB_UNSERIALIZE,       SSDB_CONVERT_TO_STRING) \
+	X(rscan,            "KKp",   0, 1, 0, SSDB_REPLY_MAP,     SSDB_FILTER_KEY_PREFIX,       SSDB_UNSERIALIZE,       SSDB_CONVERT_TO_STRING) \
+	X(hset,             "ksv",   0, 0, 1, SSDB_REPLY_BOOL,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(hget,             "ks",    0, 1, 0, SSDB_REPLY_STRING,  SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(hdel,             "ks",    0, 0, 1, SSDB_REPLY_BOOL,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(hincr,            "ks|l",  1, 0, 1, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(hexists,          "ks",    0, 1, 0, SSDB_REPLY_BOOL,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(hsize,            "k",     0, 1, 0, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(hlist,            "KKp",   0, 1, 0, SSDB_REPLY_LIST,    SSDB_FILTER_KEY_PREFIX,       SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(hrlist,           "KKp",   0, 1, 0, SSDB_REPLY_LIST,    SSDB_FILTER_KEY_PREFIX,       SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(hkeys,            "kSSp",  0, 1, 0, SSDB_REPLY_LIST,    SSDB_FILTER_KEY_PREFIX,       SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(hgetall,          "k",     0, 1, 0, SSDB_REPLY_MAP,     SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE,       SSDB_CONVERT_TO_STRING) \
+	X(hscan,            "kSSp",  0, 1, 0, SSDB_REPLY_MAP,     SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE,       SSDB_CONVERT_TO_STRING) \
+	X(hrscan,           "kSSp",  0, 1, 0, SSDB_REPLY_MAP,     SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE,       SSDB_CONVERT_TO_STRING) \
+	X(hclear,           "k",     0, 0, 1, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(zset,             "ksl",   0, 0, 1, SSDB_REPLY_BOOL,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(zget,             "ks",    0, 1, 0, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(zdel,             "ks",    0, 0, 1, SSDB_REPLY_BOOL,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(zincr,            "ksl",   0, 0, 1, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(zsize,            "k",     0, 1, 0, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(zlist,            "KKp",   0, 1, 0, SSDB_REPLY_LIST,    SSDB_FILTER_KEY_PREFIX,       SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(zrlist,           "KKp",   0, 1, 0, SSDB_REPLY_LIST,    SSDB_FILTER_KEY_PREFIX,       SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(zexists,          "ks",    0, 1, 0, SSDB_REPLY_BOOL,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(zkeys,            "kSzzp", 0, 1, 0, SSDB_REPLY_LIST,    SSDB_FILTER_KEY_PREFIX,       SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(zscan,            "kSzzl", 0, 1, 0, SSDB_REPLY_MAP,     SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_LONG) \
+	X(zrscan,           "kSzzl", 0, 1, 0, SSDB_REPLY_MAP,     SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_LONG) \
+	X(zrank,            "ks",    0, 1, 0, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(zrrank,           "ks",    0, 1, 0, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(zrange,           "klp",   0, 1, 0, SSDB_REPLY_MAP,     SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_LONG) \
+	X(zrrange,          "klp",   0, 1, 0, SSDB_REPLY_MAP,     SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_LONG) \
+	X(zclear,           "k",     0, 0, 1, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(zcount,           "kll",   0, 1, 0, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(zsum,             "kll",   0, 1, 0, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(zavg,             "kll",   0, 1, 0, SSDB_REPLY_DOUBLE,  SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(zremrangebyrank,  "kll",   0, 0, 1, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(zremrangebyscore, "kll",   0, 0, 1, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(zpop_front,       "k|p",   1, 0, 1, SSDB_REPLY_MAP,     SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_LONG) \
+	X(zpop_back,        "k|p",   1, 0, 1, SSDB_REPLY_MAP,     SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_LONG) \
+	X(qsize,            "k",     0, 1, 0, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(qlist,            "KKp",   0, 1, 0, SSDB_REPLY_LIST,    SSDB_FILTER_KEY_PREFIX,       SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(qrlist,           "KKp",   0, 1, 0, SSDB_REPLY_LIST,    SSDB_FILTER_KEY_PREFIX,       SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(qclear,           "k",     0, 0, 1, SSDB_REPLY_BOOL,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(qfront,           "k",     0, 1, 0, SSDB_REPLY_STRING,  SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(qback,            "k",     0, 1, 0, SSDB_REPLY_STRING,  SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(qget,             "k|l",   0, 1, 0, SSDB_REPLY_STRING,  SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(qset,             "klv",   0, 0, 1, SSDB_REPLY_BOOL,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(qrange,           "klp",   0, 1, 0, SSDB_REPLY_LIST,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE,       SSDB_CONVERT_TO_STRING) \
+	X(qslice,           "kll",   0, 1, 0, SSDB_REPLY_LIST,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE,       SSDB_CONVERT_TO_STRING) \
+	X(qtrim_front,      "k|p",   1, 0, 1, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING) \
+	X(qtrim_back,       "k|p",   1, 0, 1, SSDB_REPLY_LONG,    SSDB_FILTER_KEY_PREFIX_NONE,  SSDB_UNSERIALIZE_NONE,  SSDB_CONVERT_TO_STRING)
+
+#define SSDB_COMMAND_ENUM(name, args, def, read_only, write, reply, filter_prefix, unserialize, convert_type) SSDB_CMD_##name,
+typedef enum {
+	SSDB_COMMAND_LIST(SSDB_COMMAND_ENUM)
+	SSDB_CMD_MAX
+} ssdb_command_id;
+#undef SSDB_COMMAND_ENUM
+
+extern const SSDBCommand ssdb_commands[SSDB_CMD_MAX];
+
+void ssdb_command_dispatch(INTERNAL_FUNCTION_PARAMETERS, const SSDBCommand *command);
+
+//命令表中的命令统一由ssdb_command_dispatch处理
+#define SSDB_COMMAND_METHOD(name, args, def, read_only, write, reply, filter_prefix, unserialize, convert_type) PHP_METHOD(SSDB, name) { \
+	ssdb_command_dispatch(INTERNAL_FUNCTION_PARAM_PASSTHRU, &ssdb_commands[SSDB_CMD_##name]); \
+}
+
+#endif /* EXT_SSDB_SSDB_COMMAND_H_ */
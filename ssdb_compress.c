@@ -0,0 +1,439 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2014 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: xingqiba ixqbar@gmail.com                                                             |
+  +----------------------------------------------------------------------+
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "php.h"
+#include "ext/standard/php_string.h"
+
+#include <stdio.h>
+
+#ifdef HAVE_SSDB_LZ4
+#include <lz4.h>
+#endif
+#ifdef HAVE_SSDB_ZSTD
+#include <zstd.h>
+#endif
+
+#include "ssdb_library.h"
+#include "ssdb_compress.h"
+
+//zstd压缩级别,与zstd命令行默认值相同
+#define SSDB_ZSTD_LEVEL 3
+
+#ifdef HAVE_SSDB_ZSTD
+//MINIT时加载的zstd字典,第一个用于压缩,全部可用于解压
+typedef struct {
+	uint32_t id;
+	ZSTD_CDict *cdict;
+	ZSTD_DDict *ddict;
+} SSDBCompressDict;
+
+static SSDBCompressDict ssdb_compress_dicts[SSDB_COMPRESS_DICT_MAX];
+static int ssdb_compress_dict_num = 0;
+
+#ifndef ZTS
+//非线程安全模式下复用压缩/解压上下文,避免小value每次分配
+static ZSTD_CCtx *ssdb_compress_cctx = NULL;
+static ZSTD_DCtx *ssdb_compress_dctx = NULL;
+#endif
+
+static ZSTD_CCtx *ssdb_compress_cctx_get(void) {
+#ifdef ZTS
+	return ZSTD_createCCtx();
+#else
+	if (!ssdb_compress_cctx) {
+		ssdb_compress_cctx = ZSTD_createCCtx();
+	}
+	return ssdb_compress_cctx;
+#endif
+}
+
+static void ssdb_compress_cctx_release(ZSTD_CCtx *cctx) {
+#ifdef ZTS
+	ZSTD_freeCCtx(cctx);
+#endif
+}
+
+static ZSTD_DCtx *ssdb_compress_dctx_get(void) {
+#ifdef ZTS
+	return ZSTD_createDCtx();
+#else
+	if (!ssdb_compress_dctx) {
+		ssdb_compress_dctx = ZSTD_createDCtx();
+	}
+	return ssdb_compress_dctx;
+#endif
+}
+
+static void ssdb_compress_dctx_release(ZSTD_DCtx *dctx) {
+#ifdef ZTS
+	ZSTD_freeDCtx(dctx);
+#endif
+}
+
+//未训练的原始内容字典没有ID,按内容计算FNV-1a
+static uint32_t ssdb_compress_dict_id(const char *buf, size_t len) {
+	uint32_t id = ZSTD_getDictID_fromDict(buf, len);
+	size_t i;
+
+	if (id) {
+		return id;
+	}
+
+	id = 2166136261U;
+	for (i = 0; i < len; i++) {
+		id = (id ^ (unsigned char) buf[i]) * 16777619U;
+	}
+
+	return id ? id : 1;
+}
+
+static int ssdb_compress_dict_load(const char *path, int compress) {
+	SSDBCompressDict *dict;
+	FILE *fp;
+	char *buf;
+	long len;
+	int i;
+
+	if (ssdb_compress_dict_num >= SSDB_COMPRESS_DICT_MAX) {
+		zend_error(E_WARNING, "ssdb: at most %d compression dictionaries are supported", SSDB_COMPRESS_DICT_MAX);
+		return -1;
+	}
+
+	fp = fopen(path, "rb");
+	if (!fp) {
+		zend_error(E_WARNING, "ssdb: unable to open compression dictionary %s", path);
+		return -1;
+	}
+
+	if (fseek(fp, 0, SEEK_END) != 0 || (len = ftell(fp)) <= 0 || fseek(fp, 0, SEEK_SET) != 0) {
+		fclose(fp);
+		zend_error(E_WARNING, "ssdb: empty compression dictionary %s", path);
+		return -1;
+	}
+
+	buf = malloc(len);
+	if (!buf || fread(buf, 1, len, fp) != (size_t) len) {
+		free(buf);
+		fclose(fp);
+		zend_error(E_WARNING, "ssdb: unable to read compression dictionary %s", path);
+		return -1;
+	}
+	fclose(fp);
+
+	dict = &ssdb_compress_dicts[ssdb_compress_dict_num];
+	dict->id    = ssdb_compress_dict_id(buf, len);
+	dict->cdict = compress ? ZSTD_createCDict(buf, len, SSDB_ZSTD_LEVEL) : NULL;
+	dict->ddict = ZSTD_createDDict(buf, len);
+	free(buf);
+
+	if ((compress && !dict->cdict) || !dict->ddict) {
+		ZSTD_freeCDict(dict->cdict);
+		ZSTD_freeDDict(dict->ddict);
+		zend_error(E_WARNING, "ssdb: invalid compression dictionary %s", path);
+		return -1;
+	}
+
+	for (i = 0; i < ssdb_compress_dict_num; i++) {
+		if (ssdb_compress_dicts[i].id == dict->id) {
+			ZSTD_freeCDict(dict->cdict);
+			ZSTD_freeDDict(dict->ddict);
+			zend_error(E_WARNING, "ssdb: duplicate compression dictionary id %u in %s", dict->id, path);
+			return -1;
+		}
+	}
+
+	ssdb_compress_dict_num++;
+
+	return 0;
+}
+
+static SSDBCompressDict *ssdb_compress_dict_find(uint32_t id) {
+	int i;
+
+	for (i = 0; i < ssdb_compress_dict_num; i++) {
+		if (ssdb_compress_dicts[i].id == id) {
+			return &ssdb_compress_dicts[i];
+		}
+	}
+
+	return NULL;
+}
+#endif
+
+//paths以逗号分隔,第一个字典用于压缩,其余只用于解压轮换前写入的value
+int ssdb_compress_dict_init(const char *paths) {
+#ifdef HAVE_SSDB_ZSTD
+	char *copy, *path, *last = NULL;
+	int ret = 0;
+
+	copy = strdup(paths);
+	for (path = php_strtok_r(copy, ",", &last); path; path = php_strtok_r(NULL, ",", &last)) {
+		while (*path == ' ') {
+			path++;
+		}
+		if (*path == '\0') {
+			continue;
+		}
+		//第一个字典加载失败时不再加载其他字典,避免用旧字典压缩
+		if (ssdb_compress_dict_load(path, ssdb_compress_dict_num == 0) < 0 && ssdb_compress_dict_num == 0) {
+			ret = -1;
+			break;
+		}
+	}
+	free(copy);
+
+	return ret;
+#else
+	zend_error(E_WARNING, "ssdb: ssdb.compression_dict requires --with-ssdb-zstd");
+	return -1;
+#endif
+}
+
+void ssdb_compress_dict_shutdown(void) {
+#ifdef HAVE_SSDB_ZSTD
+	int i;
+
+	for (i = 0; i < ssdb_compress_dict_num; i++) {
+		ZSTD_freeCDict(ssdb_compress_dicts[i].cdict);
+		ZSTD_freeDDict(ssdb_compress_dicts[i].ddict);
+	}
+	ssdb_compress_dict_num = 0;
+
+#ifndef ZTS
+	ZSTD_freeCCtx(ssdb_compress_cctx);
+	ZSTD_freeDCtx(ssdb_compress_dctx);
+	ssdb_compress_cctx = NULL;
+	ssdb_compress_dctx = NULL;
+#endif
+#endif
+}
+
+int ssdb_compression_supported(long codec) {
+	switch (codec) {
+		case SSDB_COMPRESSION_NONE:
+			return 1;
+#ifdef HAVE_SSDB_LZ4
+		case SSDB_COMPRESSION_LZ4:
+			return 1;
+#endif
+#ifdef HAVE_SSDB_ZSTD
+		case SSDB_COMPRESSION_ZSTD:
+			return 1;
+		case SSDB_COMPRESSION_ZSTD_DICT:
+			return ssdb_compress_dict_num > 0;
+#endif
+	}
+
+	return 0;
+}
+
+static int ssdb_compress_header_size(int codec) {
+	return codec == SSDB_COMPRESSION_ZSTD_DICT ? SSDB_COMPRESS_DICT_HEADER_SIZE : SSDB_COMPRESS_HEADER_SIZE;
+}
+
+static void ssdb_compress_put_uint32(char *buf, uint32_t v) {
+	buf[0] = (char) (v & 0xff);
+	buf[1] = (char) ((v >> 8) & 0xff);
+	buf[2] = (char) ((v >> 16) & 0xff);
+	buf[3] = (char) ((v >> 24) & 0xff);
+}
+
+static uint32_t ssdb_compress_get_uint32(const unsigned char *p) {
+	return p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+//首字节与压缩头冲突时返回1,ret由调用者efree
+int ssdb_compress_escape(const char *val, int val_len, char **ret, int *ret_len) {
+	char *buf;
+
+	if (val_len <= 0 || ((unsigned char) val[0] & 0xF0) != SSDB_COMPRESS_TAG) {
+		return 0;
+	}
+
+	buf = emalloc(SSDB_COMPRESS_HEADER_SIZE + val_len);
+	buf[0] = (char) (SSDB_COMPRESS_TAG | SSDB_COMPRESSION_NONE);
+	ssdb_compress_put_uint32(buf + 1, (uint32_t) val_len);
+	memcpy(buf + SSDB_COMPRESS_HEADER_SIZE, val, val_len);
+	*ret = buf;
+	*ret_len = SSDB_COMPRESS_HEADER_SIZE + val_len;
+
+	return 1;
+}
+
+//只有压缩后更小时才返回1,ret由调用者efree
+int ssdb_compress(int codec, const char *val, int val_len, char **ret, int *ret_len) {
+	int header = ssdb_compress_header_size(codec);
+	char *buf = NULL;
+	int len = 0;
+
+	switch (codec) {
+#ifdef HAVE_SSDB_LZ4
+		case SSDB_COMPRESSION_LZ4:
+			buf = emalloc(header + LZ4_compressBound(val_len));
+			len = LZ4_compress_default(val, buf + header, val_len, LZ4_compressBound(val_len));
+			break;
+#endif
+#ifdef HAVE_SSDB_ZSTD
+		case SSDB_COMPRESSION_ZSTD: {
+			size_t bound = ZSTD_compressBound(val_len);
+			size_t sz;
+
+			buf = emalloc(header + bound);
+			sz  = ZSTD_compress(buf + header, bound, val, val_len, SSDB_ZSTD_LEVEL);
+			len = ZSTD_isError(sz) ? 0 : (int) sz;
+			break;
+		}
+		case SSDB_COMPRESSION_ZSTD_DICT: {
+			size_t bound = ZSTD_compressBound(val_len);
+			ZSTD_CCtx *cctx;
+			size_t sz;
+
+			if (ssdb_compress_dict_num == 0 || !(cctx = ssdb_compress_cctx_get())) {
+				return 0;
+			}
+			buf = emalloc(header + bound);
+			sz  = ZSTD_compress_usingCDict(cctx, buf + header, bound, val, val_len, ssdb_compress_dicts[0].cdict);
+			len = ZSTD_isError(sz) ? 0 : (int) sz;
+			ssdb_compress_cctx_release(cctx);
+			ssdb_compress_put_uint32(buf + SSDB_COMPRESS_HEADER_SIZE, ssdb_compress_dicts[0].id);
+			break;
+		}
+#endif
+		default:
+			return 0;
+	}
+
+	if (len <= 0 || header + len >= val_len) {
+		efree(buf);
+		return 0;
+	}
+
+	buf[0] = (char) (SSDB_COMPRESS_TAG | codec);
+	ssdb_compress_put_uint32(buf + 1, (uint32_t) val_len);
+	*ret = buf;
+	*ret_len = header + len;
+
+	return 1;
+}
+
+//不是压缩格式或解压失败时返回0,按原值处理
+int ssdb_decompress(const char *val, int val_len, char **ret, int *ret_len) {
+	const unsigned char *p = (const unsigned char *) val;
+	int codec, header;
+	uint32_t len;
+	char *buf;
+
+	if (val_len <= 0 || (p[0] & 0xF0) != SSDB_COMPRESS_TAG) {
+		return 0;
+	}
+
+	if (val_len <= SSDB_COMPRESS_HEADER_SIZE) {
+		return 0;
+	}
+
+	//转义过的未压缩值,长度不符时(如开启压缩之前写入的0xC0开头的值)按原值处理
+	if (p[0] == (SSDB_COMPRESS_TAG | SSDB_COMPRESSION_NONE)) {
+		len = ssdb_compress_get_uint32(p + 1);
+		if (len != (uint32_t) (val_len - SSDB_COMPRESS_HEADER_SIZE)) {
+			return 0;
+		}
+		*ret = estrndup(val + SSDB_COMPRESS_HEADER_SIZE, len);
+		*ret_len = (int) len;
+		return 1;
+	}
+
+	codec  = p[0] & 0x0F;
+	header = ssdb_compress_header_size(codec);
+	if (codec == SSDB_COMPRESSION_NONE
+			|| !ssdb_compression_supported(codec)
+			|| val_len <= header) {
+		return 0;
+	}
+
+	len = ssdb_compress_get_uint32(p + 1);
+	if (len > INT_MAX - 1) {
+		return 0;
+	}
+
+	switch (codec) {
+#ifdef HAVE_SSDB_LZ4
+		case SSDB_COMPRESSION_LZ4:
+			//LZ4最大压缩比约255:1,超出说明不是压缩数据
+			if ((uint64_t) len > (uint64_t) (val_len - header) * 255 + 16) {
+				return 0;
+			}
+			buf = emalloc(len + 1);
+			if (LZ4_decompress_safe(val + header, buf, val_len - header, len) != (int) len) {
+				efree(buf);
+				return 0;
+			}
+			break;
+#endif
+#ifdef HAVE_SSDB_ZSTD
+		case SSDB_COMPRESSION_ZSTD: {
+			size_t sz;
+
+			if (ZSTD_getFrameContentSize(val + header, val_len - header) != len) {
+				return 0;
+			}
+			buf = emalloc(len + 1);
+			sz  = ZSTD_decompress(buf, len, val + header, val_len - header);
+			if (ZSTD_isError(sz) || sz != len) {
+				efree(buf);
+				return 0;
+			}
+			break;
+		}
+		case SSDB_COMPRESSION_ZSTD_DICT: {
+			SSDBCompressDict *dict = ssdb_compress_dict_find(ssdb_compress_get_uint32(p + SSDB_COMPRESS_HEADER_SIZE));
+			unsigned frame_id;
+			ZSTD_DCtx *dctx;
+			size_t sz;
+
+			//字典已从ssdb.compression_dict中移除时无法解压
+			if (!dict || ZSTD_getFrameContentSize(val + header, val_len - header) != len) {
+				return 0;
+			}
+			frame_id = ZSTD_getDictID_fromFrame(val + header, val_len - header);
+			if ((frame_id && frame_id != dict->id) || !(dctx = ssdb_compress_dctx_get())) {
+				return 0;
+			}
+			buf = emalloc(len + 1);
+			sz  = ZSTD_decompress_usingDDict(dctx, buf, len, val + header, val_len - header, dict->ddict);
+			ssdb_compress_dctx_release(dctx);
+			if (ZSTD_isError(sz) || sz != len) {
+				efree(buf);
+				return 0;
+			}
+			break;
+		}
+#endif
+		default:
+			return 0;
+	}
+
+	buf[len] = '\0';
+	*ret = buf;
+	*ret_len = (int) len;
+
+	return 1;
+}
@@ -0,0 +1,38 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2014 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: xingqiba ixqbar@gmail.com                                                             |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef EXT_SSDB_SSDB_COMPRESS_H_
+#define EXT_SSDB_SSDB_COMPRESS_H_
+
+//压缩后的值以1字节头标明算法,之后是4字节小端的原始长度
+//首字节恰好是0xC?的未压缩值前面加算法为NONE的5字节头转义,头中长度与剩余长度一致时才去掉
+#define SSDB_COMPRESS_TAG         0xC0
+#define SSDB_COMPRESS_HEADER_SIZE 5
+//字典压缩在原始长度之后再加4字节小端的字典ID,读取时按ID选择字典
+#define SSDB_COMPRESS_DICT_HEADER_SIZE 9
+//ssdb.compression_dict最多可配置的字典数
+#define SSDB_COMPRESS_DICT_MAX    8
+
+int ssdb_compress_dict_init(const char *paths);
+void ssdb_compress_dict_shutdown(void);
+int ssdb_compression_supported(long codec);
+int ssdb_compress_escape(const char *val, int val_len, char **ret, int *ret_len);
+int ssdb_compress(int codec, const char *val, int val_len, char **ret, int *ret_len);
+int ssdb_decompress(const char *val, int val_len, char **ret, int *ret_len);
+
+#endif /* EXT_SSDB_SSDB_COMPRESS_H_ */
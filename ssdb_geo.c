@@ -92,7 +92,9 @@ static int ssdb_geo_point_sort_asc(const void *a, const void *b) {
     if (gpa->dist > gpb->dist) {
         return 1;
     } else if (gpa->dist == gpb->dist) {
-    	return strcmp(gpa->member, gpb->member);
+    	int len = gpa->member_key_len < gpb->member_key_len ? gpa->member_key_len : gpb->member_key_len;
+    	int cmp = memcmp(gpa->member, gpb->member, len);
+    	return cmp != 0 ? cmp : gpa->member_key_len - gpb->member_key_len;
 	} else {
         return -1;
 	}
@@ -105,35 +107,25 @@ static SSDBGeoList *ssdb_geo_member_box(SSDBGeoObj *ssdb_geo_obj, GeoHashBits ha
     hash.bits++;
     max = geohashAlign52Bits(hash);
 
-    char *score_start = NULL;
-    int score_start_len = spprintf(&score_start, 0, "%lld", min);
+    char *cmd = NULL, *key = ssdb_geo_obj->key;
+	int cmd_len = 0, key_len = ssdb_geo_obj->key_len;
 
-    char *score_end = NULL;
-    int score_end_len = spprintf(&score_end, 0, "%lld", max);
-
-    char *cmd = NULL;
-	int cmd_len = 0, key_free = 0;
-
-	key_free = ssdb_key_prefix(ssdb_geo_obj->ssdb_sock, &ssdb_geo_obj->key, &ssdb_geo_obj->key_len);
-	cmd_len = ssdb_cmd_format_by_str(ssdb_geo_obj->ssdb_sock,
-			&cmd, ZEND_STRL("zscan"),
-			ssdb_geo_obj->key,
-			ssdb_geo_obj->key_len,
+	//ssdb_geo_obj->key在各个box间共用,只对局部变量加前缀
+	ssdb_key_prefix(ssdb_geo_obj->ssdb_sock, &key, &key_len);
+	cmd_len = ssdb_cmd_format(ssdb_geo_obj->ssdb_sock,
+			&cmd, "sssLLl",
+			ZEND_STRL("zscan"),
+			key,
+			key_len,
 			"",
 			0,
-			score_start,
-			score_start_len,
-			score_end,
-			score_end_len,
-			ssdb_geo_obj->limit_str,
-			ssdb_geo_obj->limit_str_len,
-			NULL);
-
-	efree(score_start);
-	efree(score_end);
-	if (key_free) efree(ssdb_geo_obj->key);
+			(long long) min,
+			(long long) max,
+			ssdb_geo_obj->limit);
+
 	if (0 == cmd_len) return NULL;
 
+	ssdb_route_read(ssdb_geo_obj->ssdb_sock);
 	if (ssdb_sock_write(ssdb_geo_obj->ssdb_sock, cmd, cmd_len) < 0) {
 		efree(cmd);
 		return NULL;
@@ -157,28 +149,23 @@ static SSDBGeoList *ssdb_geo_member_box(SSDBGeoObj *ssdb_geo_obj, GeoHashBits ha
 	l->free = free;
 
 	double latlong[2] = {0};
-	int i = 1;
+	int i;
 	bool err = false;
 
-	SSDBResponseBlock *ssdb_response_block = ssdb_response->block;
-	while (ssdb_response_block != NULL) {
-		if (0 == i % 2) {
-			if (!decodeGeohash(atoll(ssdb_response_block->data), latlong)) {
-				err = true;
-				break;
-			}
+	for (i = 0; i < ssdb_response->num; i += 2) {
+		if (!decodeGeohash(atoll(SSDB_RESPONSE_BLOCK_DATA(ssdb_response, i + 1)), latlong)) {
+			err = true;
+			break;
+		}
 
-			SSDBGeoPoint *p   = malloc(sizeof (SSDBGeoPoint));
-			p->member_key_len = ssdb_response_block->prev->len;
-			p->member         = estrndup(ssdb_response_block->prev->data, ssdb_response_block->prev->len);
-			p->dist           = 0.0;
-			p->latitude       = latlong[0];
-			p->longitude      = latlong[1];
+		SSDBGeoPoint *p   = malloc(sizeof (SSDBGeoPoint));
+		p->member_key_len = SSDB_RESPONSE_BLOCK_LEN(ssdb_response, i);
+		p->member         = estrndup(SSDB_RESPONSE_BLOCK_DATA(ssdb_response, i), SSDB_RESPONSE_BLOCK_LEN(ssdb_response, i));
+		p->dist           = 0.0;
+		p->latitude       = latlong[0];
+		p->longitude      = latlong[1];
 
-			ssdb_geo_list_add_tail_node(l, p);
-		}
-		ssdb_response_block = ssdb_response_block->next;
-		i++;
+		ssdb_geo_list_add_tail_node(l, p);
 	}
 
 	if (err || 0 == l->num) {
@@ -270,14 +257,14 @@ static bool ssdb_geo_member(
 		int member_key_len,
 		double *latlong) {
 	char *cmd = NULL;
-	int cmd_len = 0, key_free = 0;
+	int cmd_len = 0;
 
-	key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
+	ssdb_key_prefix(ssdb_sock, &key, &key_len);
 	cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zget"), key, key_len, member_key, member_key_len, NULL);
 
-	if (key_free) efree(key);
 	if (0 == cmd_len) return false;
 
+	ssdb_route_read(ssdb_sock);
 	if (ssdb_sock_write(ssdb_sock, cmd, cmd_len) < 0) {
 		efree(cmd);
 		return false;
@@ -285,12 +272,12 @@ static bool ssdb_geo_member(
 	efree(cmd);
 
 	SSDBResponse *ssdb_response = ssdb_sock_read(ssdb_sock);
-	if (ssdb_response == NULL || ssdb_response->status != SSDB_IS_OK) {
+	if (ssdb_response == NULL || ssdb_response->status != SSDB_IS_OK || ssdb_response->num == 0) {
 		ssdb_response_free(ssdb_response);
 		return false;
 	}
 
-	if (!decodeGeohash(atoll(ssdb_response->block->data), latlong)) {
+	if (!decodeGeohash(atoll(SSDB_RESPONSE_BLOCK_DATA(ssdb_response, 0)), latlong)) {
 		ssdb_response_free(ssdb_response);
 		return false;
 	}
@@ -314,14 +301,11 @@ bool ssdb_geo_set(
 		return false;
 	}
 
-	char *member_score_str = NULL, *cmd = NULL;
+	char *cmd = NULL;
 	GeoHashFix52Bits bits = geohashAlign52Bits(hash);
-	int member_score_str_len = spprintf(&member_score_str, 0, "%lld", bits);
-	int key_free = ssdb_key_prefix(ssdb_sock, &key, &key_len);
-	int cmd_len = ssdb_cmd_format_by_str(ssdb_sock, &cmd, ZEND_STRL("zset"), key, key_len, member_key, member_key_len, member_score_str, member_score_str_len, NULL);
+	ssdb_key_prefix(ssdb_sock, &key, &key_len);
+	int cmd_len = ssdb_cmd_format(ssdb_sock, &cmd, "sssL", ZEND_STRL("zset"), key, key_len, member_key, member_key_len, (long long) bits);
 
-	efree(member_score_str);
-	if (key_free) efree(key);
 	if (0 == cmd_len) return false;
 
 	if (ssdb_sock_write(ssdb_sock, cmd, cmd_len) < 0) {
@@ -382,13 +366,11 @@ bool ssdb_geo_neighbours(
 	ssdb_geo_obj->key_len        = key_len;
 	ssdb_geo_obj->member_key     = member_key;
 	ssdb_geo_obj->member_key_len = member_key_len;
-	ssdb_geo_obj->limit_str      = NULL;
-	ssdb_geo_obj->limit_str_len  = spprintf(&ssdb_geo_obj->limit_str, 0, "%ld", zscan_limit);
+	ssdb_geo_obj->limit          = zscan_limit;
 
 	GeoHashRadius georadius = geohashGetAreasByRadiusWGS84(latlong[0], latlong[1], radius_meters);
 	SSDBGeoList *l = ssdb_geo_members(ssdb_geo_obj, georadius, latlong[0], latlong[1], radius_meters);
 
-	efree(ssdb_geo_obj->limit_str);
 	efree(ssdb_geo_obj);
 	if (l == NULL) {
 		return false;
@@ -404,6 +386,7 @@ bool ssdb_geo_neighbours(
 		p = (SSDBGeoPoint *)n->data;
 
 		p_l[i].member    = p->member;
+		p_l[i].member_key_len = p->member_key_len;
 		p_l[i].latitude  = p->latitude;
 		p_l[i].longitude = p->longitude;
 		p_l[i].dist      = p->dist;
@@ -415,7 +398,7 @@ bool ssdb_geo_neighbours(
 	qsort(p_l, l->num, sizeof(SSDBGeoPoint), ssdb_geo_point_sort_asc);
 
 	zval *temp;
-	array_init(return_value);
+	array_init_size(return_value, return_limit < l->num ? return_limit : l->num);
 	for (i = 0; i < l->num; i++) {
 		if (i < return_limit) {
 			MAKE_STD_ZVAL(temp);
@@ -423,7 +406,7 @@ bool ssdb_geo_neighbours(
 			add_assoc_double_ex(temp, ZEND_STRS("latitude"),  p_l[i].latitude);
 			add_assoc_double_ex(temp, ZEND_STRS("longitude"), p_l[i].longitude);
 			add_assoc_double_ex(temp, ZEND_STRS("distance"),  p_l[i].dist);
-			add_assoc_zval(return_value, p_l[i].member, temp);
+			add_assoc_zval_ex(return_value, p_l[i].member, p_l[i].member_key_len + 1, temp);
 		}
 		efree(p_l[i].member);
 	}
@@ -27,8 +27,22 @@
 #include <netinet/tcp.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#ifndef PHP_WIN32
+#include <sys/uio.h>
+#endif
+
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#define SSDB_HAVE_SSE2 1
+#endif
 
 #include "ssdb_library.h"
+#include "ssdb_result.h"
+#include "ssdb_pool.h"
+#include "ssdb_batch.h"
+#include "ssdb_shm.h"
+#include "ssdb_compress.h"
+#include "ssdb_msgpack.h"
 
 SSDBSock* ssdb_create_sock(
 		char *host,
@@ -49,6 +63,49 @@ SSDBSock* ssdb_create_sock(
 	ssdb_sock->persistent = persistent;
 	ssdb_sock->lazy_connect = lazy_connect;
 	ssdb_sock->serializer = SSDB_SERIALIZER_NONE;
+	ssdb_sock->compression = SSDB_COMPRESSION_NONE;
+	ssdb_sock->compression_threshold = SSDB_COMPRESSION_THRESHOLD;
+	ssdb_sock->rbuf = NULL;
+	ssdb_sock->rbuf_size = 0;
+	ssdb_sock->rbuf_pos = 0;
+	ssdb_sock->rbuf_len = 0;
+	ssdb_sock->pipeline = 0;
+	ssdb_sock->reply_head = NULL;
+	ssdb_sock->reply_tail = NULL;
+	ssdb_sock->reply_num = 0;
+	ssdb_sock->scan_prefetch = 0;
+	ssdb_sock->prefetch_owner = NULL;
+	ssdb_sock->prefetch_pending = 0;
+	ssdb_sock->prefetch_parked = NULL;
+	ssdb_sock->pending_discard = 0;
+	ssdb_sock->noreply = 0;
+	ssdb_sock->noreply_next = 0;
+	ssdb_sock->noreply_once = 0;
+	ssdb_sock->cmd_noreply = 0;
+	ssdb_sock->defer_next = 0;
+	ssdb_sock->defer_once = 0;
+	ssdb_sock->cmd_defer = 0;
+	ssdb_sock->defer_head = NULL;
+	ssdb_sock->defer_tail = NULL;
+	ssdb_sock->defer_num = 0;
+	ssdb_sock->defer_index = NULL;
+	ssdb_sock->defer_keys = NULL;
+	ssdb_sock->batch = NULL;
+	ssdb_sock->read_cache = 0;
+	ssdb_sock->read_cache_keys = NULL;
+	ssdb_sock->cache_hit = NULL;
+	ssdb_sock->cache_key = NULL;
+	ssdb_sock->cache_store = 0;
+	ssdb_sock->cache_shm = 0;
+	ssdb_sock->shm_cache_ttl = 0;
+	ssdb_sock->pool_key = NULL;
+	ssdb_sock->pool_id = NULL;
+	ssdb_sock->replicas = NULL;
+	ssdb_sock->replica_num = 0;
+	ssdb_sock->read_policy = SSDB_READ_MASTER;
+	ssdb_sock->replica_next = 0;
+	ssdb_sock->route_index = -1;
+	ssdb_sock->master_stream = NULL;
 
 	if (persistent_id) {
 		size_t persistent_id_len = strlen(persistent_id);
@@ -63,6 +120,7 @@ SSDBSock* ssdb_create_sock(
 
     ssdb_sock->port = port;
     ssdb_sock->timeout = timeout;
+    ssdb_sock->shm_server_len = spprintf(&ssdb_sock->shm_server, 0, "%s:%ld", ssdb_sock->host, port);
     ssdb_sock->read_timeout = timeout;
 
     ssdb_sock->err = NULL;
@@ -72,6 +130,8 @@ SSDBSock* ssdb_create_sock(
 }
 
 void ssdb_free_socket(SSDBSock *ssdb_sock) {
+	TSRMLS_FETCH();
+
     if (ssdb_sock->prefix) {
 		efree(ssdb_sock->prefix);
 	}
@@ -84,6 +144,20 @@ void ssdb_free_socket(SSDBSock *ssdb_sock) {
 	if (ssdb_sock->persistent_id) {
 		efree(ssdb_sock->persistent_id);
 	}
+	if (ssdb_sock->rbuf) {
+		efree(ssdb_sock->rbuf);
+	}
+	ssdb_pipeline_discard(ssdb_sock);
+	ssdb_prefetch_reset(ssdb_sock);
+	ssdb_defer_reset(ssdb_sock);
+	ssdb_batch_discard(ssdb_sock TSRMLS_CC);
+	ssdb_read_cache_reset(ssdb_sock);
+	ssdb_replicas_close(ssdb_sock);
+	if (ssdb_sock->pool_key) {
+		efree(ssdb_sock->pool_key);
+	}
+	ssdb_arena_free(ssdb_sock);
+	efree(ssdb_sock->shm_server);
     efree(ssdb_sock->host);
     efree(ssdb_sock);
 }
@@ -118,12 +192,36 @@ int ssdb_open_socket(SSDBSock *ssdb_sock, int force_connect) {
     return result;
 }
 
+static SSDBResponse *ssdb_sock_read_response(SSDBSock *ssdb_sock);
+
+//新建连接的通用设置
+static void ssdb_stream_setup(SSDBSock *ssdb_sock, php_stream *stream) {
+    struct timeval read_tv;
+	php_netstream_data_t *sock;
+	int tcp_flag = 1;
+
+    read_tv.tv_sec  = (time_t)ssdb_sock->read_timeout;
+    read_tv.tv_usec = (int)((ssdb_sock->read_timeout - read_tv.tv_sec) * 1000000);
+
+    /* set TCP_NODELAY */
+	sock = (php_netstream_data_t*)stream->abstract;
+    setsockopt(sock->socket, IPPROTO_TCP, TCP_NODELAY, (char *) &tcp_flag, sizeof(int));
+
+    php_stream_auto_cleanup(stream);
+
+    if (ssdb_sock->timeout != 0) {
+        php_stream_set_option(stream, PHP_STREAM_OPTION_READ_TIMEOUT, 0, &read_tv);
+    }
+    php_stream_set_option(stream, PHP_STREAM_OPTION_WRITE_BUFFER, PHP_STREAM_BUFFER_NONE, NULL);
+    /* responses are buffered in ssdb_sock->rbuf, no need for a second copy in the stream layer */
+    php_stream_set_option(stream, PHP_STREAM_OPTION_READ_BUFFER, PHP_STREAM_BUFFER_NONE, NULL);
+    php_stream_set_option(stream, PHP_STREAM_OPTION_BLOCKING, 1, NULL);
+}
+
 int ssdb_connect_socket(SSDBSock *ssdb_sock) {
     struct timeval tv, read_tv, *tv_ptr = NULL;
     char *host = NULL, *persistent_id = NULL, *errstr = NULL;
     int host_len, err = 0;
-	php_netstream_data_t *sock;
-	int tcp_flag = 1;
 
     if (ssdb_sock->stream != NULL) {
     	ssdb_disconnect_socket(ssdb_sock);
@@ -151,16 +249,30 @@ int ssdb_connect_socket(SSDBSock *ssdb_sock) {
 		}
 	}
 
-    ssdb_sock->stream = php_stream_xport_create(
-    		host,
-    		host_len,
-			ENFORCE_SAFE_MODE,
-			STREAM_XPORT_CLIENT | STREAM_XPORT_CONNECT,
-			persistent_id,
-			tv_ptr,
-			NULL,
-			&errstr,
-			&err);
+	if (persistent_id && ssdb_pool_enabled(TSRMLS_C)) {
+		//连接池中每个连接使用独立的persistent_id
+		if (ssdb_sock->pool_key) {
+			efree(ssdb_sock->pool_key);
+		}
+		ssdb_sock->pool_key = persistent_id;
+		persistent_id = NULL;
+
+		if (ssdb_pool_checkout(ssdb_sock, host, host_len, tv_ptr, &read_tv TSRMLS_CC) < 0) {
+			efree(host);
+			return -1;
+		}
+	} else {
+		ssdb_sock->stream = php_stream_xport_create(
+				host,
+				host_len,
+				ENFORCE_SAFE_MODE,
+				STREAM_XPORT_CLIENT | STREAM_XPORT_CONNECT,
+				persistent_id,
+				tv_ptr,
+				NULL,
+				&errstr,
+				&err);
+	}
 
     if (persistent_id) {
     	efree(persistent_id);
@@ -169,26 +281,299 @@ int ssdb_connect_socket(SSDBSock *ssdb_sock) {
     efree(host);
 
     if (!ssdb_sock->stream) {
-        efree(errstr);
+        if (errstr) efree(errstr);
         return -1;
     }
 
-    /* set TCP_NODELAY */
-	sock = (php_netstream_data_t*)ssdb_sock->stream->abstract;
-    setsockopt(sock->socket, IPPROTO_TCP, TCP_NODELAY, (char *) &tcp_flag, sizeof(int));
+    ssdb_stream_setup(ssdb_sock, ssdb_sock->stream);
 
-    php_stream_auto_cleanup(ssdb_sock->stream);
+    ssdb_sock->status = SSDB_SOCK_STATUS_CONNECTED;
+    ssdb_sock->rbuf_pos = 0;
+    ssdb_sock->rbuf_len = 0;
+    //新连接上不会再有之前请求的响应
+    ssdb_prefetch_reset(ssdb_sock);
 
-    if (tv.tv_sec != 0 || tv.tv_usec != 0) {
-        php_stream_set_option(ssdb_sock->stream, PHP_STREAM_OPTION_READ_TIMEOUT, 0, &read_tv);
+    return 0;
+}
+
+//同时向多个endpoint发起非阻塞连接,keep_all为0时使用最先连上的,否则等待全部完成,
+//按列表顺序第一个连上的作为主连接,其余作为只读连接
+int ssdb_connect_multi(SSDBSock *ssdb_sock, char **hosts, long *ports, int num, int keep_all) {
+    struct timeval tv, *tv_ptr = NULL;
+    struct timeval start, now;
+    php_stream **streams;
+    php_pollfd *fds;
+    int *state; //0连接中 1成功 -1失败
+    int i, pending = 0, primary = -1, first = -1;
+    long timeout_ms = ssdb_sock->timeout * 1000;
+
+    if (ssdb_sock->stream != NULL) {
+    	ssdb_disconnect_socket(ssdb_sock);
     }
-    php_stream_set_option(ssdb_sock->stream, PHP_STREAM_OPTION_WRITE_BUFFER, PHP_STREAM_BUFFER_NONE, NULL);
-    php_stream_set_option(ssdb_sock->stream, PHP_STREAM_OPTION_READ_BUFFER, PHP_STREAM_BUFFER_NONE, NULL);
-    php_stream_set_option(ssdb_sock->stream, PHP_STREAM_OPTION_BLOCKING, 1, NULL);
 
-    ssdb_sock->status = SSDB_SOCK_STATUS_CONNECTED;
+    tv.tv_sec  = (time_t)ssdb_sock->timeout;
+    tv.tv_usec = 0;
+    if (tv.tv_sec != 0) {
+	    tv_ptr = &tv;
+    }
 
-    return 0;
+    streams = ecalloc(num, sizeof(php_stream *));
+    fds     = ecalloc(num, sizeof(php_pollfd));
+    state   = ecalloc(num, sizeof(int));
+
+    for (i = 0; i < num; i++) {
+    	char *host = NULL, *errstr = NULL;
+    	int host_len, err = 0;
+
+    	host_len = spprintf(&host, 0, "%s:%ld", hosts[i], ports[i] ? ports[i] : 8888);
+    	streams[i] = php_stream_xport_create(
+    			host,
+    			host_len,
+    			ENFORCE_SAFE_MODE,
+    			STREAM_XPORT_CLIENT | STREAM_XPORT_CONNECT | STREAM_XPORT_CONNECT_ASYNC,
+    			NULL,
+    			tv_ptr,
+    			NULL,
+    			&errstr,
+    			&err);
+    	efree(host);
+    	if (errstr) efree(errstr);
+
+    	if (streams[i] == NULL) {
+    		state[i] = -1;
+    		fds[i].fd = -1;
+    		continue;
+    	}
+
+    	fds[i].fd = ((php_netstream_data_t *) streams[i]->abstract)->socket;
+    	fds[i].events = POLLOUT;
+    	pending++;
+    }
+
+    gettimeofday(&start, NULL);
+
+    while (pending > 0 && (keep_all || first < 0)) {
+    	long elapsed, n;
+
+    	gettimeofday(&now, NULL);
+    	elapsed = (now.tv_sec - start.tv_sec) * 1000 + (now.tv_usec - start.tv_usec) / 1000;
+    	if (timeout_ms > 0 && elapsed >= timeout_ms) {
+    		break;
+    	}
+
+    	n = php_poll2(fds, num, timeout_ms > 0 ? timeout_ms - elapsed : -1);
+    	if (n < 0) {
+    		break;
+    	}
+
+    	for (i = 0; i < num; i++) {
+    		int so_error = 0;
+    		socklen_t so_error_len = sizeof(so_error);
+
+    		if (state[i] != 0 || fds[i].revents == 0) {
+    			continue;
+    		}
+
+    		if (getsockopt(fds[i].fd, SOL_SOCKET, SO_ERROR, (char *) &so_error, &so_error_len) == 0 && so_error == 0) {
+    			state[i] = 1;
+    			if (first < 0) first = i;
+    		} else {
+    			state[i] = -1;
+    		}
+
+    		fds[i].fd = -1;
+    		pending--;
+    	}
+    }
+
+    if (keep_all) {
+    	for (i = 0; i < num && primary < 0; i++) {
+    		if (state[i] == 1) primary = i;
+    	}
+    } else {
+    	primary = first;
+    }
+
+    for (i = 0; i < num; i++) {
+    	if (streams[i] == NULL || i == primary) {
+    		continue;
+    	}
+
+    	if (keep_all && state[i] == 1) {
+    		ssdb_stream_setup(ssdb_sock, streams[i]);
+    		ssdb_sock->replicas = erealloc(ssdb_sock->replicas, (ssdb_sock->replica_num + 1) * sizeof(SSDBEndpoint));
+    		memset(&ssdb_sock->replicas[ssdb_sock->replica_num], 0, sizeof(SSDBEndpoint));
+    		ssdb_sock->replicas[ssdb_sock->replica_num].stream = streams[i];
+    		ssdb_sock->replicas[ssdb_sock->replica_num].host   = estrdup(hosts[i]);
+    		ssdb_sock->replicas[ssdb_sock->replica_num].port   = ports[i] ? ports[i] : 8888;
+    		ssdb_sock->replica_num++;
+    	} else {
+    		php_stream_close(streams[i]);
+    	}
+    }
+
+    if (primary >= 0) {
+    	efree(ssdb_sock->host);
+    	ssdb_sock->host = estrdup(hosts[primary]);
+    	ssdb_sock->port = ports[primary] ? ports[primary] : 8888;
+    	ssdb_sock->stream = streams[primary];
+    	ssdb_stream_setup(ssdb_sock, ssdb_sock->stream);
+
+    	ssdb_sock->status = SSDB_SOCK_STATUS_CONNECTED;
+    	ssdb_sock->rbuf_pos = 0;
+    	ssdb_sock->rbuf_len = 0;
+    	ssdb_prefetch_reset(ssdb_sock);
+    }
+
+    efree(streams);
+    efree(fds);
+    efree(state);
+
+    return primary >= 0 ? 0 : -1;
+}
+
+void ssdb_replicas_close(SSDBSock *ssdb_sock) {
+	int i;
+
+	ssdb_route_finish(ssdb_sock, 1);
+
+	for (i = 0; i < ssdb_sock->replica_num; i++) {
+		if (ssdb_sock->replicas[i].stream) {
+			php_stream_close(ssdb_sock->replicas[i].stream);
+		}
+		efree(ssdb_sock->replicas[i].host);
+	}
+
+	if (ssdb_sock->replicas) {
+		efree(ssdb_sock->replicas);
+	}
+
+	ssdb_sock->replicas = NULL;
+	ssdb_sock->replica_num = 0;
+}
+
+static int ssdb_route_pick(SSDBSock *ssdb_sock) {
+	SSDBEndpoint *replica;
+	double weight_sum = 0, point;
+	int i, k, best = -1;
+
+	switch (ssdb_sock->read_policy) {
+		case SSDB_READ_ROUND_ROBIN:
+			for (k = 0; k < ssdb_sock->replica_num; k++) {
+				i = (ssdb_sock->replica_next + k) % ssdb_sock->replica_num;
+				if (ssdb_sock->replicas[i].stream) {
+					best = i;
+					break;
+				}
+			}
+			if (best >= 0) {
+				ssdb_sock->replica_next = best + 1;
+			}
+			break;
+		case SSDB_READ_LEAST_OUTSTANDING:
+			//同步客户端每个连接最多一个未完成请求,相同时按累计请求数均衡
+			for (i = 0; i < ssdb_sock->replica_num; i++) {
+				replica = &ssdb_sock->replicas[i];
+				if (replica->stream == NULL) {
+					continue;
+				}
+				if (best < 0
+						|| replica->outstanding < ssdb_sock->replicas[best].outstanding
+						|| (replica->outstanding == ssdb_sock->replicas[best].outstanding
+								&& replica->requests < ssdb_sock->replicas[best].requests)) {
+					best = i;
+				}
+			}
+			break;
+		case SSDB_READ_LATENCY:
+			//按响应时间倒数加权随机,没有采样的连接优先
+			for (i = 0; i < ssdb_sock->replica_num; i++) {
+				replica = &ssdb_sock->replicas[i];
+				if (replica->stream == NULL) {
+					continue;
+				}
+				if (replica->latency <= 0) {
+					return i;
+				}
+				weight_sum += 1.0 / replica->latency;
+			}
+			if (weight_sum <= 0) {
+				break;
+			}
+			point = weight_sum * php_rand(TSRMLS_C) / (PHP_RAND_MAX + 1.0);
+			for (i = 0; i < ssdb_sock->replica_num; i++) {
+				replica = &ssdb_sock->replicas[i];
+				if (replica->stream == NULL) {
+					continue;
+				}
+				best = i;
+				point -= 1.0 / replica->latency;
+				if (point < 0) {
+					break;
+				}
+			}
+			break;
+	}
+
+	return best;
+}
+
+//只读命令切换到只读连接,在ssdb_sock_read读完响应后切回master
+void ssdb_route_read(SSDBSock *ssdb_sock) {
+	int i;
+
+	//batch中已合并的命令在切换连接之前发往master
+	ssdb_batch_settle(ssdb_sock TSRMLS_CC);
+
+	if (ssdb_sock->read_policy == SSDB_READ_MASTER
+			|| ssdb_sock->replica_num == 0
+			|| ssdb_sock->pipeline
+			|| ssdb_sock->route_index >= 0
+			|| ssdb_sock->status != SSDB_SOCK_STATUS_CONNECTED
+			|| ssdb_sock->prefetch_owner != NULL
+			|| ssdb_sock->pending_discard > 0
+			|| ssdb_sock->rbuf_pos != ssdb_sock->rbuf_len) {
+		return;
+	}
+
+	i = ssdb_route_pick(ssdb_sock);
+	if (i < 0) {
+		return;
+	}
+
+	ssdb_sock->master_stream = ssdb_sock->stream;
+	ssdb_sock->stream = ssdb_sock->replicas[i].stream;
+	ssdb_sock->route_index = i;
+	ssdb_sock->replicas[i].outstanding++;
+	ssdb_sock->replicas[i].requests++;
+	gettimeofday(&ssdb_sock->route_start, NULL);
+}
+
+//切回master,失败的只读连接直接关闭不再使用
+void ssdb_route_finish(SSDBSock *ssdb_sock, int ok) {
+	SSDBEndpoint *replica;
+	struct timeval now;
+	double elapsed;
+
+	if (ssdb_sock->route_index < 0) {
+		return;
+	}
+
+	replica = &ssdb_sock->replicas[ssdb_sock->route_index];
+	replica->outstanding--;
+
+	if (ok) {
+		gettimeofday(&now, NULL);
+		elapsed = (now.tv_sec - ssdb_sock->route_start.tv_sec) * 1000000.0 + (now.tv_usec - ssdb_sock->route_start.tv_usec);
+		replica->latency = replica->latency > 0 ? replica->latency * 0.8 + elapsed * 0.2 : elapsed;
+	} else if (replica->stream) {
+		php_stream_close(replica->stream);
+		replica->stream = NULL;
+	}
+
+	ssdb_sock->stream = ssdb_sock->master_stream;
+	ssdb_sock->master_stream = NULL;
+	ssdb_sock->route_index = -1;
 }
 
 int ssdb_disconnect_socket(SSDBSock *ssdb_sock) {
@@ -196,34 +581,140 @@ int ssdb_disconnect_socket(SSDBSock *ssdb_sock) {
 	    return 0;
     }
 
+    ssdb_route_finish(ssdb_sock, 1);
+
     if (ssdb_sock->stream != NULL) {
+    	//关闭前发出defer的命令,noreply命令的响应读完后连接才能复用
+    	ssdb_sock_finish(ssdb_sock);
     	ssdb_sock->status = SSDB_SOCK_STATUS_DISCONNECTED;
-		if (ssdb_sock->stream && !ssdb_sock->persistent) {
+    	//长连接上还有未读取的响应时不能再复用
+		if (ssdb_sock->pool_id) {
+			ssdb_pool_checkin(ssdb_sock, ssdb_sock->prefetch_pending || ssdb_sock->pending_discard TSRMLS_CC);
+		} else if (ssdb_sock->stream && (!ssdb_sock->persistent
+				|| ssdb_sock->prefetch_pending
+				|| ssdb_sock->pending_discard)) {
 			ssdb_stream_close(ssdb_sock);
 		}
 		ssdb_sock->stream = NULL;
     }
 
+    ssdb_prefetch_reset(ssdb_sock);
+    ssdb_replicas_close(ssdb_sock);
+
     return 1;
 }
 
-int ssdb_key_prefix(SSDBSock *ssdb_sock, char **key, int *key_len) {
+//从当前命令的arena中分配,ssdb_arena_reset时统一回收
+void *ssdb_arena_alloc(SSDBSock *ssdb_sock, size_t size) {
+	SSDBArenaChunk *chunk = ssdb_sock->arena;
+	char *ptr;
+
+	size = ZEND_MM_ALIGNED_SIZE(size);
+	if (chunk == NULL || chunk->size - chunk->used < size) {
+		size_t chunk_size = size > SSDB_ARENA_CHUNK_SIZE ? size : SSDB_ARENA_CHUNK_SIZE;
+		chunk = emalloc(XtOffsetOf(SSDBArenaChunk, data) + chunk_size);
+		chunk->size = chunk_size;
+		chunk->used = 0;
+		chunk->next = ssdb_sock->arena;
+		ssdb_sock->arena = chunk;
+	}
+
+	ptr = chunk->data + chunk->used;
+	chunk->used += size;
+
+	return ptr;
+}
+
+//只保留最早分配的一块,其余释放
+void ssdb_arena_reset(SSDBSock *ssdb_sock) {
+	SSDBArenaChunk *chunk = ssdb_sock->arena;
+
+	while (chunk != NULL && (chunk->next != NULL || chunk->size > SSDB_ARENA_CHUNK_SIZE)) {
+		SSDBArenaChunk *next = chunk->next;
+		efree(chunk);
+		chunk = next;
+	}
+
+	if (chunk != NULL) {
+		chunk->used = 0;
+	}
+	ssdb_sock->arena = chunk;
+}
+
+void ssdb_arena_free(SSDBSock *ssdb_sock) {
+	while (ssdb_sock->arena != NULL) {
+		SSDBArenaChunk *next = ssdb_sock->arena->next;
+		efree(ssdb_sock->arena);
+		ssdb_sock->arena = next;
+	}
+}
+
+//加上前缀的key分配在arena中,调用方无需释放
+void ssdb_key_prefix(SSDBSock *ssdb_sock, char **key, int *key_len) {
 	int ret_len;
 	char *ret;
 
 	if (ssdb_sock->prefix == NULL || ssdb_sock->prefix_len == 0) {
-		return 0;
+		return;
 	}
 
 	ret_len = ssdb_sock->prefix_len + *key_len;
-	ret = ecalloc(1 + ret_len, 1);
+	ret = ssdb_arena_alloc(ssdb_sock, 1 + ret_len);
 	memcpy(ret, ssdb_sock->prefix, ssdb_sock->prefix_len);
 	memcpy(ret + ssdb_sock->prefix_len, *key, *key_len);
+	ret[ret_len] = '\0';
 
 	*key = ret;
 	*key_len = ret_len;
+}
 
-	return 1;
+static const char ssdb_digits_2[201] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+//从end向前写入十进制数字,每次处理两位,返回起始位置
+static char *ssdb_ltoa(char *end, long long value) {
+	unsigned long long v = value < 0 ? 0 - (unsigned long long) value : (unsigned long long) value;
+	char *p = end;
+
+	while (v >= 100) {
+		unsigned int i = (unsigned int) (v % 100) * 2;
+		v /= 100;
+		*--p = ssdb_digits_2[i + 1];
+		*--p = ssdb_digits_2[i];
+	}
+
+	if (v >= 10) {
+		unsigned int i = (unsigned int) v * 2;
+		*--p = ssdb_digits_2[i + 1];
+		*--p = ssdb_digits_2[i];
+	} else {
+		*--p = (char) ('0' + v);
+	}
+
+	if (value < 0) {
+		*--p = '-';
+	}
+
+	return p;
+}
+
+static zend_always_inline void ssdb_cmd_append(smart_str *buf, const char *data, size_t len) {
+	char num[SSDB_LTOA_BUF_SIZE], *end = num + sizeof(num);
+	char *p = ssdb_ltoa(end, (long long) len);
+
+	smart_str_appendl(buf, p, end - p);
+	smart_str_appendc(buf, '\n');
+	smart_str_appendl(buf, data, len);
+	smart_str_appendc(buf, '\n');
 }
 
 int ssdb_cmd_format_by_str(SSDBSock *ssdb_sock, char **ret, void *params, ...) {
@@ -238,10 +729,7 @@ int ssdb_cmd_format_by_str(SSDBSock *ssdb_sock, char **ret, void *params, ...) {
 	while (1) {
 		if (0 == i % 2) {
 			var_len = va_arg(ap, int);
-			smart_str_append_long(&buf, var_len);
-			smart_str_appendl(&buf, _NL, sizeof(_NL) - 1);
-			smart_str_appendl(&buf, var, var_len);
-			smart_str_appendl(&buf, _NL, sizeof(_NL) - 1);
+			ssdb_cmd_append(&buf, var, var_len);
 		} else {
 			var = va_arg(ap, char*);
 			if (var == NULL) break;
@@ -260,8 +748,169 @@ int ssdb_cmd_format_by_str(SSDBSock *ssdb_sock, char **ret, void *params, ...) {
 	return buf.len;
 }
 
-int ssdb_cmd_format_by_zval(SSDBSock *ssdb_sock,
-		char **ret,
+int ssdb_cmd_format_argv(SSDBSock *ssdb_sock, char **ret, const SSDBArg *argv, int argc) {
+	smart_str buf = {0};
+	char num[SSDB_LTOA_BUF_SIZE], *end = num + sizeof(num), *p;
+	int i, len;
+
+	for (i = 0; i < argc; i++) {
+		switch (argv[i].type) {
+			case SSDB_ARG_STRING:
+				ssdb_cmd_append(&buf, argv[i].str, argv[i].len);
+				break;
+			case SSDB_ARG_LONG:
+				p = ssdb_ltoa(end, argv[i].lval);
+				ssdb_cmd_append(&buf, p, end - p);
+				break;
+			case SSDB_ARG_DOUBLE:
+				len = snprintf(num, sizeof(num), "%.17g", argv[i].dval);
+				ssdb_cmd_append(&buf, num, len);
+				break;
+		}
+	}
+
+	smart_str_appendc(&buf, '\n');
+	smart_str_0(&buf);
+
+	*ret = buf.c;
+
+	SSDB_DEBUG_LOG("%s|", buf.c);
+
+	return buf.len;
+}
+
+//types中每个字符对应一个参数: s为(char *, int), l为long, L为long long, d为double
+int ssdb_cmd_format(SSDBSock *ssdb_sock, char **ret, const char *types, ...) {
+	SSDBArg argv[SSDB_CMD_MAX_ARGS];
+	int argc = 0;
+	va_list ap;
+
+	va_start(ap, types);
+	for (; *types && argc < SSDB_CMD_MAX_ARGS; types++, argc++) {
+		switch (*types) {
+			case 's':
+				argv[argc].type = SSDB_ARG_STRING;
+				argv[argc].str  = va_arg(ap, char *);
+				argv[argc].len  = va_arg(ap, int);
+				break;
+			case 'l':
+				argv[argc].type = SSDB_ARG_LONG;
+				argv[argc].lval = va_arg(ap, long);
+				break;
+			case 'L':
+				argv[argc].type = SSDB_ARG_LONG;
+				argv[argc].lval = va_arg(ap, long long);
+				break;
+			case 'd':
+				argv[argc].type = SSDB_ARG_DOUBLE;
+				argv[argc].dval = va_arg(ap, double);
+				break;
+		}
+	}
+	va_end(ap);
+
+	return ssdb_cmd_format_argv(ssdb_sock, ret, argv, argc);
+}
+
+void ssdb_wvec_init(SSDBWriteVec *vec, size_t threshold) {
+	memset(vec, 0, sizeof(SSDBWriteVec));
+	vec->threshold = threshold;
+}
+
+void ssdb_wvec_free(SSDBWriteVec *vec) {
+	int i;
+
+	for (i = 0; i < vec->owned_num; i++) {
+		efree(vec->owned[i]);
+	}
+
+	if (vec->owned) efree(vec->owned);
+	if (vec->segs) efree(vec->segs);
+	smart_str_free(&vec->buf);
+	memset(vec, 0, sizeof(SSDBWriteVec));
+}
+
+static void ssdb_wvec_push(SSDBWriteVec *vec, const char *data, size_t offset, size_t len) {
+	if (vec->num == vec->size) {
+		vec->size = vec->size ? vec->size * 2 : 16;
+		vec->segs = erealloc(vec->segs, vec->size * sizeof(SSDBWriteSegment));
+	}
+
+	vec->segs[vec->num].data   = data;
+	vec->segs[vec->num].offset = offset;
+	vec->segs[vec->num].len    = len;
+	vec->num++;
+}
+
+//复制到buf,与前一段buf相邻时合并
+static void ssdb_wvec_copy(SSDBWriteVec *vec, const char *data, size_t len) {
+	SSDBWriteSegment *last = vec->num > 0 ? &vec->segs[vec->num - 1] : NULL;
+	size_t offset = vec->buf.len;
+
+	smart_str_appendl(&vec->buf, data, len);
+	vec->total += len;
+
+	if (last && last->data == NULL && last->offset + last->len == offset) {
+		last->len += len;
+	} else {
+		ssdb_wvec_push(vec, NULL, offset, len);
+	}
+}
+
+//追加一个参数,大于等于threshold的数据只引用不复制
+void ssdb_wvec_append(SSDBWriteVec *vec, const char *data, size_t len, int copy) {
+	char header[SSDB_LTOA_BUF_SIZE], *end = header + sizeof(header) - 1;
+	char *p = ssdb_ltoa(end, (long long) len);
+
+	*end = '\n';
+	ssdb_wvec_copy(vec, p, end - p + 1);
+
+	if (copy || vec->threshold == 0 || len < vec->threshold) {
+		ssdb_wvec_copy(vec, data, len);
+	} else {
+		ssdb_wvec_push(vec, data, 0, len);
+		vec->total += len;
+	}
+
+	ssdb_wvec_copy(vec, _NL, sizeof(_NL) - 1);
+}
+
+//引用的数据在发送后释放
+void ssdb_wvec_own(SSDBWriteVec *vec, char *data) {
+	if (vec->owned_num == vec->owned_size) {
+		vec->owned_size = vec->owned_size ? vec->owned_size * 2 : 4;
+		vec->owned = erealloc(vec->owned, vec->owned_size * sizeof(char *));
+	}
+
+	vec->owned[vec->owned_num++] = data;
+}
+
+//合并为一块连续内存,只有一段buf时直接取走
+int ssdb_wvec_flatten(SSDBWriteVec *vec, char **ret) {
+	int i;
+	size_t pos = 0;
+
+	if (vec->num == 1 && vec->segs[0].data == NULL) {
+		smart_str_0(&vec->buf);
+		*ret = vec->buf.c;
+		vec->buf.c = NULL;
+		vec->buf.len = 0;
+		vec->buf.a = 0;
+		return vec->total;
+	}
+
+	*ret = emalloc(vec->total + 1);
+	for (i = 0; i < vec->num; i++) {
+		memcpy(*ret + pos, SSDB_WVEC_SEGMENT_DATA(vec, i), vec->segs[i].len);
+		pos += vec->segs[i].len;
+	}
+	(*ret)[pos] = '\0';
+
+	return vec->total;
+}
+
+int ssdb_cmd_vec_by_zval(SSDBSock *ssdb_sock,
+		SSDBWriteVec *vec,
 		char *cmd, int cmd_len,
 		char *key, int key_len,
 		zval *params,
@@ -274,17 +923,10 @@ int ssdb_cmd_format_by_zval(SSDBSock *ssdb_sock,
 		return 0;
 	}
 
-	smart_str buf = {0};
-	smart_str_append_long(&buf, cmd_len);
-	smart_str_appendl(&buf, _NL, sizeof(_NL) - 1);
-	smart_str_appendl(&buf, cmd, cmd_len);
-	smart_str_appendl(&buf, _NL, sizeof(_NL) - 1);
+	ssdb_wvec_append(vec, cmd, cmd_len, 1);
 
 	if (key_len > 0) {
-		smart_str_append_long(&buf, key_len);
-		smart_str_appendl(&buf, _NL, sizeof(_NL) - 1);
-		smart_str_appendl(&buf, key, key_len);
-		smart_str_appendl(&buf, _NL, sizeof(_NL) - 1);
+		ssdb_wvec_append(vec, key, key_len, 1);
 	}
 
 	for (zend_hash_internal_pointer_reset(hash); zend_hash_has_more_elements(hash) == SUCCESS; zend_hash_move_forward(hash)) {
@@ -292,7 +934,7 @@ int ssdb_cmd_format_by_zval(SSDBSock *ssdb_sock,
 		char *key, *val, *key_str = NULL;
 		unsigned int key_len;
 		unsigned long idx;
-		int val_len = 0, val_free = 0, key_free = 0;
+		int val_len = 0, val_free = 0;
 
 		zend_hash_get_current_data(hash, (void**)&z_value_pp);
 		if (read_all) {
@@ -305,7 +947,7 @@ int ssdb_cmd_format_by_zval(SSDBSock *ssdb_sock,
 			}
 
 			if (fill_prefix) {
-				key_free = ssdb_key_prefix(ssdb_sock, &key, (int*)&key_len);
+				ssdb_key_prefix(ssdb_sock, &key, (int*)&key_len);
 			}
 
 			if (serialize) {
@@ -316,15 +958,14 @@ int ssdb_cmd_format_by_zval(SSDBSock *ssdb_sock,
 				val_len = Z_STRLEN_PP(z_value_pp);
 			}
 
-			smart_str_append_long(&buf, (long)key_len);
-			smart_str_appendl(&buf, _NL, sizeof(_NL) - 1);
-			smart_str_appendl(&buf, key, (long)key_len);
-			smart_str_appendl(&buf, _NL, sizeof(_NL) - 1);
+			ssdb_wvec_append(vec, key, key_len, 1);
+			ssdb_wvec_append(vec, val, val_len, 0);
 
-			smart_str_append_long(&buf, (long)val_len);
-			smart_str_appendl(&buf, _NL, sizeof(_NL) - 1);
-			smart_str_appendl(&buf, val, (long)val_len);
-			smart_str_appendl(&buf, _NL, sizeof(_NL) - 1);
+			//未复制的序列化结果要等发送之后再释放
+			if (val_free && vec->threshold > 0 && (size_t)val_len >= vec->threshold) {
+				ssdb_wvec_own(vec, val);
+				val_free = 0;
+			}
 		} else {
 			convert_to_string(*z_value_pp);
 			key = Z_STRVAL_PP(z_value_pp);
@@ -334,28 +975,41 @@ int ssdb_cmd_format_by_zval(SSDBSock *ssdb_sock,
 			}
 
 			if (fill_prefix) {
-				key_free = ssdb_key_prefix(ssdb_sock, &key, (int*)&key_len);
+				ssdb_key_prefix(ssdb_sock, &key, (int*)&key_len);
 			}
 
-			smart_str_append_long(&buf, (long)key_len);
-			smart_str_appendl(&buf, _NL, sizeof(_NL) - 1);
-			smart_str_appendl(&buf, key, (long)key_len);
-			smart_str_appendl(&buf, _NL, sizeof(_NL) - 1);
+			ssdb_wvec_append(vec, key, key_len, 1);
 		}
 
 		if (key_str) efree(key_str);
-		if (key_free) efree(key);
 		if (val_free) STR_FREE(val);
 	}
 
-	smart_str_appendl(&buf, _NL, sizeof(_NL) - 1);
-	smart_str_0(&buf);
+	ssdb_wvec_copy(vec, _NL, sizeof(_NL) - 1);
 
-	*ret = buf.c;
+	return vec->total;
+}
 
-	SSDB_DEBUG_LOG("%s|", buf.c);
+int ssdb_cmd_format_by_zval(SSDBSock *ssdb_sock,
+		char **ret,
+		char *cmd, int cmd_len,
+		char *key, int key_len,
+		zval *params,
+		int read_all,
+		int fill_prefix,
+		int serialize) {
+	SSDBWriteVec vec;
+	int len = 0;
+
+	//threshold为0时全部复制,结果只有一段buf
+	ssdb_wvec_init(&vec, 0);
+	if (ssdb_cmd_vec_by_zval(ssdb_sock, &vec, cmd, cmd_len, key, key_len, params, read_all, fill_prefix, serialize) > 0) {
+		len = ssdb_wvec_flatten(&vec, ret);
+		SSDB_DEBUG_LOG("%s|", *ret);
+	}
+	ssdb_wvec_free(&vec);
 
-	return buf.len;
+	return len;
 }
 
 int ssdb_check_eof(SSDBSock *ssdb_sock) {
@@ -418,184 +1072,521 @@ SSDBResponse *ssdb_response_create() {
 	}
 
 	ssdb_response->status = SSDB_IS_DEFAULT;
-	ssdb_response->block  = NULL;
-	ssdb_response->tail   = NULL;
+	ssdb_response->arena  = NULL;
+	ssdb_response->data   = NULL;
+	ssdb_response->blocks = NULL;
 	ssdb_response->num    = 0;
+	ssdb_response->size   = 0;
 
 	return ssdb_response;
 }
 
 void ssdb_response_free(SSDBResponse *ssdb_response) {
 	if (ssdb_response) {
-		SSDBResponseBlock *ssdb_response_block = ssdb_response->block;
-		while (ssdb_response_block != NULL) {
-			SSDBResponseBlock *ssdb_response_block_next = ssdb_response_block->next;
-			if (ssdb_response_block->data != NULL) {
-				efree(ssdb_response_block->data);
-			}
-			efree(ssdb_response_block);
-			ssdb_response_block = ssdb_response_block_next;
+		if (ssdb_response->arena != NULL) {
+			efree(ssdb_response->arena);
+		}
+		if (ssdb_response->blocks != NULL) {
+			efree(ssdb_response->blocks);
 		}
 		efree(ssdb_response);
 	}
 }
 
-void ssdb_response_add_block(SSDBResponse *ssdb_response, char *data, size_t len) {
+void ssdb_response_add_block(SSDBResponse *ssdb_response, size_t offset, size_t len) {
 	if (ssdb_response == NULL) {
 		zend_throw_exception(ssdb_exception_ce, "SSDBResponse must be malloc", 0 TSRMLS_CC);
 		return;
 	}
 
-	if (data == NULL) {
-		zend_throw_exception(ssdb_exception_ce, "SSDBResponseData must be malloc", 0 TSRMLS_CC);
-		return;
-	}
-
-	SSDBResponseBlock *ssdb_response_block = emalloc(sizeof (SSDBResponseBlock));
-	if (ssdb_response_block == NULL) {
-		zend_throw_exception(ssdb_exception_ce, "SSDBResponseBlock memory malloc failed", 0 TSRMLS_CC);
-		return;
+	if (ssdb_response->num == ssdb_response->size) {
+		ssdb_response->size = ssdb_response->size ? ssdb_response->size << 1 : 8;
+		ssdb_response->blocks = erealloc(ssdb_response->blocks, ssdb_response->size * sizeof(SSDBResponseBlock));
 	}
 
-	ssdb_response_block->data = estrndup(data, len);
-	ssdb_response_block->len  = len;
-	ssdb_response_block->next = NULL;
+	ssdb_response->blocks[ssdb_response->num].offset = offset;
+	ssdb_response->blocks[ssdb_response->num].len    = len;
+	ssdb_response->num += 1;
+}
 
-	if (ssdb_response->tail == NULL) {
-		ssdb_response_block->prev = NULL;
-		ssdb_response->block = ssdb_response_block;
-		ssdb_response->tail = ssdb_response_block;
-	} else {
-		ssdb_response_block->prev = ssdb_response->tail;
-		ssdb_response_block->prev->next = ssdb_response_block;
-		ssdb_response->tail = ssdb_response_block;
+static SSDBResponse *ssdb_response_clone(const SSDBResponse *src) {
+	SSDBResponse *dst = ssdb_response_create();
+	size_t size;
+
+	dst->status = src->status;
+	if (src->num > 0) {
+		//块按顺序排列,最后一块之后还有一个截断用的'\0'
+		size = src->blocks[src->num - 1].offset + src->blocks[src->num - 1].len + 1;
+		dst->arena  = emalloc(size);
+		dst->data   = dst->arena;
+		dst->blocks = emalloc(src->num * sizeof(SSDBResponseBlock));
+		dst->num    = src->num;
+		dst->size   = src->num;
+		memcpy(dst->arena, src->data, size);
+		memcpy(dst->blocks, src->blocks, src->num * sizeof(SSDBResponseBlock));
 	}
 
-	ssdb_response->num += 1;
+	return dst;
 }
 
-SSDBResponse *ssdb_sock_read(SSDBSock *ssdb_sock) {
-    if (-1 == ssdb_check_eof(ssdb_sock)) {
-        return NULL;
-    }
+static void ssdb_read_cache_response_dtor(void *data) {
+	ssdb_response_free(*(SSDBResponse **) data);
+}
 
-    SSDBResponse *ssdb_response = ssdb_response_create();
+static void ssdb_read_cache_key_dtor(void *data) {
+	HashTable *entries = *(HashTable **) data;
 
-    int read_step = 0; //default is read len mode
+	zend_hash_destroy(entries);
+	FREE_HASHTABLE(entries);
+}
 
-    size_t expect_read_num = 1;
-    size_t actual_read_num = 0;
+//argv[1]为加前缀的key,命令名和之后的参数组成field;未命中时记下key和field等待响应
+//shm为1时再查找跨请求的共享内存缓存
+SSDBResponse *ssdb_read_cache_get(SSDBSock *ssdb_sock, const SSDBArg *argv, int argc, int shm) {
+	HashTable **entries;
+	SSDBResponse **found, *ssdb_response;
+	char *field, *value;
+	int field_len = argv[0].len, value_len, i;
 
-    int to_read_buf_max   = 1024;
-    int to_read_buf_total = 0;
+	for (i = 2; i < argc; i++) {
+		field_len += 1 + argv[i].len;
+	}
 
-    char *to_read_buf = emalloc(to_read_buf_max + 1);
-    if (to_read_buf == NULL) {
-    	ssdb_response_free(ssdb_response);
-    	return NULL;
-    }
+	field = ssdb_arena_alloc(ssdb_sock, field_len);
+	memcpy(field, argv[0].str, argv[0].len);
+	for (field_len = argv[0].len, i = 2; i < argc; i++) {
+		field[field_len++] = '\0';
+		memcpy(field + field_len, argv[i].str, argv[i].len);
+		field_len += argv[i].len;
+	}
 
-    memset(to_read_buf, '\0', to_read_buf_max + 1);
+	if (ssdb_sock->read_cache
+			&& ssdb_sock->read_cache_keys
+			&& zend_hash_find(ssdb_sock->read_cache_keys, (char *) argv[1].str, argv[1].len, (void **) &entries) == SUCCESS
+			&& zend_hash_find(*entries, field, field_len, (void **) &found) == SUCCESS) {
+		return ssdb_response_clone(*found);
+	}
 
-    while (1) {
-    	if (0 == read_step || 3 == read_step) {
-    		char buf[1] = {' '};
-    		actual_read_num = php_stream_read(ssdb_sock->stream, buf, 1);
-    		SSDB_DEBUG_LOG("read sock actual num %zu on step first\n", actual_read_num);
-    		SSDB_DEBUG_LOG("read sock actual data %c on step first\n", buf[0]);
-    		if (actual_read_num == 0) {
-    			break;
-    		}
+	if (shm && (value = ssdb_shm_get(ssdb_sock->shm_server, ssdb_sock->shm_server_len, argv[1].str, argv[1].len, field, field_len, &value_len)) != NULL) {
+		ssdb_response = ssdb_response_create();
+		ssdb_response->status = SSDB_IS_OK;
+		ssdb_response->arena  = value;
+		ssdb_response->data   = value;
+		ssdb_response_add_block(ssdb_response, 0, value_len);
+		return ssdb_response;
+	}
 
-    		if (to_read_buf_total + actual_read_num > to_read_buf_max) {
-    			break;
-    		}
+	ssdb_sock->cache_key = ssdb_arena_alloc(ssdb_sock, argv[1].len);
+	memcpy(ssdb_sock->cache_key, argv[1].str, argv[1].len);
+	ssdb_sock->cache_key_len   = argv[1].len;
+	ssdb_sock->cache_field     = field;
+	ssdb_sock->cache_field_len = field_len;
+	ssdb_sock->cache_shm       = shm;
 
-    		if (3 == read_step) {
-    			if (buf[0] == '\n') {
-					SSDB_DEBUG_LOG("read sock end\n");
-					break;
-    			} else {
-    				read_step = 0;
-    			}
-    		}
+	return NULL;
+}
 
-    		if (buf[0] == '\n') {
-    			expect_read_num = atoi(to_read_buf) + 1;
-    			if (expect_read_num == 0) {
-    				break;
-    			}
+static void ssdb_read_cache_store(SSDBSock *ssdb_sock, SSDBResponse *ssdb_response) {
+	HashTable **found, *entries;
+	SSDBResponse *copy;
 
-    			if (expect_read_num > to_read_buf_max) {
-    				efree(to_read_buf);
-    				to_read_buf_max = expect_read_num;
-    				to_read_buf = emalloc(to_read_buf_max + 1);
-    				memset(to_read_buf, '\0', to_read_buf_max + 1);
-    			}
+	ssdb_sock->cache_store = 0;
 
-    			read_step = 1; //switch to read var mode
-    			memset(to_read_buf, '\0', expect_read_num);
-    			to_read_buf_total = 0;
+	if (ssdb_response == NULL
+			|| ssdb_sock->cache_key == NULL
+			|| (ssdb_response->status != SSDB_IS_OK && ssdb_response->status != SSDB_IS_NOT_FOUND)) {
+		return;
+	}
 
-    			SSDB_DEBUG_LOG("read sock num %zu before step second\n", expect_read_num);
-    		} else {
-    			memcpy(to_read_buf + to_read_buf_total, buf, actual_read_num);
-    			to_read_buf_total += actual_read_num;
-    			SSDB_DEBUG_LOG("read sock all data %s on step first\n", to_read_buf);
-    		}
-    	} else {
-    		actual_read_num = php_stream_read(ssdb_sock->stream, to_read_buf + to_read_buf_total, expect_read_num);
-    		SSDB_DEBUG_LOG("read sock actual num %zu on step second expect read num %zu\n", actual_read_num, expect_read_num);
+	//共享内存只缓存存在的单个值
+	if (ssdb_sock->cache_shm && ssdb_response->status == SSDB_IS_OK && ssdb_response->num == 1) {
+		ssdb_shm_put(ssdb_sock->shm_server, ssdb_sock->shm_server_len, ssdb_sock->cache_key, ssdb_sock->cache_key_len,
+				ssdb_sock->cache_field, ssdb_sock->cache_field_len,
+				SSDB_RESPONSE_BLOCK_DATA(ssdb_response, 0), SSDB_RESPONSE_BLOCK_LEN(ssdb_response, 0),
+				ssdb_sock->shm_cache_ttl);
+	}
 
-    		if (actual_read_num == 0) {
-				break;
+	if (!ssdb_sock->read_cache) {
+		ssdb_sock->cache_key = NULL;
+		return;
+	}
+
+	if (ssdb_sock->read_cache_keys == NULL) {
+		ALLOC_HASHTABLE(ssdb_sock->read_cache_keys);
+		zend_hash_init(ssdb_sock->read_cache_keys, 16, NULL, ssdb_read_cache_key_dtor, 0);
+	}
+
+	if (zend_hash_find(ssdb_sock->read_cache_keys, ssdb_sock->cache_key, ssdb_sock->cache_key_len, (void **) &found) == SUCCESS) {
+		entries = *found;
+	} else {
+		ALLOC_HASHTABLE(entries);
+		zend_hash_init(entries, 4, NULL, ssdb_read_cache_response_dtor, 0);
+		zend_hash_add(ssdb_sock->read_cache_keys, ssdb_sock->cache_key, ssdb_sock->cache_key_len, &entries, sizeof(HashTable *), NULL);
+	}
+
+	copy = ssdb_response_clone(ssdb_response);
+	zend_hash_update(entries, ssdb_sock->cache_field, ssdb_sock->cache_field_len, &copy, sizeof(SSDBResponse *), NULL);
+	ssdb_sock->cache_key = NULL;
+}
+
+static void ssdb_read_cache_drop(SSDBSock *ssdb_sock, const char *key, int key_len) {
+	ssdb_shm_forget(ssdb_sock->shm_server, ssdb_sock->shm_server_len, key, key_len);
+
+	if (ssdb_sock->read_cache_keys) {
+		zend_hash_del(ssdb_sock->read_cache_keys, (char *) key, key_len);
+	}
+}
+
+//当前写命令会进入defer队列
+static int ssdb_read_cache_deferring(SSDBSock *ssdb_sock) {
+	return ssdb_sock->defer_once && !ssdb_sock->pipeline;
+}
+
+//写命令丢弃该key下的全部缓存,共享内存中的也一起删除
+//defer的命令在ssdb_defer_flush发出之后再丢弃一次,期间读到的旧值不会留在缓存中
+void ssdb_read_cache_forget(SSDBSock *ssdb_sock, const char *key, int key_len) {
+	ssdb_read_cache_drop(ssdb_sock, key, key_len);
+
+	if (ssdb_read_cache_deferring(ssdb_sock)) {
+		if (ssdb_sock->defer_keys == NULL) {
+			ALLOC_HASHTABLE(ssdb_sock->defer_keys);
+			zend_hash_init(ssdb_sock->defer_keys, 16, NULL, NULL, 0);
+		}
+		zend_hash_add_empty_element(ssdb_sock->defer_keys, (char *) key, key_len);
+	}
+}
+
+//multi_set的key在数组下标中,multi_del的key在数组值中
+void ssdb_read_cache_forget_zval(SSDBSock *ssdb_sock, zval *z_args, int use_keys) {
+	HashPosition pos;
+	zval **z_value, tmp;
+	char *key, num[MAX_LENGTH_OF_LONG + 1];
+	uint key_len;
+	ulong idx;
+	int len, tmp_used;
+
+	if (ssdb_sock->read_cache_keys == NULL && !ssdb_shm_enabled() && !ssdb_read_cache_deferring(ssdb_sock)) {
+		return;
+	}
+
+	for (zend_hash_internal_pointer_reset_ex(Z_ARRVAL_P(z_args), &pos);
+			zend_hash_get_current_data_ex(Z_ARRVAL_P(z_args), (void **) &z_value, &pos) == SUCCESS;
+			zend_hash_move_forward_ex(Z_ARRVAL_P(z_args), &pos)) {
+		tmp_used = 0;
+		if (use_keys) {
+			if (zend_hash_get_current_key_ex(Z_ARRVAL_P(z_args), &key, &key_len, &idx, 0, &pos) == HASH_KEY_IS_STRING) {
+				len = key_len - 1;
+			} else {
+				len = snprintf(num, sizeof(num), "%ld", (long) idx);
+				key = num;
 			}
+		} else if (Z_TYPE_PP(z_value) == IS_STRING) {
+			key = Z_STRVAL_PP(z_value);
+			len = Z_STRLEN_PP(z_value);
+		} else {
+			//与格式化命令时一样转换为字符串
+			tmp = **z_value;
+			zval_copy_ctor(&tmp);
+			convert_to_string(&tmp);
+			key = Z_STRVAL(tmp);
+			len = Z_STRLEN(tmp);
+			tmp_used = 1;
+		}
 
-    		to_read_buf_total += actual_read_num;
-			expect_read_num -= actual_read_num;
-			if (expect_read_num != 0) {
-				continue;
+		ssdb_key_prefix(ssdb_sock, &key, &len);
+		ssdb_read_cache_forget(ssdb_sock, key, len);
+		if (tmp_used) zval_dtor(&tmp);
+	}
+}
+
+//request/write发出的原始命令无法判断类型,每条命令的第一个参数按key从共享内存缓存中删除
+void ssdb_read_cache_forget_raw(SSDBSock *ssdb_sock, const char *buf, int buf_len) {
+	const char *p = buf, *end = buf + buf_len, *nl, *q;
+	long len;
+	int block = 0;
+
+	if (!ssdb_shm_enabled()) {
+		return;
+	}
+
+	while (p < end) {
+		//空行结束一条命令
+		if (*p == '\n' || (*p == '\r' && p + 1 < end && p[1] == '\n')) {
+			p += *p == '\r' ? 2 : 1;
+			block = 0;
+			continue;
+		}
+
+		nl = memchr(p, '\n', end - p);
+		if (nl == NULL || *p < '0' || *p > '9') {
+			return;
+		}
+		for (len = 0, q = p; q < nl && *q >= '0' && *q <= '9' && len <= buf_len; q++) {
+			len = len * 10 + (*q - '0');
+		}
+
+		p = nl + 1;
+		if (len > end - p) {
+			return;
+		}
+		if (block == 1) {
+			ssdb_shm_forget(ssdb_sock->shm_server, ssdb_sock->shm_server_len, p, (int) len);
+		}
+
+		p += len;
+		if (p < end && *p == '\r') p++;
+		if (p >= end || *p != '\n') {
+			return;
+		}
+		p++;
+		block++;
+	}
+}
+
+void ssdb_read_cache_reset(SSDBSock *ssdb_sock) {
+	if (ssdb_sock->read_cache_keys) {
+		zend_hash_destroy(ssdb_sock->read_cache_keys);
+		FREE_HASHTABLE(ssdb_sock->read_cache_keys);
+		ssdb_sock->read_cache_keys = NULL;
+	}
+
+	if (ssdb_sock->cache_hit) {
+		ssdb_response_free(ssdb_sock->cache_hit);
+		ssdb_sock->cache_hit = NULL;
+	}
+
+	ssdb_sock->cache_key = NULL;
+	ssdb_sock->cache_store = 0;
+}
+
+//保证接收缓冲区中从rbuf_pos起至少有need字节数据
+static int ssdb_sock_fill(SSDBSock *ssdb_sock, size_t need) {
+	size_t actual_read_num;
+
+	if (ssdb_sock->rbuf_size - ssdb_sock->rbuf_pos < need && ssdb_sock->rbuf_pos > 0) {
+		ssdb_sock->rbuf_len -= ssdb_sock->rbuf_pos;
+		memmove(ssdb_sock->rbuf, ssdb_sock->rbuf + ssdb_sock->rbuf_pos, ssdb_sock->rbuf_len);
+		ssdb_sock->rbuf_pos = 0;
+	}
+
+	if (ssdb_sock->rbuf_size < need) {
+		size_t rbuf_size = ssdb_sock->rbuf_size ? ssdb_sock->rbuf_size : SSDB_SOCK_READ_BUF_SIZE;
+		while (rbuf_size < need) {
+			rbuf_size <<= 1;
+		}
+		ssdb_sock->rbuf = erealloc(ssdb_sock->rbuf, rbuf_size);
+		ssdb_sock->rbuf_size = rbuf_size;
+	}
+
+	while (ssdb_sock->rbuf_len - ssdb_sock->rbuf_pos < need) {
+		actual_read_num = php_stream_read(ssdb_sock->stream, ssdb_sock->rbuf + ssdb_sock->rbuf_len, ssdb_sock->rbuf_size - ssdb_sock->rbuf_len);
+		SSDB_DEBUG_LOG("read sock actual num %zu\n", actual_read_num);
+		if (actual_read_num == 0) {
+			return -1;
+		}
+		ssdb_sock->rbuf_len += actual_read_num;
+	}
+
+	return 0;
+}
+
+//查找换行符,SSE2每次比较16字节,其余平台用memchr
+static zend_always_inline const char *ssdb_find_nl(const char *p, size_t len) {
+#ifdef SSDB_HAVE_SSE2
+	const __m128i nl = _mm_set1_epi8('\n');
+
+	while (len >= 16) {
+		int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) p), nl));
+		if (mask) {
+			return p + __builtin_ctz(mask);
+		}
+		p   += 16;
+		len -= 16;
+	}
+#endif
+
+	return len > 0 ? memchr(p, '\n', len) : NULL;
+}
+
+//解析长度头,不检查溢出,遇到非数字字符时返回-1
+static zend_always_inline int ssdb_parse_len(const char *p, size_t len, size_t *ret) {
+	size_t n = 0;
+	unsigned int bad = 0;
+
+	//兼容\r\n结尾
+	if (len > 0 && p[len - 1] == '\r') {
+		len--;
+	}
+
+	if (len == 0 || len > SSDB_MAX_LEN_DIGITS) {
+		return -1;
+	}
+
+	switch (len) {
+		default:
+			while (len > 4) {
+				bad |= (unsigned char) (*p - '0') > 9;
+				n = n * 10 + (*p++ - '0');
+				len--;
 			}
+		case 4: bad |= (unsigned char) (*p - '0') > 9; n = n * 10 + (*p++ - '0');
+		case 3: bad |= (unsigned char) (*p - '0') > 9; n = n * 10 + (*p++ - '0');
+		case 2: bad |= (unsigned char) (*p - '0') > 9; n = n * 10 + (*p++ - '0');
+		case 1: bad |= (unsigned char) (*p - '0') > 9; n = n * 10 + (*p - '0');
+	}
+
+	*ret = n;
+
+	return bad ? -1 : 0;
+}
+
+static ssdb_response_status ssdb_response_parse_status(const char *data, size_t len) {
+	if (len == 2 && 0 == memcmp(data, "ok", 2)) {
+		return SSDB_IS_OK;
+	} else if (len == 9 && 0 == memcmp(data, "not_found", 9)) {
+		return SSDB_IS_NOT_FOUND;
+	} else if (len == 5 && 0 == memcmp(data, "error", 5)) {
+		return SSDB_IS_ERROR;
+	} else if (len == 4 && 0 == memcmp(data, "fail", 4)) {
+		return SSDB_IS_FAIL;
+	}
+
+	return SSDB_IS_CLIENT_ERROR;
+}
+
+//把已解析完的响应从接收缓冲区移交给ssdb_response
+static void ssdb_response_take_arena(SSDBResponse *ssdb_response, SSDBSock *ssdb_sock, size_t total) {
+	if (ssdb_sock->rbuf_pos + total == ssdb_sock->rbuf_len
+			&& total > SSDB_SOCK_READ_BUF_SIZE) {
+		//大响应且无残留数据,直接接管接收缓冲区
+		ssdb_response->arena = ssdb_sock->rbuf;
+		ssdb_response->data  = ssdb_sock->rbuf + ssdb_sock->rbuf_pos;
+		ssdb_sock->rbuf      = NULL;
+		ssdb_sock->rbuf_size = 0;
+		ssdb_sock->rbuf_pos  = 0;
+		ssdb_sock->rbuf_len  = 0;
+		return;
+	}
+
+	ssdb_response->arena = emalloc(total);
+	ssdb_response->data  = ssdb_response->arena;
+	memcpy(ssdb_response->arena, ssdb_sock->rbuf + ssdb_sock->rbuf_pos, total);
 
-			if (to_read_buf[to_read_buf_total - 1] != '\n') {
+	ssdb_sock->rbuf_pos += total;
+	if (ssdb_sock->rbuf_pos == ssdb_sock->rbuf_len) {
+		ssdb_sock->rbuf_pos = 0;
+		ssdb_sock->rbuf_len = 0;
+	}
+}
+
+SSDBResponse *ssdb_sock_read(SSDBSock *ssdb_sock) {
+	SSDBResponse *ssdb_response;
+
+	//读缓存命中时没有发出命令
+	if (ssdb_sock->cache_hit) {
+		ssdb_response = ssdb_sock->cache_hit;
+		ssdb_sock->cache_hit = NULL;
+		return ssdb_response;
+	}
+
+	if (ssdb_sock->route_index < 0) {
+		//先读掉noreply命令的响应
+		ssdb_sock_discard(ssdb_sock);
+		ssdb_response = ssdb_sock_read_response(ssdb_sock);
+	} else {
+		ssdb_response = ssdb_sock_read_response(ssdb_sock);
+		ssdb_route_finish(ssdb_sock, ssdb_response != NULL);
+	}
+
+	if (ssdb_sock->cache_store) {
+		ssdb_read_cache_store(ssdb_sock, ssdb_response);
+	}
+
+	return ssdb_response;
+}
+
+//读取并丢弃pending_discard个响应,只在master连接上调用
+void ssdb_sock_discard(SSDBSock *ssdb_sock) {
+	while (ssdb_sock->pending_discard > 0) {
+		ssdb_sock->pending_discard--;
+		ssdb_response_free(ssdb_sock_read_response(ssdb_sock));
+	}
+}
+
+static SSDBResponse *ssdb_sock_read_response(SSDBSock *ssdb_sock) {
+	//缓冲区中已有数据时不做EOF检测,避免误判重连;只读连接不重连
+	if (ssdb_sock->rbuf_pos == ssdb_sock->rbuf_len
+			&& ssdb_sock->route_index < 0
+			&& -1 == ssdb_check_eof(ssdb_sock)) {
+		return NULL;
+	}
+
+	SSDBResponse *ssdb_response = ssdb_response_create();
+
+	//offset为相对于rbuf_pos(本响应起始位置)的解析进度,rbuf_pos在解析过程中只会因压缩缓冲区而变化
+	size_t offset = 0;
+
+	while (1) {
+		size_t avail = ssdb_sock->rbuf_len - ssdb_sock->rbuf_pos - offset;
+		char *line = ssdb_sock->rbuf + ssdb_sock->rbuf_pos + offset;
+		const char *nl = ssdb_find_nl(line, avail);
+
+		if (nl == NULL) {
+			if (ssdb_sock_fill(ssdb_sock, offset + avail + 1) < 0) {
 				break;
 			}
+			continue;
+		}
 
-			to_read_buf[to_read_buf_total - 1] = '\0';
+		size_t line_len = nl - line;
+		if (0 == line_len) {
+			//空行为响应结束
+			if (ssdb_response->status == SSDB_IS_DEFAULT) {
+				break;
+			}
+			SSDB_DEBUG_LOG("read sock end\n");
+			ssdb_response_take_arena(ssdb_response, ssdb_sock, offset + 1);
+			return ssdb_response;
+		}
 
-			SSDB_DEBUG_LOG("read sock all data %s on step second\n", to_read_buf);
+		size_t block_len;
+		if (ssdb_parse_len(line, line_len, &block_len) < 0) {
+			break;
+		}
 
-			if (ssdb_response->status == SSDB_IS_DEFAULT) {
-				if (0 == strcmp(to_read_buf, "ok")) {
-					ssdb_response->status = SSDB_IS_OK;
-				} else if (0 == strcmp(to_read_buf, "not_found")) {
-					ssdb_response->status = SSDB_IS_NOT_FOUND;
-				} else if (0 == strcmp(to_read_buf, "error")) {
-					ssdb_response->status = SSDB_IS_ERROR;
-				} else if (0 == strcmp(to_read_buf, "fail")) {
-					ssdb_response->status = SSDB_IS_FAIL;
-				} else {
-					ssdb_response->status = SSDB_IS_CLIENT_ERROR;
-				}
-			} else {
-				ssdb_response_add_block(ssdb_response, to_read_buf, to_read_buf_total - 1);
+		size_t need = line_len + 1 + block_len + 1;
+		if (avail < need) {
+			if (ssdb_sock_fill(ssdb_sock, offset + need) < 0) {
+				break;
 			}
+			continue;
+		}
 
-			expect_read_num = 1;
-			read_step = 3; //switch to read len mode
-			memset(to_read_buf, '\0', to_read_buf_max);
-			to_read_buf_total = 0;
-    	}
-    }
+		char *data = line + line_len + 1;
+		if (data[block_len] != '\n') {
+			break;
+		}
 
-    efree(to_read_buf);
+		//原地截断,块数据可直接当作C字符串使用
+		data[block_len] = '\0';
 
-    if (ssdb_response->status == SSDB_IS_DEFAULT) {
-    	ssdb_response_free(ssdb_response);
-    	return NULL;
-    }
+		SSDB_DEBUG_LOG("read sock block len %zu\n", block_len);
+
+		if (ssdb_response->status == SSDB_IS_DEFAULT) {
+			ssdb_response->status = ssdb_response_parse_status(data, block_len);
+		} else {
+			ssdb_response_add_block(ssdb_response, offset + line_len + 1, block_len);
+		}
 
-    return ssdb_response;
+		offset += need;
+	}
+
+	//协议错误或连接中断,丢弃残留数据
+	ssdb_sock->rbuf_pos = 0;
+	ssdb_sock->rbuf_len = 0;
+	ssdb_response_free(ssdb_response);
+
+	return NULL;
 }
 
 int ssdb_sock_write(SSDBSock *ssdb_sock, char *cmd, size_t sz) {
@@ -604,6 +1595,30 @@ int ssdb_sock_write(SSDBSock *ssdb_sock, char *cmd, size_t sz) {
 		return -1;
 	}
 
+	if (ssdb_sock->cmd_defer) {
+		ssdb_defer_append(ssdb_sock, cmd, sz);
+		return sz;
+	}
+
+	if (ssdb_sock->pipeline) {
+		smart_str_appendl(&ssdb_sock->wbuf, cmd, sz);
+		return sz;
+	}
+
+	//batch中已合并的读命令先于本命令发出
+	ssdb_batch_settle(ssdb_sock TSRMLS_CC);
+
+	//只读连接写入失败时改发master
+	if (ssdb_sock->route_index >= 0) {
+		if (php_stream_write(ssdb_sock->stream, cmd, sz) == sz) {
+			return sz;
+		}
+		ssdb_route_finish(ssdb_sock, 0);
+	}
+
+	//先读出预取的响应,保证后续读取与本次请求对应
+	ssdb_prefetch_settle(ssdb_sock);
+
     if (-1 == ssdb_check_eof(ssdb_sock)) {
         return -1;
     }
@@ -611,6 +1626,446 @@ int ssdb_sock_write(SSDBSock *ssdb_sock, char *cmd, size_t sz) {
     return php_stream_write(ssdb_sock->stream, cmd, sz);
 }
 
+#ifndef PHP_WIN32
+//按segment写出,处理部分写入
+static ssize_t ssdb_stream_writev(php_stream *stream, SSDBWriteVec *vec) {
+	struct iovec iov[SSDB_WRITEV_IOV_MAX];
+	php_netstream_data_t *sock = (php_netstream_data_t *) stream->abstract;
+	size_t written = 0, skip = 0;
+	int seg = 0;
+
+	while (seg < vec->num) {
+		int iov_num = 0, i;
+		size_t first_skip = skip;
+		ssize_t n;
+
+		for (i = seg; i < vec->num && iov_num < SSDB_WRITEV_IOV_MAX; i++, iov_num++) {
+			iov[iov_num].iov_base = (char *) SSDB_WVEC_SEGMENT_DATA(vec, i) + (i == seg ? first_skip : 0);
+			iov[iov_num].iov_len  = vec->segs[i].len - (i == seg ? first_skip : 0);
+		}
+
+		n = writev(sock->socket, iov, iov_num);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+
+		written += n;
+
+		//跳过已写完的segment
+		while (n > 0 && seg < vec->num) {
+			size_t left = vec->segs[seg].len - skip;
+			if ((size_t) n >= left) {
+				n -= left;
+				seg++;
+				skip = 0;
+			} else {
+				skip += n;
+				n = 0;
+			}
+		}
+	}
+
+	return written;
+}
+#endif
+
+static int ssdb_stream_write_vec(php_stream *stream, SSDBWriteVec *vec) {
+	char *cmd = NULL;
+	int cmd_len, ret;
+
+#ifndef PHP_WIN32
+	if (php_stream_is(stream, PHP_STREAM_IS_SOCKET)) {
+		return ssdb_stream_writev(stream, vec) == (ssize_t) vec->total ? vec->total : -1;
+	}
+#endif
+
+	cmd_len = ssdb_wvec_flatten(vec, &cmd);
+	ret = php_stream_write(stream, cmd, cmd_len) == cmd_len ? cmd_len : -1;
+	efree(cmd);
+
+	return ret;
+}
+
+//与ssdb_sock_write相同,大的值直接从原始内存写出
+int ssdb_sock_writev(SSDBSock *ssdb_sock, SSDBWriteVec *vec) {
+	char *cmd = NULL;
+	int cmd_len, ret;
+
+	if (ssdb_sock && ssdb_sock->status == SSDB_SOCK_STATUS_DISCONNECTED) {
+		zend_throw_exception(ssdb_exception_ce, "Connection closed", 0 TSRMLS_CC);
+		return -1;
+	}
+
+	//pipeline和defer需要缓存命令,只能复制
+	if (ssdb_sock->pipeline || ssdb_sock->cmd_defer || vec->num == 1) {
+		cmd_len = ssdb_wvec_flatten(vec, &cmd);
+		ret = ssdb_sock_write(ssdb_sock, cmd, cmd_len);
+		efree(cmd);
+		return ret;
+	}
+
+	ssdb_batch_settle(ssdb_sock TSRMLS_CC);
+
+	if (ssdb_sock->route_index >= 0) {
+		if (ssdb_stream_write_vec(ssdb_sock->stream, vec) >= 0) {
+			return vec->total;
+		}
+		ssdb_route_finish(ssdb_sock, 0);
+	}
+
+	//先读出预取的响应,保证后续读取与本次请求对应
+	ssdb_prefetch_settle(ssdb_sock);
+
+    if (-1 == ssdb_check_eof(ssdb_sock)) {
+        return -1;
+    }
+
+    return ssdb_stream_write_vec(ssdb_sock->stream, vec);
+}
+
+//写命令开始前调用,defer()时缓存命令,OPT_NOREPLY或noreply()时不等待响应
+void ssdb_noreply_begin(SSDBSock *ssdb_sock) {
+	ssdb_sock->cmd_defer   = ssdb_sock->defer_once && !ssdb_sock->pipeline;
+	ssdb_sock->cmd_noreply = (ssdb_sock->noreply || ssdb_sock->noreply_once) && !ssdb_sock->pipeline && !ssdb_sock->cmd_defer;
+}
+
+//断开连接或请求结束前发出defer的命令并读掉noreply命令的响应,连接已断开时不再重连
+void ssdb_sock_finish(SSDBSock *ssdb_sock) {
+	if ((ssdb_sock->defer_num == 0 && ssdb_sock->pending_discard == 0)
+			|| ssdb_sock->status != SSDB_SOCK_STATUS_CONNECTED
+			|| ssdb_sock->route_index >= 0
+			|| ssdb_sock->stream == NULL
+			|| php_stream_eof(ssdb_sock->stream)) {
+		return;
+	}
+
+	ssdb_defer_flush(ssdb_sock);
+	ssdb_sock_discard(ssdb_sock);
+}
+
+static void ssdb_defer_push(SSDBSock *ssdb_sock, SSDBDeferred *deferred) {
+	deferred->next = NULL;
+
+	if (ssdb_sock->defer_tail) {
+		ssdb_sock->defer_tail->next = deferred;
+	} else {
+		ssdb_sock->defer_head = deferred;
+	}
+	ssdb_sock->defer_tail = deferred;
+	ssdb_sock->defer_num++;
+}
+
+//不能合并的命令按原样缓存,之前的incr不能再与之后的合并,保证执行顺序
+void ssdb_defer_append(SSDBSock *ssdb_sock, const char *cmd, int cmd_len) {
+	SSDBDeferred *deferred = emalloc(sizeof(SSDBDeferred));
+
+	deferred->cmd     = estrndup(cmd, cmd_len);
+	deferred->cmd_len = cmd_len;
+	deferred->argv    = NULL;
+	deferred->argc    = 0;
+	ssdb_defer_push(ssdb_sock, deferred);
+
+	if (ssdb_sock->defer_index) {
+		zend_hash_clean(ssdb_sock->defer_index);
+	}
+}
+
+//argv[argc - 1]为累加值,其余参数相同的命令合并为一条
+void ssdb_defer_sum(SSDBSock *ssdb_sock, const SSDBArg *argv, int argc) {
+	SSDBDeferred *deferred, **found;
+	smart_str key = {0};
+	size_t size = argc * sizeof(SSDBArg);
+	char *data;
+	int i;
+
+	for (i = 0; i < argc - 1; i++) {
+		smart_str_appendl(&key, (const char *) &argv[i].len, sizeof(int));
+		smart_str_appendl(&key, argv[i].str, argv[i].len);
+		size += argv[i].len;
+	}
+
+	if (ssdb_sock->defer_index == NULL) {
+		ALLOC_HASHTABLE(ssdb_sock->defer_index);
+		zend_hash_init(ssdb_sock->defer_index, 16, NULL, NULL, 0);
+	} else if (zend_hash_find(ssdb_sock->defer_index, key.c, key.len, (void **) &found) == SUCCESS) {
+		(*found)->argv[argc - 1].lval += argv[argc - 1].lval;
+		smart_str_free(&key);
+		return;
+	}
+
+	//参数和字符串放在同一块内存中
+	deferred = emalloc(sizeof(SSDBDeferred));
+	deferred->cmd     = NULL;
+	deferred->cmd_len = 0;
+	deferred->argv    = emalloc(size);
+	deferred->argc    = argc;
+	memcpy(deferred->argv, argv, argc * sizeof(SSDBArg));
+
+	data = (char *) (deferred->argv + argc);
+	for (i = 0; i < argc - 1; i++) {
+		memcpy(data, argv[i].str, argv[i].len);
+		deferred->argv[i].str = data;
+		data += argv[i].len;
+	}
+
+	ssdb_defer_push(ssdb_sock, deferred);
+	zend_hash_add(ssdb_sock->defer_index, key.c, key.len, &deferred, sizeof(SSDBDeferred *), NULL);
+	smart_str_free(&key);
+}
+
+//一次写出全部缓存的命令,响应按noreply处理,返回发送的命令数
+int ssdb_defer_flush(SSDBSock *ssdb_sock) {
+	SSDBDeferred *deferred;
+	smart_str buf = {0};
+	HashTable *keys;
+	HashPosition pos;
+	char *cmd, *key;
+	uint key_len;
+	ulong idx;
+	int cmd_len, num = ssdb_sock->defer_num, ret;
+
+	if (num == 0 || ssdb_sock->pipeline) {
+		return 0;
+	}
+
+	for (deferred = ssdb_sock->defer_head; deferred != NULL; deferred = deferred->next) {
+		if (deferred->cmd) {
+			smart_str_appendl(&buf, deferred->cmd, deferred->cmd_len);
+		} else {
+			cmd_len = ssdb_cmd_format_argv(ssdb_sock, &cmd, deferred->argv, deferred->argc);
+			smart_str_appendl(&buf, cmd, cmd_len);
+			efree(cmd);
+		}
+	}
+
+	keys = ssdb_sock->defer_keys;
+	ssdb_sock->defer_keys = NULL;
+	ssdb_defer_reset(ssdb_sock);
+
+	//与noreply命令相同,不等待之前的响应
+	ssdb_sock->cmd_defer   = 0;
+	ssdb_sock->cmd_noreply = 1;
+	ret = ssdb_sock_write(ssdb_sock, buf.c, buf.len);
+	ssdb_sock->cmd_noreply = 0;
+	smart_str_free(&buf);
+
+	if (keys) {
+		for (zend_hash_internal_pointer_reset_ex(keys, &pos);
+				zend_hash_get_current_key_ex(keys, &key, &key_len, &idx, 0, &pos) == HASH_KEY_IS_STRING;
+				zend_hash_move_forward_ex(keys, &pos)) {
+			ssdb_read_cache_drop(ssdb_sock, key, key_len);
+		}
+		zend_hash_destroy(keys);
+		FREE_HASHTABLE(keys);
+	}
+
+	if (ret < 0) {
+		return -1;
+	}
+
+	ssdb_sock->pending_discard += num;
+
+	return num;
+}
+
+void ssdb_defer_reset(SSDBSock *ssdb_sock) {
+	SSDBDeferred *deferred = ssdb_sock->defer_head;
+
+	while (deferred != NULL) {
+		SSDBDeferred *next = deferred->next;
+		if (deferred->cmd) efree(deferred->cmd);
+		if (deferred->argv) efree(deferred->argv);
+		efree(deferred);
+		deferred = next;
+	}
+
+	if (ssdb_sock->defer_index) {
+		zend_hash_destroy(ssdb_sock->defer_index);
+		FREE_HASHTABLE(ssdb_sock->defer_index);
+	}
+
+	if (ssdb_sock->defer_keys) {
+		zend_hash_destroy(ssdb_sock->defer_keys);
+		FREE_HASHTABLE(ssdb_sock->defer_keys);
+	}
+
+	ssdb_sock->defer_head  = NULL;
+	ssdb_sock->defer_tail  = NULL;
+	ssdb_sock->defer_num   = 0;
+	ssdb_sock->defer_index = NULL;
+	ssdb_sock->defer_keys  = NULL;
+}
+
+//key有尚未发出的defer写命令时不缓存读取结果
+int ssdb_defer_pending(SSDBSock *ssdb_sock, const char *key, int key_len) {
+	return ssdb_sock->defer_keys && zend_hash_exists(ssdb_sock->defer_keys, (char *) key, key_len);
+}
+
+void ssdb_reply_queue(SSDBSock *ssdb_sock, ssdb_reply_type type, int filter_prefix, int unserialize, int convert_type) {
+	SSDBReply *reply = emalloc(sizeof(SSDBReply));
+
+	reply->type          = type;
+	reply->filter_prefix = filter_prefix;
+	reply->unserialize   = unserialize;
+	reply->convert_type  = convert_type;
+	reply->next          = NULL;
+
+	if (ssdb_sock->reply_tail == NULL) {
+		ssdb_sock->reply_head = reply;
+	} else {
+		ssdb_sock->reply_tail->next = reply;
+	}
+	ssdb_sock->reply_tail = reply;
+	ssdb_sock->reply_num++;
+}
+
+void ssdb_pipeline_begin(SSDBSock *ssdb_sock) {
+	if (ssdb_sock->pipeline) {
+		return;
+	}
+
+	ssdb_sock->pipeline = 1;
+	ssdb_sock->wbuf.len = 0;
+}
+
+void ssdb_pipeline_discard(SSDBSock *ssdb_sock) {
+	SSDBReply *reply = ssdb_sock->reply_head;
+	while (reply != NULL) {
+		SSDBReply *next = reply->next;
+		efree(reply);
+		reply = next;
+	}
+
+	ssdb_sock->reply_head = NULL;
+	ssdb_sock->reply_tail = NULL;
+	ssdb_sock->reply_num  = 0;
+	ssdb_sock->pipeline   = 0;
+	smart_str_free(&ssdb_sock->wbuf);
+}
+
+static void ssdb_reply_read(SSDBSock *ssdb_sock, SSDBReply *reply, zval *z TSRMLS_DC) {
+	switch (reply->type) {
+		case SSDB_REPLY_BOOL:
+			ssdb_bool_response(0, z, NULL, NULL, 1 TSRMLS_CC, ssdb_sock);
+			break;
+		case SSDB_REPLY_STRING:
+			ssdb_string_response(0, z, NULL, NULL, 1 TSRMLS_CC, ssdb_sock);
+			break;
+		case SSDB_REPLY_LONG:
+			ssdb_long_number_response(0, z, NULL, NULL, 1 TSRMLS_CC, ssdb_sock);
+			break;
+		case SSDB_REPLY_DOUBLE:
+			ssdb_double_number_response(0, z, NULL, NULL, 1 TSRMLS_CC, ssdb_sock);
+			break;
+		case SSDB_REPLY_LIST:
+			ssdb_list_response(0, z, NULL, NULL, 1 TSRMLS_CC, ssdb_sock, reply->filter_prefix, reply->unserialize);
+			break;
+		case SSDB_REPLY_MAP:
+			ssdb_map_response(0, z, NULL, NULL, 1 TSRMLS_CC, ssdb_sock, reply->filter_prefix, reply->unserialize, reply->convert_type);
+			break;
+	}
+}
+
+//一次写出所有缓存的命令,再按顺序读取全部响应
+void ssdb_pipeline_exec(SSDBSock *ssdb_sock, zval *return_value TSRMLS_DC) {
+	SSDBReply *reply;
+	int write_failed = 0;
+
+	ssdb_sock->pipeline = 0;
+	array_init_size(return_value, ssdb_sock->reply_num);
+
+	if (ssdb_sock->wbuf.len > 0
+			&& ssdb_sock_write(ssdb_sock, ssdb_sock->wbuf.c, ssdb_sock->wbuf.len) < 0) {
+		write_failed = 1;
+	}
+
+	for (reply = ssdb_sock->reply_head; reply != NULL; reply = reply->next) {
+		zval *z;
+		MAKE_STD_ZVAL(z);
+		ZVAL_NULL(z);
+		if (!write_failed) {
+			ssdb_reply_read(ssdb_sock, reply, z TSRMLS_CC);
+		}
+		add_next_index_zval(return_value, z);
+	}
+
+	ssdb_pipeline_discard(ssdb_sock);
+}
+
+int ssdb_prefetch_begin(SSDBSock *ssdb_sock, void *owner, char *cmd, size_t sz) {
+	if (ssdb_sock->pipeline
+			|| ssdb_sock->prefetch_owner != NULL
+			|| ssdb_sock->status != SSDB_SOCK_STATUS_CONNECTED) {
+		return -1;
+	}
+
+	if (ssdb_sock_write(ssdb_sock, cmd, sz) < 0) {
+		return -1;
+	}
+
+	ssdb_sock->prefetch_owner = owner;
+	ssdb_sock->prefetch_pending = 1;
+
+	return 0;
+}
+
+//取回owner的预取响应,没有可用的预取时返回-1
+int ssdb_prefetch_take(SSDBSock *ssdb_sock, void *owner, SSDBResponse **ssdb_response) {
+	if (owner == NULL || ssdb_sock->prefetch_owner != owner) {
+		return -1;
+	}
+
+	if (ssdb_sock->prefetch_pending) {
+		*ssdb_response = ssdb_sock_read(ssdb_sock);
+	} else {
+		*ssdb_response = ssdb_sock->prefetch_parked;
+	}
+
+	ssdb_sock->prefetch_owner = NULL;
+	ssdb_sock->prefetch_pending = 0;
+	ssdb_sock->prefetch_parked = NULL;
+
+	return *ssdb_response == NULL ? -1 : 0;
+}
+
+void ssdb_prefetch_release(SSDBSock *ssdb_sock, void *owner) {
+	if (owner == NULL || ssdb_sock->prefetch_owner != owner) {
+		return;
+	}
+
+	if (ssdb_sock->prefetch_pending) {
+		ssdb_sock->pending_discard++;
+	}
+
+	ssdb_response_free(ssdb_sock->prefetch_parked);
+	ssdb_sock->prefetch_owner = NULL;
+	ssdb_sock->prefetch_pending = 0;
+	ssdb_sock->prefetch_parked = NULL;
+}
+
+void ssdb_prefetch_settle(SSDBSock *ssdb_sock) {
+	//noreply命令不等待之前的响应,留到下一次读取时丢弃
+	if (!ssdb_sock->cmd_noreply) {
+		ssdb_sock_discard(ssdb_sock);
+	}
+
+	if (ssdb_sock->prefetch_pending) {
+		ssdb_sock->prefetch_pending = 0;
+		ssdb_sock->prefetch_parked = ssdb_sock_read(ssdb_sock);
+	}
+}
+
+void ssdb_prefetch_reset(SSDBSock *ssdb_sock) {
+	ssdb_response_free(ssdb_sock->prefetch_parked);
+	ssdb_sock->prefetch_owner = NULL;
+	ssdb_sock->prefetch_pending = 0;
+	ssdb_sock->prefetch_parked = NULL;
+	ssdb_sock->pending_discard = 0;
+}
+
 int resend_auth(SSDBSock *ssdb_sock) {
     char *cmd;
     int cmd_len;
@@ -629,7 +2084,7 @@ int resend_auth(SSDBSock *ssdb_sock) {
 		return -1;
 	}
 
-    if (0 != strcmp(ssdb_response->block->data, "ok")) {
+    if (ssdb_response->num == 0 || 0 != strcmp(SSDB_RESPONSE_BLOCK_DATA(ssdb_response, 0), "ok")) {
     	ssdb_response_free(ssdb_response);
         return -1;
     }
@@ -639,7 +2094,7 @@ int resend_auth(SSDBSock *ssdb_sock) {
     return 0;
 }
 
-int ssdb_serialize(SSDBSock *ssdb_sock, zval *z, char **val, int *val_len) {
+static int ssdb_serialize_value(SSDBSock *ssdb_sock, zval *z, char **val, int *val_len) {
 #if ZEND_MODULE_API_NO >= 20100000
 	php_serialize_data_t ht;
 #else
@@ -706,16 +2161,45 @@ int ssdb_serialize(SSDBSock *ssdb_sock, zval *z, char **val, int *val_len) {
 #endif
 			return 0;
 			break;
+		case SSDB_SERIALIZER_MSGPACK:
+			return ssdb_msgpack_encode(z, val, val_len TSRMLS_CC);
 	}
 
 	return 0;
 }
 
+//序列化之后不小于阈值的值再压缩,返回1时val由调用者释放
+int ssdb_serialize(SSDBSock *ssdb_sock, zval *z, char **val, int *val_len) {
+	int val_free = ssdb_serialize_value(ssdb_sock, z, val, val_len);
+	char *packed;
+	int packed_len;
+
+	if (ssdb_sock->compression == SSDB_COMPRESSION_NONE) {
+		return val_free;
+	}
+
+	//未压缩但首字节与压缩头相同的值加转义头,读取时不会被误解压
+	if ((*val_len >= ssdb_sock->compression_threshold
+				&& ssdb_compress(ssdb_sock->compression, *val, *val_len, &packed, &packed_len))
+			|| ssdb_compress_escape(*val, *val_len, &packed, &packed_len)) {
+		if (val_free) efree(*val);
+		*val = packed;
+		*val_len = packed_len;
+		return 1;
+	}
+
+	return val_free;
+}
+
 int ssdb_unserialize(SSDBSock *ssdb_sock, const char *val, int val_len, zval **return_value) {
+	return ssdb_unserialize_by(ssdb_sock->serializer, ssdb_sock->compression, val, val_len, return_value);
+}
+
+static int ssdb_unserialize_value(int serializer, const char *val, int val_len, zval **return_value) {
 	php_unserialize_data_t var_hash;
 	int ret, rv_free = 0;
 
-	switch(ssdb_sock->serializer) {
+	switch(serializer) {
 		case SSDB_SERIALIZER_NONE:
 			return 0;
 		case SSDB_SERIALIZER_PHP:
@@ -753,12 +2237,43 @@ int ssdb_unserialize(SSDBSock *ssdb_sock, const char *val, int val_len, zval **r
 #endif
 			return 0;
 			break;
+		case SSDB_SERIALIZER_MSGPACK:
+			return ssdb_msgpack_decode(val, val_len, return_value TSRMLS_CC);
 	}
 
 	return 0;
 }
 
+//压缩过的值先解压;未序列化的值解压后直接作为字符串返回
+int ssdb_unserialize_by(int serializer, int compression, const char *val, int val_len, zval **return_value) {
+	zval *rv = *return_value;
+	char *plain;
+	int plain_len;
+
+	//未开启压缩时不识别压缩头,值按原样处理
+	if (compression == SSDB_COMPRESSION_NONE
+			|| !ssdb_decompress(val, val_len, &plain, &plain_len)) {
+		return ssdb_unserialize_value(serializer, val, val_len, return_value);
+	}
+
+	if (ssdb_unserialize_value(serializer, plain, plain_len, return_value)) {
+		efree(plain);
+		return 1;
+	}
+
+	*return_value = rv;
+	if (!*return_value) {
+		MAKE_STD_ZVAL(*return_value);
+	}
+	ZVAL_STRINGL(*return_value, plain, plain_len, 0);
+
+	return 1;
+}
+
 void ssdb_bool_response(INTERNAL_FUNCTION_PARAMETERS, SSDBSock *ssdb_sock) {
+	SSDB_PIPELINE_QUEUE_REPLY(ssdb_sock, SSDB_REPLY_BOOL, 0, 0, 0);
+	SSDB_NOREPLY_DISCARD_REPLY(ssdb_sock);
+
 	SSDBResponse *ssdb_response = ssdb_sock_read(ssdb_sock);
 	if (ssdb_response == NULL
 			|| ssdb_response->status != SSDB_IS_OK) {
@@ -768,7 +2283,7 @@ void ssdb_bool_response(INTERNAL_FUNCTION_PARAMETERS, SSDBSock *ssdb_sock) {
 
 	//qset只返回2\nok\n\n
 	if (ssdb_response->num > 0
-			&& 0 == strcmp(ssdb_response->block->data, "0")) {
+			&& 0 == strcmp(SSDB_RESPONSE_BLOCK_DATA(ssdb_response, 0), "0")) {
 		RETVAL_FALSE;
 	} else {
 		RETVAL_TRUE;
@@ -778,47 +2293,59 @@ void ssdb_bool_response(INTERNAL_FUNCTION_PARAMETERS, SSDBSock *ssdb_sock) {
 }
 
 void ssdb_string_response(INTERNAL_FUNCTION_PARAMETERS, SSDBSock *ssdb_sock) {
+    SSDB_PIPELINE_QUEUE_REPLY(ssdb_sock, SSDB_REPLY_STRING, 0, 0, 0);
+
     SSDBResponse *ssdb_response = ssdb_sock_read(ssdb_sock);
     if (ssdb_response == NULL
-    		|| ssdb_response->status != SSDB_IS_OK) {
+    		|| ssdb_response->status != SSDB_IS_OK
+			|| ssdb_response->num == 0) {
     	ssdb_response_free(ssdb_response);
         RETURN_NULL();
     }
 
-    if (ssdb_unserialize(ssdb_sock, ssdb_response->block->data, ssdb_response->block->len, &return_value) == 0) {
-    	RETVAL_STRINGL(ssdb_response->block->data, ssdb_response->block->len, 1);
+    if (ssdb_unserialize(ssdb_sock, SSDB_RESPONSE_BLOCK_DATA(ssdb_response, 0), SSDB_RESPONSE_BLOCK_LEN(ssdb_response, 0), &return_value) == 0) {
+    	RETVAL_STRINGL(SSDB_RESPONSE_BLOCK_DATA(ssdb_response, 0), SSDB_RESPONSE_BLOCK_LEN(ssdb_response, 0), 1);
 	}
 
     ssdb_response_free(ssdb_response);
 }
 
 void ssdb_long_number_response(INTERNAL_FUNCTION_PARAMETERS, SSDBSock *ssdb_sock) {
+	SSDB_PIPELINE_QUEUE_REPLY(ssdb_sock, SSDB_REPLY_LONG, 0, 0, 0);
+	SSDB_NOREPLY_DISCARD_REPLY(ssdb_sock);
+
 	SSDBResponse *ssdb_response = ssdb_sock_read(ssdb_sock);
 	if (ssdb_response == NULL
-			|| ssdb_response->status != SSDB_IS_OK) {
+			|| ssdb_response->status != SSDB_IS_OK
+			|| ssdb_response->num == 0) {
 		ssdb_response_free(ssdb_response);
 		RETURN_NULL();
 	}
 
-	RETVAL_LONG(atof(ssdb_response->block->data));
+	RETVAL_LONG(ZEND_STRTOL(SSDB_RESPONSE_BLOCK_DATA(ssdb_response, 0), NULL, 10));
 
 	ssdb_response_free(ssdb_response);
 }
 
 void ssdb_double_number_response(INTERNAL_FUNCTION_PARAMETERS, SSDBSock *ssdb_sock) {
+	SSDB_PIPELINE_QUEUE_REPLY(ssdb_sock, SSDB_REPLY_DOUBLE, 0, 0, 0);
+
 	SSDBResponse *ssdb_response = ssdb_sock_read(ssdb_sock);
 	if (ssdb_response == NULL
-			|| ssdb_response->status != SSDB_IS_OK) {
+			|| ssdb_response->status != SSDB_IS_OK
+			|| ssdb_response->num == 0) {
 		ssdb_response_free(ssdb_response);
 		RETURN_NULL();
 	}
 
-	RETVAL_DOUBLE(atof(ssdb_response->block->data));
+	RETVAL_DOUBLE(atof(SSDB_RESPONSE_BLOCK_DATA(ssdb_response, 0)));
 
 	ssdb_response_free(ssdb_response);
 }
 
 void ssdb_list_response(INTERNAL_FUNCTION_PARAMETERS, SSDBSock *ssdb_sock, int filter_prefix, int unserialize) {
+    SSDB_PIPELINE_QUEUE_REPLY(ssdb_sock, SSDB_REPLY_LIST, filter_prefix, unserialize, 0);
+
     SSDBResponse *ssdb_response = ssdb_sock_read(ssdb_sock);
     if (ssdb_response == NULL
     		|| ssdb_response->status != SSDB_IS_OK) {
@@ -826,40 +2353,115 @@ void ssdb_list_response(INTERNAL_FUNCTION_PARAMETERS, SSDBSock *ssdb_sock, int f
         RETURN_NULL();
     }
 
+    if (ssdb_sock->result_set) {
+    	ssdb_result_set_init(return_value, ssdb_sock, ssdb_response, SSDB_RESULT_SET_LIST, filter_prefix, unserialize, SSDB_CONVERT_TO_STRING TSRMLS_CC);
+    	return;
+    }
+
+    int i;
     array_init_size(return_value, ssdb_response->num);
-    SSDBResponseBlock *ssdb_response_block = ssdb_response->block;
-    while (ssdb_response_block != NULL) {
+
+    //不过滤前缀也不反序列化时,按下标直接写入
+    if ((filter_prefix != SSDB_FILTER_KEY_PREFIX || ssdb_sock->prefix == NULL)
+    		&& unserialize != SSDB_UNSERIALIZE) {
+    	for (i = 0; i < ssdb_response->num; i++) {
+    		zval *z;
+    		MAKE_STD_ZVAL(z);
+    		ZVAL_STRINGL(z, SSDB_RESPONSE_BLOCK_DATA(ssdb_response, i), SSDB_RESPONSE_BLOCK_LEN(ssdb_response, i), 1);
+    		zend_hash_index_update(Z_ARRVAL_P(return_value), i, &z, sizeof(zval *), NULL);
+    	}
+
+    	ssdb_response_free(ssdb_response);
+    	return;
+    }
+
+    for (i = 0; i < ssdb_response->num; i++) {
     	zval *z = NULL;
+    	char *data = SSDB_RESPONSE_BLOCK_DATA(ssdb_response, i);
+    	size_t len = SSDB_RESPONSE_BLOCK_LEN(ssdb_response, i);
+
     	if (filter_prefix == SSDB_FILTER_KEY_PREFIX
     			&& ssdb_sock->prefix
-				&& 0 == strncmp(ssdb_response_block->data, ssdb_sock->prefix, ssdb_sock->prefix_len)) {
-    		if (unserialize == SSDB_UNSERIALIZE_NONE) {
-    			add_next_index_string(return_value, ssdb_response_block->data + ssdb_sock->prefix_len, 1);
-    		} else {
-    			if (ssdb_unserialize(ssdb_sock, ssdb_response_block->data + ssdb_sock->prefix_len, ssdb_response_block->len - ssdb_sock->prefix_len, &z)) {
-    				add_next_index_zval(return_value, z);
-    			} else {
-    				add_next_index_string(return_value, ssdb_response_block->data + ssdb_sock->prefix_len, 1);
-    			}
-    		}
+				&& len >= (size_t)ssdb_sock->prefix_len
+				&& 0 == memcmp(data, ssdb_sock->prefix, ssdb_sock->prefix_len)) {
+    		data += ssdb_sock->prefix_len;
+    		len  -= ssdb_sock->prefix_len;
+    	}
+
+    	if (unserialize == SSDB_UNSERIALIZE
+    			&& ssdb_unserialize(ssdb_sock, data, len, &z)) {
+    		add_next_index_zval(return_value, z);
     	} else {
-    		if (unserialize == SSDB_UNSERIALIZE_NONE) {
-    			add_next_index_string(return_value, ssdb_response_block->data, 1);
-    		} else {
-    			if (ssdb_unserialize(ssdb_sock, ssdb_response_block->data, ssdb_response_block->len, &z)) {
-    				add_next_index_zval(return_value, z);
-    			} else {
-    				add_next_index_string(return_value, ssdb_response_block->data, 1);
-    			}
-    		}
+    		add_next_index_stringl(return_value, data, len, 1);
     	}
-    	ssdb_response_block = ssdb_response_block->next;
     }
 
     ssdb_response_free(ssdb_response);
 }
 
+//判断key是否为整数下标,规则与zend_symtable_update一致
+static int ssdb_hash_key_is_index(const char *key, size_t len, ulong *idx) {
+	const char *p = key, *end = key + len;
+	ulong n = 0;
+	int neg = 0;
+
+	if (len == 0 || len > MAX_LENGTH_OF_LONG - 1) {
+		return 0;
+	}
+
+	if (*p == '-') {
+		neg = 1;
+		p++;
+	}
+
+	//不允许前导0和"-0"
+	if (p == end || (*p == '0' && (end - p > 1 || neg))) {
+		return 0;
+	}
+
+	for (; p < end; p++) {
+		if (*p < '0' || *p > '9' || n > (ULONG_MAX - 9) / 10) {
+			return 0;
+		}
+		n = n * 10 + (*p - '0');
+	}
+
+	if (neg) {
+		if (n - 1 > LONG_MAX) {
+			return 0;
+		}
+		*idx = (ulong) 0 - n;
+	} else {
+		if (n > LONG_MAX) {
+			return 0;
+		}
+		*idx = n;
+	}
+
+	return 1;
+}
+
+//key必须以'\0'结尾,整数判断和hash只计算一次
+void ssdb_hash_key_init(SSDBHashKey *hk, char *key, size_t key_len) {
+	hk->key     = key;
+	hk->key_len = key_len + 1;
+	hk->index   = ssdb_hash_key_is_index(key, key_len, &hk->h);
+	if (!hk->index) {
+		hk->h = zend_inline_hash_func(key, hk->key_len);
+	}
+}
+
+void ssdb_hash_key_add(zval *arr, SSDBHashKey *hk, zval *value) {
+	if (hk->index) {
+		zend_hash_index_update(Z_ARRVAL_P(arr), hk->h, &value, sizeof(zval *), NULL);
+	} else {
+		zend_hash_quick_update(Z_ARRVAL_P(arr), hk->key, hk->key_len, hk->h, &value, sizeof(zval *), NULL);
+	}
+}
+
 void ssdb_map_response(INTERNAL_FUNCTION_PARAMETERS, SSDBSock *ssdb_sock, int filter_prefix, int unserialize, int convert_type) {
+    SSDB_PIPELINE_QUEUE_REPLY(ssdb_sock, SSDB_REPLY_MAP, filter_prefix, unserialize, convert_type);
+
     SSDBResponse *ssdb_response = ssdb_sock_read(ssdb_sock);
     if (ssdb_response == NULL
     		|| ssdb_response->status != SSDB_IS_OK
@@ -869,53 +2471,49 @@ void ssdb_map_response(INTERNAL_FUNCTION_PARAMETERS, SSDBSock *ssdb_sock, int fi
         RETURN_NULL();
     }
 
+    if (ssdb_sock->result_set) {
+    	ssdb_result_set_init(return_value, ssdb_sock, ssdb_response, SSDB_RESULT_SET_MAP, filter_prefix, unserialize, convert_type TSRMLS_CC);
+    	return;
+    }
 
-    int i = 1;
-    array_init(return_value);
-    SSDBResponseBlock *ssdb_response_block = ssdb_response->block;
-    while (ssdb_response_block != NULL) {
-    	if (0 == i % 2) {
-    		zval *z = NULL;
-    		if (filter_prefix == SSDB_FILTER_KEY_PREFIX
-					&& ssdb_sock->prefix
-					&& 0 == strncmp(ssdb_response_block->prev->data, ssdb_sock->prefix, ssdb_sock->prefix_len)) {
-    			if (unserialize == SSDB_UNSERIALIZE_NONE) {
-    				switch (convert_type) {
-    					case SSDB_CONVERT_TO_LONG:
-    						add_assoc_long(return_value, ssdb_response_block->prev->data + ssdb_sock->prefix_len, atol(ssdb_response_block->data));
-    						break;
-    					case SSDB_CONVERT_TO_STRING:
-    						add_assoc_stringl(return_value, ssdb_response_block->prev->data + ssdb_sock->prefix_len, ssdb_response_block->data, ssdb_response_block->len, 1);
-    						break;
-    				}
-    			} else {
-    				if (ssdb_unserialize(ssdb_sock, ssdb_response_block->data, ssdb_response_block->len, &z)) {
-    					add_assoc_zval(return_value, ssdb_response_block->prev->data + ssdb_sock->prefix_len, z);
-    				} else {
-    					add_assoc_stringl(return_value, ssdb_response_block->prev->data + ssdb_sock->prefix_len, ssdb_response_block->data, ssdb_response_block->len, 1);
-    				}
-    			}
-			} else {
-				if (unserialize == SSDB_UNSERIALIZE_NONE) {
-					switch (convert_type) {
-						case SSDB_CONVERT_TO_LONG:
-							add_assoc_long(return_value, ssdb_response_block->prev->data, atol(ssdb_response_block->data));
-							break;
-						case SSDB_CONVERT_TO_STRING:
-							add_assoc_stringl(return_value, ssdb_response_block->prev->data, ssdb_response_block->data, ssdb_response_block->len, 1);
-							break;
-					}
-				} else {
-					if (ssdb_unserialize(ssdb_sock, ssdb_response_block->data, ssdb_response_block->len, &z)) {
-						add_assoc_zval(return_value, ssdb_response_block->prev->data, z);
-					} else {
-						add_assoc_stringl(return_value, ssdb_response_block->prev->data, ssdb_response_block->data, ssdb_response_block->len, 1);
-					}
-				}
-			}
+    int i;
+    SSDBHashKey hk;
+    array_init_size(return_value, ssdb_response->num / 2);
+    for (i = 0; i < ssdb_response->num; i += 2) {
+    	zval *z = NULL;
+    	char *key = SSDB_RESPONSE_BLOCK_DATA(ssdb_response, i);
+    	size_t key_len = SSDB_RESPONSE_BLOCK_LEN(ssdb_response, i);
+    	char *val = SSDB_RESPONSE_BLOCK_DATA(ssdb_response, i + 1);
+    	size_t val_len = SSDB_RESPONSE_BLOCK_LEN(ssdb_response, i + 1);
+
+    	if (filter_prefix == SSDB_FILTER_KEY_PREFIX
+    			&& ssdb_sock->prefix
+				&& key_len >= (size_t)ssdb_sock->prefix_len
+				&& 0 == memcmp(key, ssdb_sock->prefix, ssdb_sock->prefix_len)) {
+    		key     += ssdb_sock->prefix_len;
+    		key_len -= ssdb_sock->prefix_len;
     	}
-    	ssdb_response_block = ssdb_response_block->next;
-    	i++;
+
+    	if (unserialize == SSDB_UNSERIALIZE_NONE) {
+    		switch (convert_type) {
+    			case SSDB_CONVERT_TO_LONG:
+    				MAKE_STD_ZVAL(z);
+    				ZVAL_LONG(z, atol(val));
+    				break;
+    			case SSDB_CONVERT_TO_STRING:
+    				MAKE_STD_ZVAL(z);
+    				ZVAL_STRINGL(z, val, val_len, 1);
+    				break;
+    			default:
+    				continue;
+    		}
+    	} else if (!ssdb_unserialize(ssdb_sock, val, val_len, &z)) {
+    		MAKE_STD_ZVAL(z);
+    		ZVAL_STRINGL(z, val, val_len, 1);
+    	}
+
+    	ssdb_hash_key_init(&hk, key, key_len);
+    	ssdb_hash_key_add(return_value, &hk, z);
     }
 
     ssdb_response_free(ssdb_response);
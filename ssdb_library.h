@@ -19,6 +19,8 @@
 #ifndef EXT_SSDB_SSDB_LIBRARY_H_
 #define EXT_SSDB_SSDB_LIBRARY_H_
 
+#include "ext/standard/php_smart_str.h"
+
 #define SSDB_SOCK_STATUS_FAILED 0
 #define SSDB_SOCK_STATUS_DISCONNECTED 1
 #define SSDB_SOCK_STATUS_UNKNOWN 2
@@ -27,6 +29,13 @@
 #define SSDB_SERIALIZER_NONE 0
 #define SSDB_SERIALIZER_PHP 1
 #define SSDB_SERIALIZER_IGBINARY 2
+#define SSDB_SERIALIZER_MSGPACK 3
+
+#define SSDB_COMPRESSION_NONE 0
+#define SSDB_COMPRESSION_LZ4 1
+#define SSDB_COMPRESSION_ZSTD 2
+#define SSDB_COMPRESSION_ZSTD_DICT 3
+#define SSDB_COMPRESSION_THRESHOLD 1024
 
 #define SSDB_FILTER_KEY_PREFIX_NONE 0
 #define SSDB_FILTER_KEY_PREFIX 1
@@ -37,18 +46,92 @@
 #define SSDB_CONVERT_TO_STRING 0
 #define SSDB_CONVERT_TO_LONG 1
 
+#define SSDB_SOCK_READ_BUF_SIZE 8192
+
 #define _NL "\n"
 
 typedef enum {SSDB_IS_DEFAULT,SSDB_IS_OK,SSDB_IS_NOT_FOUND,SSDB_IS_ERROR,SSDB_IS_FAIL,SSDB_IS_CLIENT_ERROR} ssdb_response_status;
+typedef enum {SSDB_REPLY_BOOL,SSDB_REPLY_STRING,SSDB_REPLY_LONG,SSDB_REPLY_DOUBLE,SSDB_REPLY_LIST,SSDB_REPLY_MAP} ssdb_reply_type;
 
 //#define SSDB_DEBUG_LOG(fmt, args...) php_printf(fmt, ##args);
 #define SSDB_DEBUG_LOG(fmt, args...)
+
+//长度头的最大十进制位数
+#define SSDB_MAX_LEN_DIGITS 19
+
 #define SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len) if(ssdb_sock_write(ssdb_sock, cmd, cmd_len) < 0) { \
 	efree(cmd); \
     RETURN_NULL(); \
 } \
 	efree(cmd);
 
+//大的值不复制,用writev直接发送
+#define SSDB_SOCKET_WRITEV_COMMAND(ssdb_sock, vec) if(ssdb_sock_writev(ssdb_sock, vec) < 0) { \
+	ssdb_wvec_free(vec); \
+    RETURN_NULL(); \
+} \
+	ssdb_wvec_free(vec);
+
+//只读命令,按read_policy发往只读连接
+#define SSDB_SOCKET_WRITE_READ_COMMAND(ssdb_sock, cmd, cmd_len) ssdb_route_read(ssdb_sock); \
+	SSDB_SOCKET_WRITE_COMMAND(ssdb_sock, cmd, cmd_len)
+
+//noreply模式下响应计入pending_discard,在下一个同步命令或断开连接时读取丢弃;defer的命令尚未发送.只用于bool和long响应
+#define SSDB_NOREPLY_DISCARD_REPLY(ssdb_sock) if ((ssdb_sock)->cmd_noreply || (ssdb_sock)->cmd_defer) { \
+	if ((ssdb_sock)->cmd_noreply) (ssdb_sock)->pending_discard++; \
+	(ssdb_sock)->cmd_noreply = 0; \
+	(ssdb_sock)->cmd_defer = 0; \
+	RETURN_TRUE; \
+}
+
+//pipeline模式下只登记响应处理方式,返回$this以便链式调用
+#define SSDB_PIPELINE_QUEUE_REPLY(ssdb_sock, type, filter_prefix, unserialize, convert_type) if ((ssdb_sock)->pipeline) { \
+	ssdb_reply_queue(ssdb_sock, type, filter_prefix, unserialize, convert_type); \
+	RETURN_ZVAL(getThis(), 1, 0); \
+}
+
+typedef struct _SSDBReply {
+	ssdb_reply_type type;
+	int filter_prefix;
+	int unserialize;
+	int convert_type;
+	struct _SSDBReply *next;
+} SSDBReply;
+
+#define SSDB_READ_MASTER             0
+#define SSDB_READ_ROUND_ROBIN        1
+#define SSDB_READ_LEAST_OUTSTANDING  2
+#define SSDB_READ_LATENCY            3
+
+//命令格式化用的临时内存块,每个命令开始时重置
+#define SSDB_ARENA_CHUNK_SIZE 1024
+
+typedef struct _SSDBArenaChunk {
+	struct _SSDBArenaChunk *next;
+	size_t size;
+	size_t used;
+	char data[1];
+} SSDBArenaChunk;
+
+//defer()缓存的写命令,flush或请求结束时一起发送
+typedef struct _SSDBDeferred {
+	char *cmd;                       //已格式化的命令
+	int cmd_len;
+	struct _SSDBArg *argv;           //incr/hincr/zincr等可合并的命令,最后一个参数为累加值
+	int argc;
+	struct _SSDBDeferred *next;
+} SSDBDeferred;
+
+//master之外的只读连接
+typedef struct {
+	php_stream *stream;
+	char *host;
+	long port;
+	long outstanding; //已发出未读取的请求数
+	long requests;
+	double latency;   //响应时间的移动平均,单位微秒
+} SSDBEndpoint;
+
 typedef struct {
 	php_stream *stream;
 	char *host;
@@ -66,23 +149,127 @@ typedef struct {
 	int persistent;
 	char *persistent_id;
 	int serializer;
+	int compression;                 //写入时的压缩算法,读取时按值的头部自动识别
+	int compression_threshold;       //不小于此长度的值才压缩
+	char *rbuf;
+	size_t rbuf_size;
+	size_t rbuf_pos;
+	size_t rbuf_len;
+	int pipeline;
+	smart_str wbuf;
+	SSDBReply *reply_head;
+	SSDBReply *reply_tail;
+	int reply_num;
+	int result_set;
+	int scan_prefetch;
+	void *prefetch_owner;            //已预取请求的所有者(scan迭代器)
+	int prefetch_pending;            //预取的响应尚未读取
+	struct _SSDBResponse *prefetch_parked; //其他命令插队时先读出暂存的预取响应
+	int pending_discard;             //需要读取并丢弃的响应数
+	int noreply;                     //写命令不等待响应
+	int noreply_next;                //noreply()之后的下一个命令不等待响应
+	int noreply_once;
+	int cmd_noreply;                 //当前命令的响应留给之后读取丢弃
+	int defer_next;                  //defer()之后的下一个命令先缓存
+	int defer_once;
+	int cmd_defer;                   //当前命令缓存到defer队列
+	SSDBDeferred *defer_head;
+	SSDBDeferred *defer_tail;
+	int defer_num;
+	HashTable *defer_index;          //可合并命令的参数 => SSDBDeferred*
+	HashTable *defer_keys;           //defer队列中写命令的key,发出后再使读缓存失效
+	struct _SSDBBatch *batch;        //beginBatch()之后合并的get/hget/zget
+	int read_cache;                  //请求内读缓存
+	HashTable *read_cache_keys;      //加前缀的key => HashTable(命令和其余参数 => SSDBResponse*)
+	struct _SSDBResponse *cache_hit; //命中的缓存响应,由ssdb_sock_read返回
+	char *cache_key;                 //未命中时等待写入缓存的key,在arena中
+	int cache_key_len;
+	char *cache_field;
+	int cache_field_len;
+	int cache_store;                 //命令已发出,下一个响应写入缓存
+	int cache_shm;                   //响应同时写入共享内存缓存
+	long shm_cache_ttl;              //共享内存缓存的有效秒数,0为不使用
+	char *shm_server;                //host:port,共享内存缓存按服务端区分
+	int shm_server_len;
+	char *pool_key;                  //连接池endpoint
+	char *pool_id;                   //当前使用的连接池slot
+	SSDBEndpoint *replicas;
+	int replica_num;
+	int read_policy;
+	int replica_next;
+	int route_index;                 //当前请求所在的只读连接,-1为master
+	php_stream *master_stream;
+	struct timeval route_start;
+	SSDBArenaChunk *arena;           //当前命令的临时内存
 } SSDBSock;
 
-typedef struct _SSDBResponseBlock {
-	struct _SSDBResponseBlock *prev;
-	struct _SSDBResponseBlock *next;
+typedef struct {
+	size_t offset;
 	size_t len;
-	char *data;
 } SSDBResponseBlock;
 
-typedef struct {
+//不小于此长度的值以引用方式加入写向量
+#define SSDB_WRITEV_THRESHOLD 4096
+#define SSDB_WRITEV_IOV_MAX   64
+
+typedef struct _SSDBWriteSegment {
+	const char *data; //NULL表示数据在buf中
+	size_t offset;
+	size_t len;
+} SSDBWriteSegment;
+
+typedef struct _SSDBWriteVec {
+	smart_str buf;
+	SSDBWriteSegment *segs;
+	int num;
+	int size;
+	size_t threshold;
+	size_t total;
+	char **owned;
+	int owned_num;
+	int owned_size;
+} SSDBWriteVec;
+
+#define SSDB_WVEC_SEGMENT_DATA(vec, i) ((vec)->segs[i].data ? (vec)->segs[i].data : (vec)->buf.c + (vec)->segs[i].offset)
+
+//响应数据保存在一块连续内存中,blocks只记录各段的偏移和长度
+typedef struct _SSDBResponse {
 	ssdb_response_status status;
-	SSDBResponseBlock *block;
-	SSDBResponseBlock *tail;
+	char *arena;
+	char *data;
+	SSDBResponseBlock *blocks;
 	int num;
+	int size;
 } SSDBResponse;
 
+//带类型的命令参数,数字直接编码进命令缓冲区
+typedef enum {SSDB_ARG_STRING,SSDB_ARG_LONG,SSDB_ARG_DOUBLE} ssdb_arg_type;
+
+typedef struct _SSDBArg {
+	ssdb_arg_type type;
+	const char *str;
+	int len;
+	long long lval;
+	double dval;
+} SSDBArg;
+
+#define SSDB_CMD_MAX_ARGS  16
+#define SSDB_LTOA_BUF_SIZE 32
+
+//预先计算好的hash key,key_len包含结尾的'\0'
+typedef struct _SSDBHashKey {
+	char *key;
+	uint key_len;
+	ulong h;
+	int index;
+} SSDBHashKey;
+
+#define SSDB_RESPONSE_BLOCK_DATA(ssdb_response, i) ((ssdb_response)->data + (ssdb_response)->blocks[i].offset)
+#define SSDB_RESPONSE_BLOCK_LEN(ssdb_response, i) ((ssdb_response)->blocks[i].len)
+
 extern zend_class_entry *ssdb_exception_ce;
+extern zend_class_entry *ssdb_ce;
+extern int le_ssdb_sock;
 
 SSDBSock* ssdb_create_sock(
 		char *host,
@@ -100,8 +287,15 @@ void ssdb_stream_close(SSDBSock *ssdb_sock);
 int ssdb_open_socket(SSDBSock *ssdb_sock, int force_connect);
 int ssdb_connect_socket(SSDBSock *ssdb_sock);
 int ssdb_disconnect_socket(SSDBSock *ssdb_sock);
+int ssdb_connect_multi(SSDBSock *ssdb_sock, char **hosts, long *ports, int num, int keep_all);
+void ssdb_replicas_close(SSDBSock *ssdb_sock);
+void ssdb_route_read(SSDBSock *ssdb_sock);
+void ssdb_route_finish(SSDBSock *ssdb_sock, int ok);
 
-int ssdb_key_prefix(SSDBSock *ssdb_sock, char **key, int *key_len);
+void *ssdb_arena_alloc(SSDBSock *ssdb_sock, size_t size);
+void ssdb_arena_reset(SSDBSock *ssdb_sock);
+void ssdb_arena_free(SSDBSock *ssdb_sock);
+void ssdb_key_prefix(SSDBSock *ssdb_sock, char **key, int *key_len);
 int ssdb_cmd_format_by_str(SSDBSock *ssdb_sock, char **ret, void *params, ...);
 int ssdb_cmd_format_by_zval(SSDBSock *ssdb_sock, char **ret,
 		char *cmd, int cmd_len,
@@ -111,19 +305,69 @@ int ssdb_cmd_format_by_zval(SSDBSock *ssdb_sock, char **ret,
 		int fill_prefix,
 		int serialize);
 
+int ssdb_cmd_format_argv(SSDBSock *ssdb_sock, char **ret, const SSDBArg *argv, int argc);
+int ssdb_cmd_format(SSDBSock *ssdb_sock, char **ret, const char *types, ...);
+
+int ssdb_cmd_vec_by_zval(SSDBSock *ssdb_sock, SSDBWriteVec *vec,
+		char *cmd, int cmd_len,
+		char *key, int key_len,
+		zval *params,
+		int read_all,
+		int fill_prefix,
+		int serialize);
+
+void ssdb_wvec_init(SSDBWriteVec *vec, size_t threshold);
+void ssdb_wvec_append(SSDBWriteVec *vec, const char *data, size_t len, int copy);
+void ssdb_wvec_own(SSDBWriteVec *vec, char *data);
+int ssdb_wvec_flatten(SSDBWriteVec *vec, char **ret);
+void ssdb_wvec_free(SSDBWriteVec *vec);
+
+void ssdb_hash_key_init(SSDBHashKey *hk, char *key, size_t key_len);
+void ssdb_hash_key_add(zval *arr, SSDBHashKey *hk, zval *value);
+
 int ssdb_check_eof(SSDBSock *ssdb_sock);
 
 SSDBResponse *ssdb_response_create();
 void ssdb_response_free(SSDBResponse *ssdb_response);
-void ssdb_response_add_block(SSDBResponse *ssdb_response, char *data, size_t len);
+void ssdb_response_add_block(SSDBResponse *ssdb_response, size_t offset, size_t len);
 
 SSDBResponse *ssdb_sock_read(SSDBSock *ssdb_sock);
+void ssdb_sock_discard(SSDBSock *ssdb_sock);
 int ssdb_sock_write(SSDBSock *ssdb_sock, char *cmd, size_t sz);
+int ssdb_sock_writev(SSDBSock *ssdb_sock, SSDBWriteVec *vec);
 
 int resend_auth(SSDBSock *ssdb_sock);
 
+//定义在ssdb_class.c
+int ssdb_sock_get(zval *id, SSDBSock **ssdb_sock TSRMLS_DC, int no_throw);
+int ssdb_sock_attach(zval *object, SSDBSock *ssdb_sock TSRMLS_DC);
+
+void ssdb_pipeline_begin(SSDBSock *ssdb_sock);
+void ssdb_pipeline_discard(SSDBSock *ssdb_sock);
+void ssdb_pipeline_exec(SSDBSock *ssdb_sock, zval *return_value TSRMLS_DC);
+void ssdb_noreply_begin(SSDBSock *ssdb_sock);
+void ssdb_sock_finish(SSDBSock *ssdb_sock);
+void ssdb_defer_append(SSDBSock *ssdb_sock, const char *cmd, int cmd_len);
+void ssdb_defer_sum(SSDBSock *ssdb_sock, const SSDBArg *argv, int argc);
+int ssdb_defer_flush(SSDBSock *ssdb_sock);
+int ssdb_defer_pending(SSDBSock *ssdb_sock, const char *key, int key_len);
+void ssdb_defer_reset(SSDBSock *ssdb_sock);
+SSDBResponse *ssdb_read_cache_get(SSDBSock *ssdb_sock, const SSDBArg *argv, int argc, int shm);
+void ssdb_read_cache_forget(SSDBSock *ssdb_sock, const char *key, int key_len);
+void ssdb_read_cache_forget_zval(SSDBSock *ssdb_sock, zval *z_args, int use_keys);
+void ssdb_read_cache_forget_raw(SSDBSock *ssdb_sock, const char *buf, int buf_len);
+void ssdb_read_cache_reset(SSDBSock *ssdb_sock);
+void ssdb_reply_queue(SSDBSock *ssdb_sock, ssdb_reply_type type, int filter_prefix, int unserialize, int convert_type);
+
+int ssdb_prefetch_begin(SSDBSock *ssdb_sock, void *owner, char *cmd, size_t sz);
+int ssdb_prefetch_take(SSDBSock *ssdb_sock, void *owner, SSDBResponse **ssdb_response);
+void ssdb_prefetch_release(SSDBSock *ssdb_sock, void *owner);
+void ssdb_prefetch_settle(SSDBSock *ssdb_sock);
+void ssdb_prefetch_reset(SSDBSock *ssdb_sock);
+
 int ssdb_serialize(SSDBSock *ssdb_sock, zval *z, char **val, int *val_len);
 int ssdb_unserialize(SSDBSock *ssdb_sock, const char *val, int val_len, zval **return_value);
+int ssdb_unserialize_by(int serializer, int compression, const char *val, int val_len, zval **return_value);
 
 void ssdb_long_number_response(INTERNAL_FUNCTION_PARAMETERS, SSDBSock *ssdb_sock);
 void ssdb_double_number_response(INTERNAL_FUNCTION_PARAMETERS, SSDBSock *ssdb_sock);
@@ -0,0 +1,495 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2014 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: xingqiba ixqbar@gmail.com                                                             |
+  +----------------------------------------------------------------------+
+*/
+
+#include "php.h"
+#include "ext/standard/php_smart_str.h"
+#include "ext/standard/php_var.h"
+
+#include <stdint.h>
+
+#include "ssdb_msgpack.h"
+
+#define SSDB_MSGPACK_MAX_DEPTH 512
+//对象没有对应的msgpack类型,以php序列化结果保存在ext类型中
+#define SSDB_MSGPACK_EXT_PHP   1
+
+typedef struct {
+	const unsigned char *p;
+	const unsigned char *end;
+	int depth;
+} SSDBMsgpackReader;
+
+static void ssdb_msgpack_encode_zval(smart_str *buf, zval *z, int depth TSRMLS_DC);
+static int ssdb_msgpack_decode_zval(SSDBMsgpackReader *r, zval *z TSRMLS_DC);
+
+//tag之后是bytes字节大端整数
+static void ssdb_msgpack_put(smart_str *buf, unsigned char tag, uint64_t v, int bytes) {
+	char b[9];
+	int i;
+
+	b[0] = (char) tag;
+	for (i = bytes; i > 0; i--) {
+		b[i] = (char) (v & 0xff);
+		v >>= 8;
+	}
+
+	smart_str_appendl(buf, b, bytes + 1);
+}
+
+//顶层整数不使用单字节fixint,否则"1"这样的单字符原始值会被误解码为整数
+static void ssdb_msgpack_encode_long(smart_str *buf, long l, int top) {
+	if (l >= 0) {
+		if (l < 128 && !top) {
+			smart_str_appendc(buf, (char) l);
+		} else if (l < 256) {
+			ssdb_msgpack_put(buf, 0xcc, l, 1);
+		} else if (l < 65536) {
+			ssdb_msgpack_put(buf, 0xcd, l, 2);
+		} else if ((uint64_t) l <= 0xffffffffULL) {
+			ssdb_msgpack_put(buf, 0xce, l, 4);
+		} else {
+			ssdb_msgpack_put(buf, 0xcf, l, 8);
+		}
+	} else {
+		if (l >= -32 && !top) {
+			smart_str_appendc(buf, (char) l);
+		} else if (l >= -128) {
+			ssdb_msgpack_put(buf, 0xd0, (uint8_t) l, 1);
+		} else if (l >= -32768) {
+			ssdb_msgpack_put(buf, 0xd1, (uint16_t) l, 2);
+		} else if (l >= -2147483647L - 1) {
+			ssdb_msgpack_put(buf, 0xd2, (uint32_t) l, 4);
+		} else {
+			ssdb_msgpack_put(buf, 0xd3, (uint64_t) l, 8);
+		}
+	}
+}
+
+static void ssdb_msgpack_encode_double(smart_str *buf, double d) {
+	union {
+		double d;
+		uint64_t u;
+	} conv;
+
+	conv.d = d;
+	ssdb_msgpack_put(buf, 0xcb, conv.u, 8);
+}
+
+static void ssdb_msgpack_encode_str(smart_str *buf, const char *str, size_t len) {
+	if (len < 32) {
+		smart_str_appendc(buf, (char) (0xa0 | len));
+	} else if (len < 256) {
+		ssdb_msgpack_put(buf, 0xd9, len, 1);
+	} else if (len < 65536) {
+		ssdb_msgpack_put(buf, 0xda, len, 2);
+	} else {
+		ssdb_msgpack_put(buf, 0xdb, len, 4);
+	}
+
+	smart_str_appendl(buf, str, len);
+}
+
+//下标从0开始连续的数组编码为array,其他编码为map
+static int ssdb_msgpack_is_list(HashTable *ht) {
+	HashPosition pos;
+	char *key;
+	uint key_len;
+	ulong idx, expect = 0;
+
+	for (zend_hash_internal_pointer_reset_ex(ht, &pos);
+			zend_hash_get_current_key_type_ex(ht, &pos) != HASH_KEY_NON_EXISTANT;
+			zend_hash_move_forward_ex(ht, &pos)) {
+		if (zend_hash_get_current_key_ex(ht, &key, &key_len, &idx, 0, &pos) != HASH_KEY_IS_LONG
+				|| idx != expect++) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+static void ssdb_msgpack_encode_array(smart_str *buf, HashTable *ht, int depth TSRMLS_DC) {
+	HashPosition pos;
+	zval **z_value;
+	char *key;
+	uint key_len;
+	ulong idx;
+	size_t n = zend_hash_num_elements(ht);
+	int list = ssdb_msgpack_is_list(ht);
+
+	if (n < 16) {
+		smart_str_appendc(buf, (char) ((list ? 0x90 : 0x80) | n));
+	} else if (n < 65536) {
+		ssdb_msgpack_put(buf, list ? 0xdc : 0xde, n, 2);
+	} else {
+		ssdb_msgpack_put(buf, list ? 0xdd : 0xdf, n, 4);
+	}
+
+	for (zend_hash_internal_pointer_reset_ex(ht, &pos);
+			zend_hash_get_current_data_ex(ht, (void **) &z_value, &pos) == SUCCESS;
+			zend_hash_move_forward_ex(ht, &pos)) {
+		if (!list) {
+			if (zend_hash_get_current_key_ex(ht, &key, &key_len, &idx, 0, &pos) == HASH_KEY_IS_STRING) {
+				ssdb_msgpack_encode_str(buf, key, key_len - 1);
+			} else {
+				ssdb_msgpack_encode_long(buf, (long) idx, 0);
+			}
+		}
+		ssdb_msgpack_encode_zval(buf, *z_value, depth + 1 TSRMLS_CC);
+	}
+}
+
+static void ssdb_msgpack_encode_object(smart_str *buf, zval *z TSRMLS_DC) {
+#if ZEND_MODULE_API_NO >= 20100000
+	php_serialize_data_t ht;
+#else
+	HashTable ht;
+#endif
+	smart_str sstr = {0};
+
+#if ZEND_MODULE_API_NO >= 20100000
+	PHP_VAR_SERIALIZE_INIT(ht);
+#else
+	zend_hash_init(&ht, 10, NULL, NULL, 0);
+#endif
+	php_var_serialize(&sstr, &z, &ht TSRMLS_CC);
+#if ZEND_MODULE_API_NO >= 20100000
+	PHP_VAR_SERIALIZE_DESTROY(ht);
+#else
+	zend_hash_destroy(&ht);
+#endif
+
+	if (sstr.len < 256) {
+		ssdb_msgpack_put(buf, 0xc7, sstr.len, 1);
+	} else if (sstr.len < 65536) {
+		ssdb_msgpack_put(buf, 0xc8, sstr.len, 2);
+	} else {
+		ssdb_msgpack_put(buf, 0xc9, sstr.len, 4);
+	}
+	smart_str_appendc(buf, SSDB_MSGPACK_EXT_PHP);
+	smart_str_appendl(buf, sstr.c, sstr.len);
+
+	smart_str_free(&sstr);
+}
+
+static void ssdb_msgpack_encode_zval(smart_str *buf, zval *z, int depth TSRMLS_DC) {
+	if (depth > SSDB_MSGPACK_MAX_DEPTH) {
+		php_error_docref(NULL TSRMLS_CC, E_WARNING, "msgpack nesting level too deep, recursive dependency?");
+		smart_str_appendc(buf, (char) 0xc0);
+		return;
+	}
+
+	switch (Z_TYPE_P(z)) {
+		case IS_BOOL:
+			smart_str_appendc(buf, (char) (Z_BVAL_P(z) ? 0xc3 : 0xc2));
+			break;
+		case IS_LONG:
+			ssdb_msgpack_encode_long(buf, Z_LVAL_P(z), depth == 0);
+			break;
+		case IS_DOUBLE:
+			ssdb_msgpack_encode_double(buf, Z_DVAL_P(z));
+			break;
+		case IS_STRING:
+			ssdb_msgpack_encode_str(buf, Z_STRVAL_P(z), Z_STRLEN_P(z));
+			break;
+		case IS_ARRAY:
+			ssdb_msgpack_encode_array(buf, Z_ARRVAL_P(z), depth TSRMLS_CC);
+			break;
+		case IS_OBJECT:
+			ssdb_msgpack_encode_object(buf, z TSRMLS_CC);
+			break;
+		default:
+			smart_str_appendc(buf, (char) 0xc0);
+			break;
+	}
+}
+
+//编码结果直接作为value返回,由调用者efree
+int ssdb_msgpack_encode(zval *z, char **val, int *val_len TSRMLS_DC) {
+	smart_str buf = {0};
+
+	ssdb_msgpack_encode_zval(&buf, z, 0 TSRMLS_CC);
+
+	*val = buf.c;
+	*val_len = (int) buf.len;
+
+	return 1;
+}
+
+static int ssdb_msgpack_read(SSDBMsgpackReader *r, int bytes, uint64_t *v) {
+	int i;
+
+	if (r->end - r->p < bytes) {
+		return -1;
+	}
+
+	*v = 0;
+	for (i = 0; i < bytes; i++) {
+		*v = (*v << 8) | *r->p++;
+	}
+
+	return 0;
+}
+
+static int ssdb_msgpack_decode_str(SSDBMsgpackReader *r, zval *z, uint64_t len) {
+	if ((uint64_t) (r->end - r->p) < len) {
+		return -1;
+	}
+
+	ZVAL_STRINGL(z, (char *) r->p, (int) len, 1);
+	r->p += len;
+
+	return 0;
+}
+
+static int ssdb_msgpack_decode_ext(SSDBMsgpackReader *r, zval *z, uint64_t len TSRMLS_DC) {
+	php_unserialize_data_t var_hash;
+	const unsigned char *data;
+	int ret;
+
+	if (r->p >= r->end
+			|| *r->p != SSDB_MSGPACK_EXT_PHP
+			|| (uint64_t) (r->end - r->p - 1) < len) {
+		return -1;
+	}
+
+	data = ++r->p;
+	r->p += len;
+
+#if ZEND_MODULE_API_NO >= 20100000
+	PHP_VAR_UNSERIALIZE_INIT(var_hash);
+#else
+	memset(&var_hash, 0, sizeof(var_hash));
+#endif
+	ret = php_var_unserialize(&z, &data, data + len, &var_hash TSRMLS_CC) ? 0 : -1;
+#if ZEND_MODULE_API_NO >= 20100000
+	PHP_VAR_UNSERIALIZE_DESTROY(var_hash);
+#else
+	var_destroy(&var_hash);
+#endif
+
+	if (ret < 0) {
+		ZVAL_NULL(z);
+	}
+
+	return ret;
+}
+
+static int ssdb_msgpack_decode_array(SSDBMsgpackReader *r, zval *z, uint64_t n TSRMLS_DC) {
+	zval *elem;
+	uint64_t i;
+
+	//每个元素至少1字节,元素数不能超过剩余字节数
+	if ((uint64_t) (r->end - r->p) < n || ++r->depth > SSDB_MSGPACK_MAX_DEPTH) {
+		return -1;
+	}
+
+	array_init_size(z, (uint) n);
+	for (i = 0; i < n; i++) {
+		MAKE_STD_ZVAL(elem);
+		if (ssdb_msgpack_decode_zval(r, elem TSRMLS_CC) < 0) {
+			zval_ptr_dtor(&elem);
+			return -1;
+		}
+		add_next_index_zval(z, elem);
+	}
+
+	r->depth--;
+
+	return 0;
+}
+
+static int ssdb_msgpack_decode_map(SSDBMsgpackReader *r, zval *z, uint64_t n TSRMLS_DC) {
+	zval key, *elem;
+	uint64_t i;
+
+	if ((uint64_t) (r->end - r->p) < n * 2 || ++r->depth > SSDB_MSGPACK_MAX_DEPTH) {
+		return -1;
+	}
+
+	array_init_size(z, (uint) n);
+	for (i = 0; i < n; i++) {
+		INIT_ZVAL(key);
+		if (ssdb_msgpack_decode_zval(r, &key TSRMLS_CC) < 0) {
+			zval_dtor(&key);
+			return -1;
+		}
+
+		MAKE_STD_ZVAL(elem);
+		if (ssdb_msgpack_decode_zval(r, elem TSRMLS_CC) < 0) {
+			zval_dtor(&key);
+			zval_ptr_dtor(&elem);
+			return -1;
+		}
+
+		if (Z_TYPE(key) == IS_LONG) {
+			zend_hash_index_update(Z_ARRVAL_P(z), Z_LVAL(key), &elem, sizeof(zval *), NULL);
+		} else {
+			convert_to_string(&key);
+			zend_symtable_update(Z_ARRVAL_P(z), Z_STRVAL(key), Z_STRLEN(key) + 1, &elem, sizeof(zval *), NULL);
+		}
+		zval_dtor(&key);
+	}
+
+	r->depth--;
+
+	return 0;
+}
+
+static int ssdb_msgpack_decode_zval(SSDBMsgpackReader *r, zval *z TSRMLS_DC) {
+	unsigned char b;
+	uint64_t v, len;
+
+	ZVAL_NULL(z);
+
+	if (r->p >= r->end) {
+		return -1;
+	}
+
+	b = *r->p++;
+
+	if (b <= 0x7f) {
+		ZVAL_LONG(z, b);
+		return 0;
+	}
+	if (b >= 0xe0) {
+		ZVAL_LONG(z, (signed char) b);
+		return 0;
+	}
+	if ((b & 0xf0) == 0x80) {
+		return ssdb_msgpack_decode_map(r, z, b & 0x0f TSRMLS_CC);
+	}
+	if ((b & 0xf0) == 0x90) {
+		return ssdb_msgpack_decode_array(r, z, b & 0x0f TSRMLS_CC);
+	}
+	if ((b & 0xe0) == 0xa0) {
+		return ssdb_msgpack_decode_str(r, z, b & 0x1f);
+	}
+
+	switch (b) {
+		case 0xc0:
+			return 0;
+		case 0xc2:
+		case 0xc3:
+			ZVAL_BOOL(z, b == 0xc3);
+			return 0;
+		case 0xc4: case 0xc5: case 0xc6:
+			if (ssdb_msgpack_read(r, 1 << (b - 0xc4), &len) < 0) return -1;
+			return ssdb_msgpack_decode_str(r, z, len);
+		case 0xd9: case 0xda: case 0xdb:
+			if (ssdb_msgpack_read(r, 1 << (b - 0xd9), &len) < 0) return -1;
+			return ssdb_msgpack_decode_str(r, z, len);
+		case 0xc7: case 0xc8: case 0xc9:
+			if (ssdb_msgpack_read(r, 1 << (b - 0xc7), &len) < 0) return -1;
+			return ssdb_msgpack_decode_ext(r, z, len TSRMLS_CC);
+		case 0xd4: case 0xd5: case 0xd6: case 0xd7: case 0xd8:
+			return ssdb_msgpack_decode_ext(r, z, 1 << (b - 0xd4) TSRMLS_CC);
+		case 0xca: {
+			union {
+				float f;
+				uint32_t u;
+			} conv;
+
+			if (ssdb_msgpack_read(r, 4, &v) < 0) return -1;
+			conv.u = (uint32_t) v;
+			ZVAL_DOUBLE(z, conv.f);
+			return 0;
+		}
+		case 0xcb: {
+			union {
+				double d;
+				uint64_t u;
+			} conv;
+
+			if (ssdb_msgpack_read(r, 8, &v) < 0) return -1;
+			conv.u = v;
+			ZVAL_DOUBLE(z, conv.d);
+			return 0;
+		}
+		case 0xcc: case 0xcd: case 0xce: case 0xcf:
+			if (ssdb_msgpack_read(r, 1 << (b - 0xcc), &v) < 0) return -1;
+			if (v > (uint64_t) LONG_MAX) {
+				ZVAL_DOUBLE(z, (double) v);
+			} else {
+				ZVAL_LONG(z, (long) v);
+			}
+			return 0;
+		case 0xd0:
+			if (ssdb_msgpack_read(r, 1, &v) < 0) return -1;
+			ZVAL_LONG(z, (int8_t) v);
+			return 0;
+		case 0xd1:
+			if (ssdb_msgpack_read(r, 2, &v) < 0) return -1;
+			ZVAL_LONG(z, (int16_t) v);
+			return 0;
+		case 0xd2:
+			if (ssdb_msgpack_read(r, 4, &v) < 0) return -1;
+			ZVAL_LONG(z, (int32_t) v);
+			return 0;
+		case 0xd3:
+			if (ssdb_msgpack_read(r, 8, &v) < 0) return -1;
+			if ((int64_t) v < LONG_MIN || (int64_t) v > LONG_MAX) {
+				ZVAL_DOUBLE(z, (double) (int64_t) v);
+			} else {
+				ZVAL_LONG(z, (long) (int64_t) v);
+			}
+			return 0;
+		case 0xdc: case 0xdd:
+			if (ssdb_msgpack_read(r, b == 0xdc ? 2 : 4, &len) < 0) return -1;
+			return ssdb_msgpack_decode_array(r, z, len TSRMLS_CC);
+		case 0xde: case 0xdf:
+			if (ssdb_msgpack_read(r, b == 0xde ? 2 : 4, &len) < 0) return -1;
+			return ssdb_msgpack_decode_map(r, z, len TSRMLS_CC);
+	}
+
+	//0xc1未使用
+	return -1;
+}
+
+//直接从响应数据解码,必须恰好用完全部字节,否则按原始字符串处理
+int ssdb_msgpack_decode(const char *val, int val_len, zval **return_value TSRMLS_DC) {
+	SSDBMsgpackReader r;
+	int rv_free = 0;
+
+	//编码时顶层整数不使用单字节fixint
+	if (val_len <= 0 || (val_len == 1 && ((unsigned char) val[0] <= 0x7f || (unsigned char) val[0] >= 0xe0))) {
+		return 0;
+	}
+
+	if (!*return_value) {
+		MAKE_STD_ZVAL(*return_value);
+		rv_free = 1;
+	}
+
+	r.p     = (const unsigned char *) val;
+	r.end   = r.p + val_len;
+	r.depth = 0;
+
+	if (ssdb_msgpack_decode_zval(&r, *return_value TSRMLS_CC) == 0 && r.p == r.end) {
+		return 1;
+	}
+
+	zval_dtor(*return_value);
+	ZVAL_NULL(*return_value);
+	if (rv_free) {
+		efree(*return_value);
+		*return_value = NULL;
+	}
+
+	return 0;
+}
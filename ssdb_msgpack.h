@@ -0,0 +1,25 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2014 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: xingqiba ixqbar@gmail.com                                                             |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef EXT_SSDB_SSDB_MSGPACK_H_
+#define EXT_SSDB_SSDB_MSGPACK_H_
+
+int ssdb_msgpack_encode(zval *z, char **val, int *val_len TSRMLS_DC);
+int ssdb_msgpack_decode(const char *val, int val_len, zval **return_value TSRMLS_DC);
+
+#endif /* EXT_SSDB_SSDB_MSGPACK_H_ */
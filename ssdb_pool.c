@@ -0,0 +1,321 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2014 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: xingqiba ixqbar@gmail.com                                                             |
+  +----------------------------------------------------------------------+
+*/
+
+#include "php.h"
+#include "php_network.h"
+
+#include "ssdb_library.h"
+#include "ssdb_pool.h"
+
+#include "php_ssdb.h"
+
+#define SSDB_POOL_PING     "4\nping\n\n"
+#define SSDB_POOL_PING_OK  "2\nok\n\n"
+
+static void ssdb_pool_endpoint_free(void *data) {
+	SSDBPoolEndpoint *endpoint = *(SSDBPoolEndpoint **) data;
+	int i;
+
+	for (i = 0; i < endpoint->num; i++) {
+		pefree(endpoint->slots[i].persistent_id, 1);
+	}
+
+	if (endpoint->slots) {
+		pefree(endpoint->slots, 1);
+	}
+	pefree(endpoint, 1);
+}
+
+void ssdb_pool_init(HashTable *pool) {
+	zend_hash_init(pool, 8, NULL, ssdb_pool_endpoint_free, 1);
+}
+
+void ssdb_pool_destroy(HashTable *pool) {
+	zend_hash_destroy(pool);
+}
+
+int ssdb_pool_enabled(TSRMLS_D) {
+	return SSDB_G(pool_max_idle) > 0;
+}
+
+static SSDBPoolEndpoint *ssdb_pool_endpoint(const char *key, int create TSRMLS_DC) {
+	SSDBPoolEndpoint **found, *endpoint;
+
+	if (zend_hash_find(&SSDB_G(pool), key, strlen(key) + 1, (void **) &found) == SUCCESS) {
+		return *found;
+	}
+
+	if (!create) {
+		return NULL;
+	}
+
+	endpoint = pecalloc(1, sizeof(SSDBPoolEndpoint), 1);
+	zend_hash_update(&SSDB_G(pool), key, strlen(key) + 1, &endpoint, sizeof(SSDBPoolEndpoint *), NULL);
+
+	return endpoint;
+}
+
+static SSDBPoolSlot *ssdb_pool_slot(SSDBPoolEndpoint *endpoint, const char *persistent_id) {
+	int i;
+
+	for (i = 0; i < endpoint->num; i++) {
+		if (0 == strcmp(endpoint->slots[i].persistent_id, persistent_id)) {
+			return &endpoint->slots[i];
+		}
+	}
+
+	return NULL;
+}
+
+//关闭slot对应的长连接并从连接池中移除
+static void ssdb_pool_slot_remove(SSDBPoolEndpoint *endpoint, SSDBPoolSlot *slot TSRMLS_DC) {
+	php_stream *stream = NULL;
+	int i = slot - endpoint->slots;
+
+	if (php_stream_from_persistent_id(slot->persistent_id, &stream TSRMLS_CC) == PHP_STREAM_PERSISTENT_SUCCESS) {
+		php_stream_pclose(stream);
+	}
+
+	pefree(slot->persistent_id, 1);
+	endpoint->num--;
+	if (i < endpoint->num) {
+		memmove(&endpoint->slots[i], &endpoint->slots[i + 1], (endpoint->num - i) * sizeof(SSDBPoolSlot));
+	}
+}
+
+static SSDBPoolSlot *ssdb_pool_slot_add(SSDBPoolEndpoint *endpoint, const char *key) {
+	SSDBPoolSlot *slot;
+	char *persistent_id = NULL;
+	int persistent_id_len;
+
+	if (endpoint->num == endpoint->size) {
+		endpoint->size = endpoint->size ? endpoint->size * 2 : 4;
+		endpoint->slots = perealloc(endpoint->slots, endpoint->size * sizeof(SSDBPoolSlot), 1);
+	}
+
+	persistent_id_len = spprintf(&persistent_id, 0, "%s:pool:%ld", key, endpoint->next_id++);
+
+	slot = &endpoint->slots[endpoint->num++];
+	slot->persistent_id = pestrndup(persistent_id, persistent_id_len, 1);
+	slot->idle_since = 0;
+	slot->in_use = 1;
+
+	efree(persistent_id);
+
+	return slot;
+}
+
+static int ssdb_pool_idle_num(SSDBPoolEndpoint *endpoint) {
+	int i, idle = 0;
+
+	for (i = 0; i < endpoint->num; i++) {
+		if (!endpoint->slots[i].in_use) {
+			idle++;
+		}
+	}
+
+	return idle;
+}
+
+//回收超时的空闲连接,至少保留pool_min_idle个
+static void ssdb_pool_evict(SSDBPoolEndpoint *endpoint, time_t now TSRMLS_DC) {
+	int i, idle = ssdb_pool_idle_num(endpoint);
+
+	if (SSDB_G(pool_idle_timeout) <= 0) {
+		return;
+	}
+
+	//slots按放回时间排列,先检查最早放回的
+	for (i = 0; i < endpoint->num && idle > SSDB_G(pool_min_idle); ) {
+		SSDBPoolSlot *slot = &endpoint->slots[i];
+		if (!slot->in_use && now - slot->idle_since >= SSDB_G(pool_idle_timeout)) {
+			ssdb_pool_slot_remove(endpoint, slot TSRMLS_CC);
+			endpoint->evictions++;
+			idle--;
+			continue;
+		}
+		i++;
+	}
+}
+
+static int ssdb_pool_ping(php_stream *stream) {
+	char buf[sizeof(SSDB_POOL_PING_OK)];
+	size_t len = 0;
+	TSRMLS_FETCH();
+
+	if (php_stream_write(stream, SSDB_POOL_PING, sizeof(SSDB_POOL_PING) - 1) != sizeof(SSDB_POOL_PING) - 1) {
+		return -1;
+	}
+
+	while (len < sizeof(SSDB_POOL_PING_OK) - 1) {
+		size_t n = php_stream_read(stream, buf + len, sizeof(SSDB_POOL_PING_OK) - 1 - len);
+		if (n <= 0) {
+			return -1;
+		}
+		len += n;
+	}
+
+	return memcmp(buf, SSDB_POOL_PING_OK, sizeof(SSDB_POOL_PING_OK) - 1) == 0 ? 0 : -1;
+}
+
+static php_stream *ssdb_pool_open(char *host, int host_len, char *persistent_id, struct timeval *tv TSRMLS_DC) {
+	char *errstr = NULL;
+	int err = 0;
+	php_stream *stream;
+
+	stream = php_stream_xport_create(
+			host,
+			host_len,
+			ENFORCE_SAFE_MODE,
+			STREAM_XPORT_CLIENT | STREAM_XPORT_CONNECT,
+			persistent_id,
+			tv,
+			NULL,
+			&errstr,
+			&err);
+
+	if (errstr) {
+		efree(errstr);
+	}
+
+	return stream;
+}
+
+//从连接池取出连接,优先复用最近放回的空闲连接
+int ssdb_pool_checkout(SSDBSock *ssdb_sock, char *host, int host_len, struct timeval *tv, struct timeval *read_tv TSRMLS_DC) {
+	SSDBPoolEndpoint *endpoint;
+	SSDBPoolSlot *slot;
+	php_stream *stream;
+	time_t now = time(NULL);
+	int i;
+
+	//重连时原连接已关闭
+	ssdb_pool_checkin(ssdb_sock, 1 TSRMLS_CC);
+
+	endpoint = ssdb_pool_endpoint(ssdb_sock->pool_key, 1 TSRMLS_CC);
+	endpoint->checkouts++;
+	ssdb_pool_evict(endpoint, now TSRMLS_CC);
+
+	for (i = endpoint->num - 1; i >= 0; i--) {
+		slot = &endpoint->slots[i];
+		if (slot->in_use) {
+			continue;
+		}
+
+		slot->in_use = 1;
+		stream = ssdb_pool_open(host, host_len, slot->persistent_id, tv TSRMLS_CC);
+		if (stream && SSDB_G(pool_ping)) {
+			if (read_tv->tv_sec != 0 || read_tv->tv_usec != 0) {
+				php_stream_set_option(stream, PHP_STREAM_OPTION_READ_TIMEOUT, 0, read_tv);
+			}
+			if (ssdb_pool_ping(stream) < 0) {
+				endpoint->ping_failures++;
+				stream = NULL;
+			}
+		}
+
+		if (stream) {
+			endpoint->hits++;
+			ssdb_sock->stream = stream;
+			ssdb_sock->pool_id = estrdup(slot->persistent_id);
+			return 0;
+		}
+
+		ssdb_pool_slot_remove(endpoint, slot TSRMLS_CC);
+	}
+
+	slot = ssdb_pool_slot_add(endpoint, ssdb_sock->pool_key);
+	stream = ssdb_pool_open(host, host_len, slot->persistent_id, tv TSRMLS_CC);
+	if (!stream) {
+		ssdb_pool_slot_remove(endpoint, slot TSRMLS_CC);
+		return -1;
+	}
+
+	endpoint->creates++;
+	ssdb_sock->stream = stream;
+	ssdb_sock->pool_id = estrdup(slot->persistent_id);
+
+	return 0;
+}
+
+//放回连接池,discard时关闭连接
+void ssdb_pool_checkin(SSDBSock *ssdb_sock, int discard TSRMLS_DC) {
+	SSDBPoolEndpoint *endpoint;
+	SSDBPoolSlot *slot, released;
+	int i;
+
+	if (ssdb_sock->pool_id == NULL) {
+		return;
+	}
+
+	endpoint = ssdb_pool_endpoint(ssdb_sock->pool_key, 0 TSRMLS_CC);
+	slot = endpoint ? ssdb_pool_slot(endpoint, ssdb_sock->pool_id) : NULL;
+
+	efree(ssdb_sock->pool_id);
+	ssdb_sock->pool_id = NULL;
+
+	if (slot == NULL) {
+		return;
+	}
+
+	if (discard || ssdb_pool_idle_num(endpoint) >= SSDB_G(pool_max_idle)) {
+		ssdb_pool_slot_remove(endpoint, slot TSRMLS_CC);
+		return;
+	}
+
+	//移到末尾,保持slots按放回时间排列
+	released = *slot;
+	released.in_use = 0;
+	released.idle_since = time(NULL);
+	i = slot - endpoint->slots;
+	memmove(&endpoint->slots[i], &endpoint->slots[i + 1], (endpoint->num - i - 1) * sizeof(SSDBPoolSlot));
+	endpoint->slots[endpoint->num - 1] = released;
+}
+
+void ssdb_pool_stats(zval *return_value TSRMLS_DC) {
+	HashPosition pos;
+	SSDBPoolEndpoint **endpoint;
+	char *key;
+	uint key_len;
+	ulong index;
+
+	array_init(return_value);
+
+	for (zend_hash_internal_pointer_reset_ex(&SSDB_G(pool), &pos);
+			zend_hash_get_current_data_ex(&SSDB_G(pool), (void **) &endpoint, &pos) == SUCCESS;
+			zend_hash_move_forward_ex(&SSDB_G(pool), &pos)) {
+		zval *stats;
+		int idle = ssdb_pool_idle_num(*endpoint);
+
+		if (zend_hash_get_current_key_ex(&SSDB_G(pool), &key, &key_len, &index, 0, &pos) != HASH_KEY_IS_STRING) {
+			continue;
+		}
+
+		MAKE_STD_ZVAL(stats);
+		array_init(stats);
+		add_assoc_long(stats, "idle",          idle);
+		add_assoc_long(stats, "active",        (*endpoint)->num - idle);
+		add_assoc_long(stats, "checkouts",     (*endpoint)->checkouts);
+		add_assoc_long(stats, "hits",          (*endpoint)->hits);
+		add_assoc_long(stats, "creates",       (*endpoint)->creates);
+		add_assoc_long(stats, "ping_failures", (*endpoint)->ping_failures);
+		add_assoc_long(stats, "evictions",     (*endpoint)->evictions);
+
+		add_assoc_zval_ex(return_value, key, key_len, stats);
+	}
+}
@@ -0,0 +1,51 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2014 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: xingqiba ixqbar@gmail.com                                                             |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef EXT_SSDB_SSDB_POOL_H_
+#define EXT_SSDB_SSDB_POOL_H_
+
+#include "ssdb_library.h"
+
+//连接池中的一个连接,stream以persistent_id保存在EG(persistent_list)中
+typedef struct {
+	char *persistent_id;
+	time_t idle_since;
+	int in_use;
+} SSDBPoolSlot;
+
+typedef struct {
+	SSDBPoolSlot *slots;
+	int num;
+	int size;
+	long next_id;
+	long checkouts;
+	long hits;
+	long creates;
+	long ping_failures;
+	long evictions;
+} SSDBPoolEndpoint;
+
+int ssdb_pool_enabled(TSRMLS_D);
+int ssdb_pool_checkout(SSDBSock *ssdb_sock, char *host, int host_len, struct timeval *tv, struct timeval *read_tv TSRMLS_DC);
+void ssdb_pool_checkin(SSDBSock *ssdb_sock, int discard TSRMLS_DC);
+void ssdb_pool_stats(zval *return_value TSRMLS_DC);
+
+void ssdb_pool_init(HashTable *pool);
+void ssdb_pool_destroy(HashTable *pool);
+
+#endif /* EXT_SSDB_SSDB_POOL_H_ */
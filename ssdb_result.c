@@ -0,0 +1,362 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2014 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: xingqiba ixqbar@gmail.com                                                             |
+  +----------------------------------------------------------------------+
+*/
+
+#include "php.h"
+#include "Zend/zend_interfaces.h"
+#include "Zend/zend_exceptions.h"
+#if HAVE_SPL
+#include "ext/spl/spl_iterators.h"
+#endif
+
+#include "ssdb_library.h"
+#include "ssdb_result.h"
+
+zend_class_entry *ssdb_result_set_ce;
+
+static zend_object_handlers ssdb_result_set_handlers;
+
+#define SSDB_RESULT_SET_FETCH(rs) SSDBResultSet *rs = (SSDBResultSet *) zend_object_store_get_object(getThis() TSRMLS_CC)
+
+static void ssdb_result_set_free(void *object TSRMLS_DC) {
+	SSDBResultSet *rs = (SSDBResultSet *) object;
+	int i;
+
+	if (rs->values) {
+		for (i = 0; i < rs->num; i++) {
+			if (rs->values[i]) {
+				zval_ptr_dtor(&rs->values[i]);
+			}
+		}
+		efree(rs->values);
+	}
+
+	if (rs->index) {
+		zend_hash_destroy(rs->index);
+		FREE_HASHTABLE(rs->index);
+	}
+
+	if (rs->prefix) {
+		efree(rs->prefix);
+	}
+
+	ssdb_response_free(rs->ssdb_response);
+	zend_object_std_dtor(&rs->std TSRMLS_CC);
+	efree(rs);
+}
+
+static zend_object_value ssdb_result_set_create(zend_class_entry *ce TSRMLS_DC) {
+	zend_object_value retval;
+	SSDBResultSet *rs = ecalloc(1, sizeof(SSDBResultSet));
+
+	zend_object_std_init(&rs->std, ce TSRMLS_CC);
+#if PHP_VERSION_ID < 50399
+	zend_hash_copy(rs->std.properties, &ce->default_properties, (copy_ctor_func_t) zval_add_ref, NULL, sizeof(zval *));
+#else
+	object_properties_init(&rs->std, ce);
+#endif
+
+	retval.handle = zend_objects_store_put(rs,
+			(zend_objects_store_dtor_t) zend_objects_destroy_object,
+			(zend_objects_free_object_storage_t) ssdb_result_set_free,
+			NULL TSRMLS_CC);
+	retval.handlers = &ssdb_result_set_handlers;
+
+	return retval;
+}
+
+void ssdb_result_set_init(zval *return_value, SSDBSock *ssdb_sock, SSDBResponse *ssdb_response, int type, int filter_prefix, int unserialize, int convert_type TSRMLS_DC) {
+	SSDBResultSet *rs;
+
+	object_init_ex(return_value, ssdb_result_set_ce);
+	rs = (SSDBResultSet *) zend_object_store_get_object(return_value TSRMLS_CC);
+
+	rs->ssdb_response = ssdb_response;
+	rs->type          = type;
+	rs->filter_prefix = filter_prefix;
+	rs->unserialize   = unserialize;
+	rs->convert_type  = convert_type;
+	rs->serializer    = ssdb_sock->serializer;
+	rs->compression   = ssdb_sock->compression;
+	rs->num           = type == SSDB_RESULT_SET_MAP ? ssdb_response->num / 2 : ssdb_response->num;
+	rs->pos           = 0;
+
+	if (filter_prefix == SSDB_FILTER_KEY_PREFIX && ssdb_sock->prefix) {
+		rs->prefix     = estrndup(ssdb_sock->prefix, ssdb_sock->prefix_len);
+		rs->prefix_len = ssdb_sock->prefix_len;
+	}
+}
+
+static void ssdb_result_set_strip_prefix(SSDBResultSet *rs, char **data, size_t *len) {
+	if (rs->prefix
+			&& *len >= (size_t)rs->prefix_len
+			&& 0 == memcmp(*data, rs->prefix, rs->prefix_len)) {
+		*data += rs->prefix_len;
+		*len  -= rs->prefix_len;
+	}
+}
+
+static void ssdb_result_set_key(SSDBResultSet *rs, int i, char **key, size_t *key_len) {
+	*key     = SSDB_RESPONSE_BLOCK_DATA(rs->ssdb_response, i * 2);
+	*key_len = SSDB_RESPONSE_BLOCK_LEN(rs->ssdb_response, i * 2);
+	ssdb_result_set_strip_prefix(rs, key, key_len);
+}
+
+//按需解码第i个元素,结果缓存以便重复访问
+static zval *ssdb_result_set_value(SSDBResultSet *rs, int i) {
+	zval *z = NULL;
+	char *data;
+	size_t len;
+
+	if (rs->values == NULL) {
+		rs->values = ecalloc(rs->num, sizeof(zval *));
+	} else if (rs->values[i]) {
+		return rs->values[i];
+	}
+
+	if (rs->type == SSDB_RESULT_SET_MAP) {
+		data = SSDB_RESPONSE_BLOCK_DATA(rs->ssdb_response, i * 2 + 1);
+		len  = SSDB_RESPONSE_BLOCK_LEN(rs->ssdb_response, i * 2 + 1);
+	} else {
+		data = SSDB_RESPONSE_BLOCK_DATA(rs->ssdb_response, i);
+		len  = SSDB_RESPONSE_BLOCK_LEN(rs->ssdb_response, i);
+		ssdb_result_set_strip_prefix(rs, &data, &len);
+	}
+
+	if (rs->unserialize == SSDB_UNSERIALIZE
+			&& ssdb_unserialize_by(rs->serializer, rs->compression, data, len, &z)) {
+		rs->values[i] = z;
+		return z;
+	}
+
+	MAKE_STD_ZVAL(z);
+	if (rs->type == SSDB_RESULT_SET_MAP
+			&& rs->unserialize == SSDB_UNSERIALIZE_NONE
+			&& rs->convert_type == SSDB_CONVERT_TO_LONG) {
+		ZVAL_LONG(z, atol(data));
+	} else {
+		ZVAL_STRINGL(z, data, len, 1);
+	}
+
+	rs->values[i] = z;
+	return z;
+}
+
+static int ssdb_result_set_find(SSDBResultSet *rs, zval *offset TSRMLS_DC) {
+	zval tmp;
+	int *idx, i, ret = -1;
+
+	if (rs->type == SSDB_RESULT_SET_LIST) {
+		long l;
+		if (Z_TYPE_P(offset) == IS_LONG) {
+			l = Z_LVAL_P(offset);
+		} else {
+			tmp = *offset;
+			zval_copy_ctor(&tmp);
+			convert_to_long(&tmp);
+			l = Z_LVAL(tmp);
+		}
+		return (l >= 0 && l < rs->num) ? (int)l : -1;
+	}
+
+	if (rs->index == NULL) {
+		ALLOC_HASHTABLE(rs->index);
+		zend_hash_init(rs->index, rs->num, NULL, NULL, 0);
+		for (i = 0; i < rs->num; i++) {
+			char *key;
+			size_t key_len;
+			ssdb_result_set_key(rs, i, &key, &key_len);
+			//arena中每个块后都有'\0',可直接作为hash key
+			zend_hash_update(rs->index, key, key_len + 1, &i, sizeof(int), NULL);
+		}
+	}
+
+	tmp = *offset;
+	zval_copy_ctor(&tmp);
+	convert_to_string(&tmp);
+	if (zend_hash_find(rs->index, Z_STRVAL(tmp), Z_STRLEN(tmp) + 1, (void **)&idx) == SUCCESS) {
+		ret = *idx;
+	}
+	zval_dtor(&tmp);
+
+	return ret;
+}
+
+PHP_METHOD(SSDBResultSet, count) {
+	SSDB_RESULT_SET_FETCH(rs);
+	RETURN_LONG(rs->num);
+}
+
+PHP_METHOD(SSDBResultSet, current) {
+	SSDB_RESULT_SET_FETCH(rs);
+
+	if (rs->pos >= rs->num) {
+		RETURN_NULL();
+	}
+
+	RETURN_ZVAL(ssdb_result_set_value(rs, rs->pos), 1, 0);
+}
+
+PHP_METHOD(SSDBResultSet, key) {
+	SSDB_RESULT_SET_FETCH(rs);
+
+	if (rs->pos >= rs->num) {
+		RETURN_NULL();
+	}
+
+	if (rs->type == SSDB_RESULT_SET_MAP) {
+		char *key;
+		size_t key_len;
+		ssdb_result_set_key(rs, rs->pos, &key, &key_len);
+		RETURN_STRINGL(key, key_len, 1);
+	}
+
+	RETURN_LONG(rs->pos);
+}
+
+PHP_METHOD(SSDBResultSet, next) {
+	SSDB_RESULT_SET_FETCH(rs);
+	rs->pos++;
+}
+
+PHP_METHOD(SSDBResultSet, rewind) {
+	SSDB_RESULT_SET_FETCH(rs);
+	rs->pos = 0;
+}
+
+PHP_METHOD(SSDBResultSet, valid) {
+	SSDB_RESULT_SET_FETCH(rs);
+	RETURN_BOOL(rs->pos < rs->num);
+}
+
+PHP_METHOD(SSDBResultSet, offsetExists) {
+	zval *offset;
+	SSDB_RESULT_SET_FETCH(rs);
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "z", &offset) == FAILURE) {
+		RETURN_FALSE;
+	}
+
+	RETURN_BOOL(ssdb_result_set_find(rs, offset TSRMLS_CC) >= 0);
+}
+
+PHP_METHOD(SSDBResultSet, offsetGet) {
+	zval *offset;
+	int i;
+	SSDB_RESULT_SET_FETCH(rs);
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS() TSRMLS_CC, "z", &offset) == FAILURE) {
+		RETURN_NULL();
+	}
+
+	i = ssdb_result_set_find(rs, offset TSRMLS_CC);
+	if (i < 0) {
+		RETURN_NULL();
+	}
+
+	RETURN_ZVAL(ssdb_result_set_value(rs, i), 1, 0);
+}
+
+PHP_METHOD(SSDBResultSet, offsetSet) {
+	zend_throw_exception(ssdb_exception_ce, "SSDBResultSet is read only", 0 TSRMLS_CC);
+}
+
+PHP_METHOD(SSDBResultSet, offsetUnset) {
+	zend_throw_exception(ssdb_exception_ce, "SSDBResultSet is read only", 0 TSRMLS_CC);
+}
+
+//只返回key,不解码value
+PHP_METHOD(SSDBResultSet, keys) {
+	int i;
+	SSDB_RESULT_SET_FETCH(rs);
+
+	array_init_size(return_value, rs->num);
+	for (i = 0; i < rs->num; i++) {
+		if (rs->type == SSDB_RESULT_SET_MAP) {
+			char *key;
+			size_t key_len;
+			ssdb_result_set_key(rs, i, &key, &key_len);
+			add_next_index_stringl(return_value, key, key_len, 1);
+		} else {
+			add_next_index_long(return_value, i);
+		}
+	}
+}
+
+PHP_METHOD(SSDBResultSet, toArray) {
+	int i;
+	SSDBHashKey hk;
+	SSDB_RESULT_SET_FETCH(rs);
+
+	array_init_size(return_value, rs->num);
+	for (i = 0; i < rs->num; i++) {
+		zval *z = ssdb_result_set_value(rs, i);
+		Z_ADDREF_P(z);
+		if (rs->type == SSDB_RESULT_SET_MAP) {
+			char *key;
+			size_t key_len;
+			ssdb_result_set_key(rs, i, &key, &key_len);
+			ssdb_hash_key_init(&hk, key, key_len);
+			ssdb_hash_key_add(return_value, &hk, z);
+		} else {
+			add_next_index_zval(return_value, z);
+		}
+	}
+}
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_ssdb_result_set_offset, 0, 0, 1)
+	ZEND_ARG_INFO(0, offset)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_ssdb_result_set_offset_set, 0, 0, 2)
+	ZEND_ARG_INFO(0, offset)
+	ZEND_ARG_INFO(0, value)
+ZEND_END_ARG_INFO()
+
+const zend_function_entry ssdb_result_set_methods[] = {
+	PHP_ME(SSDBResultSet, count,        NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBResultSet, current,      NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBResultSet, key,          NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBResultSet, next,         NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBResultSet, rewind,       NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBResultSet, valid,        NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBResultSet, offsetExists, arginfo_ssdb_result_set_offset,     ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBResultSet, offsetGet,    arginfo_ssdb_result_set_offset,     ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBResultSet, offsetSet,    arginfo_ssdb_result_set_offset_set, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBResultSet, offsetUnset,  arginfo_ssdb_result_set_offset,     ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBResultSet, keys,         NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBResultSet, toArray,      NULL, ZEND_ACC_PUBLIC)
+	{NULL, NULL, NULL}
+};
+
+void register_ssdb_result_set_class(TSRMLS_D) {
+	zend_class_entry ce;
+
+	INIT_CLASS_ENTRY(ce, "SSDBResultSet", ssdb_result_set_methods);
+	ssdb_result_set_ce = zend_register_internal_class(&ce TSRMLS_CC);
+	ssdb_result_set_ce->create_object = ssdb_result_set_create;
+	ssdb_result_set_ce->ce_flags |= ZEND_ACC_FINAL_CLASS;
+
+	memcpy(&ssdb_result_set_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
+	ssdb_result_set_handlers.clone_obj = NULL;
+
+#if HAVE_SPL
+	zend_class_implements(ssdb_result_set_ce TSRMLS_CC, 3, zend_ce_iterator, zend_ce_arrayaccess, spl_ce_Countable);
+#else
+	zend_class_implements(ssdb_result_set_ce TSRMLS_CC, 2, zend_ce_iterator, zend_ce_arrayaccess);
+#endif
+}
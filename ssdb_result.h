@@ -0,0 +1,63 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2014 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: xingqiba ixqbar@gmail.com                                                             |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef EXT_SSDB_SSDB_RESULT_H_
+#define EXT_SSDB_SSDB_RESULT_H_
+
+#include "ssdb_library.h"
+
+#define SSDB_RESULT_SET_LIST 0
+#define SSDB_RESULT_SET_MAP  1
+
+//延迟解码的结果集,直接引用响应arena,元素在被访问时才解码
+typedef struct {
+	zend_object std;
+	SSDBResponse *ssdb_response;
+	int type;
+	int filter_prefix;
+	int unserialize;
+	int convert_type;
+	int serializer;
+	int compression;
+	char *prefix;
+	int prefix_len;
+	int num;
+	int pos;
+	zval **values;
+	HashTable *index;
+} SSDBResultSet;
+
+extern zend_class_entry *ssdb_result_set_ce;
+
+void ssdb_result_set_init(zval *return_value, SSDBSock *ssdb_sock, SSDBResponse *ssdb_response, int type, int filter_prefix, int unserialize, int convert_type TSRMLS_DC);
+void register_ssdb_result_set_class(TSRMLS_D);
+
+PHP_METHOD(SSDBResultSet, count);
+PHP_METHOD(SSDBResultSet, current);
+PHP_METHOD(SSDBResultSet, key);
+PHP_METHOD(SSDBResultSet, next);
+PHP_METHOD(SSDBResultSet, rewind);
+PHP_METHOD(SSDBResultSet, valid);
+PHP_METHOD(SSDBResultSet, offsetExists);
+PHP_METHOD(SSDBResultSet, offsetGet);
+PHP_METHOD(SSDBResultSet, offsetSet);
+PHP_METHOD(SSDBResultSet, offsetUnset);
+PHP_METHOD(SSDBResultSet, keys);
+PHP_METHOD(SSDBResultSet, toArray);
+
+#endif /* EXT_SSDB_SSDB_RESULT_H_ */
@@ -0,0 +1,466 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2014 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: xingqiba ixqbar@gmail.com                                                             |
+  +----------------------------------------------------------------------+
+*/
+
+#include "php.h"
+#include "Zend/zend_interfaces.h"
+#include "Zend/zend_exceptions.h"
+
+#include "ssdb_library.h"
+#include "ssdb_class.h"
+#include "ssdb_scan.h"
+
+zend_class_entry *ssdb_scan_iterator_ce;
+
+static zend_object_handlers ssdb_scan_iterator_handlers;
+
+static void ssdb_scan_iterator_release(SSDBScanIterator *it TSRMLS_DC);
+
+static const SSDBScanCommand ssdb_scan_commands[] = {
+	{"scan",   "scan",   4, 0, 1, 0, 0, SSDB_FILTER_KEY_PREFIX,      SSDB_UNSERIALIZE,      SSDB_CONVERT_TO_STRING},
+	{"rscan",  "rscan",  5, 0, 1, 0, 1, SSDB_FILTER_KEY_PREFIX,      SSDB_UNSERIALIZE,      SSDB_CONVERT_TO_STRING},
+	{"keys",   "keys",   4, 0, 0, 0, 0, SSDB_FILTER_KEY_PREFIX,      SSDB_UNSERIALIZE_NONE, SSDB_CONVERT_TO_STRING},
+	{"hlist",  "hlist",  5, 0, 0, 0, 0, SSDB_FILTER_KEY_PREFIX,      SSDB_UNSERIALIZE_NONE, SSDB_CONVERT_TO_STRING},
+	{"hrlist", "hrlist", 6, 0, 0, 0, 1, SSDB_FILTER_KEY_PREFIX,      SSDB_UNSERIALIZE_NONE, SSDB_CONVERT_TO_STRING},
+	{"zlist",  "zlist",  5, 0, 0, 0, 0, SSDB_FILTER_KEY_PREFIX,      SSDB_UNSERIALIZE_NONE, SSDB_CONVERT_TO_STRING},
+	{"zrlist", "zrlist", 6, 0, 0, 0, 1, SSDB_FILTER_KEY_PREFIX,      SSDB_UNSERIALIZE_NONE, SSDB_CONVERT_TO_STRING},
+	{"qlist",  "qlist",  5, 0, 0, 0, 0, SSDB_FILTER_KEY_PREFIX,      SSDB_UNSERIALIZE_NONE, SSDB_CONVERT_TO_STRING},
+	{"qrlist", "qrlist", 6, 0, 0, 0, 1, SSDB_FILTER_KEY_PREFIX,      SSDB_UNSERIALIZE_NONE, SSDB_CONVERT_TO_STRING},
+	{"hscan",  "hscan",  5, 1, 1, 0, 0, SSDB_FILTER_KEY_PREFIX_NONE, SSDB_UNSERIALIZE,      SSDB_CONVERT_TO_STRING},
+	{"hrscan", "hrscan", 6, 1, 1, 0, 1, SSDB_FILTER_KEY_PREFIX_NONE, SSDB_UNSERIALIZE,      SSDB_CONVERT_TO_STRING},
+	{"zscan",  "zscan",  5, 1, 1, 1, 0, SSDB_FILTER_KEY_PREFIX_NONE, SSDB_UNSERIALIZE_NONE, SSDB_CONVERT_TO_LONG},
+	{"zrscan", "zrscan", 6, 1, 1, 1, 1, SSDB_FILTER_KEY_PREFIX_NONE, SSDB_UNSERIALIZE_NONE, SSDB_CONVERT_TO_LONG},
+	{NULL}
+};
+
+#define SSDB_SCAN_ITERATOR_FETCH(it) SSDBScanIterator *it = (SSDBScanIterator *) zend_object_store_get_object(getThis() TSRMLS_CC)
+
+#define SSDB_SCAN_STR_FREE(str) if (str) { \
+	efree(str); \
+	str = NULL; \
+}
+
+static void ssdb_scan_iterator_free(void *object TSRMLS_DC) {
+	SSDBScanIterator *it = (SSDBScanIterator *) object;
+
+	ssdb_scan_iterator_release(it TSRMLS_CC);
+
+	if (it->ssdb) {
+		zval_ptr_dtor(&it->ssdb);
+	}
+
+	SSDB_SCAN_STR_FREE(it->prefix);
+	SSDB_SCAN_STR_FREE(it->name);
+	SSDB_SCAN_STR_FREE(it->begin);
+	SSDB_SCAN_STR_FREE(it->start);
+	SSDB_SCAN_STR_FREE(it->score);
+	SSDB_SCAN_STR_FREE(it->end);
+
+	ssdb_response_free(it->page);
+	zend_object_std_dtor(&it->std TSRMLS_CC);
+	efree(it);
+}
+
+static zend_object_value ssdb_scan_iterator_create(zend_class_entry *ce TSRMLS_DC) {
+	zend_object_value retval;
+	SSDBScanIterator *it = ecalloc(1, sizeof(SSDBScanIterator));
+
+	zend_object_std_init(&it->std, ce TSRMLS_CC);
+#if PHP_VERSION_ID < 50399
+	zend_hash_copy(it->std.properties, &ce->default_properties, (copy_ctor_func_t) zval_add_ref, NULL, sizeof(zval *));
+#else
+	object_properties_init(&it->std, ce);
+#endif
+
+	retval.handle = zend_objects_store_put(it,
+			(zend_objects_store_dtor_t) zend_objects_destroy_object,
+			(zend_objects_free_object_storage_t) ssdb_scan_iterator_free,
+			NULL TSRMLS_CC);
+	retval.handlers = &ssdb_scan_iterator_handlers;
+
+	return retval;
+}
+
+//key前缀之后的最小上界,如test_ -> test`
+static char *ssdb_scan_prefix_successor(char *prefix, int prefix_len, int *ret_len) {
+	char *ret = estrndup(prefix, prefix_len);
+	int i;
+
+	for (i = prefix_len - 1; i >= 0; i--) {
+		if ((unsigned char)ret[i] != 0xff) {
+			ret[i]++;
+			*ret_len = i + 1;
+			ret[*ret_len] = '\0';
+			return ret;
+		}
+	}
+
+	*ret_len = 0;
+	ret[0] = '\0';
+	return ret;
+}
+
+static char *ssdb_scan_bound(SSDBScanIterator *it, char *key, int key_len, int upper, int *ret_len) {
+	if (it->prefix == NULL) {
+		*ret_len = key_len;
+		return estrndup(key, key_len);
+	}
+
+	if (key_len == 0) {
+		if (upper) {
+			return ssdb_scan_prefix_successor(it->prefix, it->prefix_len, ret_len);
+		}
+		*ret_len = it->prefix_len;
+		return estrndup(it->prefix, it->prefix_len);
+	}
+
+	*ret_len = it->prefix_len + key_len;
+	char *ret = emalloc(*ret_len + 1);
+	memcpy(ret, it->prefix, it->prefix_len);
+	memcpy(ret + it->prefix_len, key, key_len);
+	ret[*ret_len] = '\0';
+
+	return ret;
+}
+
+static int ssdb_scan_has_prefix(SSDBScanIterator *it, char *key, size_t key_len) {
+	return it->prefix == NULL
+			|| (key_len >= (size_t)it->prefix_len && 0 == memcmp(key, it->prefix, it->prefix_len));
+}
+
+static int ssdb_scan_iterator_format(SSDBScanIterator *it, SSDBSock *ssdb_sock, char **cmd) {
+	const SSDBScanCommand *command = it->command;
+
+	if (command->is_score) {
+		return ssdb_cmd_format(ssdb_sock, cmd, "sssssl", command->cmd, command->cmd_len,
+				it->name, it->name_len,
+				it->start ? it->start : "", it->start_len,
+				it->score, it->score_len,
+				it->end, it->end_len,
+				it->batch);
+	} else if (command->has_name) {
+		return ssdb_cmd_format(ssdb_sock, cmd, "ssssl", command->cmd, command->cmd_len,
+				it->name, it->name_len,
+				it->start, it->start_len,
+				it->end, it->end_len,
+				it->batch);
+	}
+
+	return ssdb_cmd_format(ssdb_sock, cmd, "sssl", command->cmd, command->cmd_len,
+			it->start, it->start_len,
+			it->end, it->end_len,
+			it->batch);
+}
+
+//放弃已发出的预取请求,其响应由连接在下次写入前读取丢弃
+static void ssdb_scan_iterator_release(SSDBScanIterator *it TSRMLS_DC) {
+	SSDBSock *ssdb_sock;
+
+	if (it->ssdb && ssdb_sock_get(it->ssdb, &ssdb_sock TSRMLS_CC, 1) >= 0) {
+		ssdb_prefetch_release(ssdb_sock, it);
+	}
+}
+
+static int ssdb_scan_iterator_fetch(SSDBScanIterator *it TSRMLS_DC) {
+	SSDBSock *ssdb_sock;
+	SSDBResponse *ssdb_response = NULL;
+	const SSDBScanCommand *command = it->command;
+	char *cmd = NULL;
+	int cmd_len = 0, i;
+
+	//先释放上一页,保证内存中最多只有一页数据
+	ssdb_response_free(it->page);
+	it->page = NULL;
+	it->page_pos = 0;
+	it->page_num = 0;
+
+	if (ssdb_sock_get(it->ssdb, &ssdb_sock TSRMLS_CC, 0) < 0) {
+		it->finished = 1;
+		return -1;
+	}
+
+	if (ssdb_sock->pipeline) {
+		it->finished = 1;
+		zend_throw_exception(ssdb_exception_ce, "Command not supported in pipeline mode", 0 TSRMLS_CC);
+		return -1;
+	}
+
+	//没有可用的预取响应时同步请求
+	if (ssdb_prefetch_take(ssdb_sock, it, &ssdb_response) < 0) {
+		cmd_len = ssdb_scan_iterator_format(it, ssdb_sock, &cmd);
+		if (0 == cmd_len || ssdb_sock_write(ssdb_sock, cmd, cmd_len) < 0) {
+			if (cmd) efree(cmd);
+			it->finished = 1;
+			return -1;
+		}
+		efree(cmd);
+
+		ssdb_response = ssdb_sock_read(ssdb_sock);
+	}
+	if (ssdb_response == NULL
+			|| ssdb_response->status != SSDB_IS_OK
+			|| (command->is_map && ssdb_response->num % 2 != 0)) {
+		ssdb_response_free(ssdb_response);
+		it->finished = 1;
+		return -1;
+	}
+
+	it->page = ssdb_response;
+	it->page_num = command->is_map ? ssdb_response->num / 2 : ssdb_response->num;
+
+	if (it->page_num < it->batch) {
+		it->finished = 1;
+	}
+
+	//超出前缀范围即结束
+	for (i = 0; it->prefix && i < it->page_num; i++) {
+		int block = command->is_map ? i * 2 : i;
+		if (!ssdb_scan_has_prefix(it, SSDB_RESPONSE_BLOCK_DATA(ssdb_response, block), SSDB_RESPONSE_BLOCK_LEN(ssdb_response, block))) {
+			it->page_num = i;
+			it->finished = 1;
+			break;
+		}
+	}
+
+	//记录下一页的起始位置
+	if (!it->finished && it->page_num > 0) {
+		int last = it->page_num - 1;
+		int block = command->is_map ? last * 2 : last;
+
+		SSDB_SCAN_STR_FREE(it->start);
+		it->start_len = SSDB_RESPONSE_BLOCK_LEN(ssdb_response, block);
+		it->start = estrndup(SSDB_RESPONSE_BLOCK_DATA(ssdb_response, block), it->start_len);
+
+		if (command->is_score) {
+			SSDB_SCAN_STR_FREE(it->score);
+			it->score_len = SSDB_RESPONSE_BLOCK_LEN(ssdb_response, block + 1);
+			it->score = estrndup(SSDB_RESPONSE_BLOCK_DATA(ssdb_response, block + 1), it->score_len);
+		}
+	}
+
+	//当前页交给PHP处理前先发出下一页请求
+	if (!it->finished && it->page_num > 0 && it->prefetch) {
+		cmd = NULL;
+		cmd_len = ssdb_scan_iterator_format(it, ssdb_sock, &cmd);
+		if (cmd_len > 0) {
+			ssdb_prefetch_begin(ssdb_sock, it, cmd, cmd_len);
+		}
+		if (cmd) efree(cmd);
+	}
+
+	return 0;
+}
+
+static void ssdb_scan_iterator_reset(SSDBScanIterator *it TSRMLS_DC) {
+	ssdb_scan_iterator_release(it TSRMLS_CC);
+
+	SSDB_SCAN_STR_FREE(it->start);
+	it->start_len = 0;
+
+	if (it->command->is_score) {
+		SSDB_SCAN_STR_FREE(it->score);
+		it->score = estrndup(it->begin, it->begin_len);
+		it->score_len = it->begin_len;
+	} else {
+		it->start = estrndup(it->begin, it->begin_len);
+		it->start_len = it->begin_len;
+	}
+
+	ssdb_response_free(it->page);
+	it->page = NULL;
+	it->page_pos = 0;
+	it->page_num = 0;
+	it->index = 0;
+	it->finished = 0;
+}
+
+static void ssdb_scan_iterator_ensure(SSDBScanIterator *it TSRMLS_DC) {
+	if (it->page == NULL && !it->finished) {
+		ssdb_scan_iterator_fetch(it TSRMLS_CC);
+	}
+}
+
+int ssdb_scan_iterator_init(zval *return_value, zval *ssdb, SSDBSock *ssdb_sock,
+		char *type, int type_len,
+		char *start, int start_len,
+		char *end, int end_len,
+		long batch,
+		char *name, int name_len TSRMLS_DC) {
+	const SSDBScanCommand *command;
+	SSDBScanIterator *it;
+
+	for (command = ssdb_scan_commands; command->type != NULL; command++) {
+		if (strlen(command->type) == type_len && 0 == strncasecmp(command->type, type, type_len)) {
+			break;
+		}
+	}
+
+	if (command->type == NULL) {
+		zend_throw_exception(ssdb_exception_ce, "Unsupported scan type", 0 TSRMLS_CC);
+		return FAILURE;
+	}
+
+	if (command->has_name && 0 == name_len) {
+		zend_throw_exception(ssdb_exception_ce, "Scan type requires a name", 0 TSRMLS_CC);
+		return FAILURE;
+	}
+
+	object_init_ex(return_value, ssdb_scan_iterator_ce);
+	it = (SSDBScanIterator *) zend_object_store_get_object(return_value TSRMLS_CC);
+
+	it->ssdb       = ssdb;
+	Z_ADDREF_P(ssdb);
+	it->command    = command;
+	it->serializer = ssdb_sock->serializer;
+	it->compression = ssdb_sock->compression;
+	it->batch      = batch > 0 ? batch : SSDB_SCAN_DEFAULT_BATCH;
+	it->prefetch   = ssdb_sock->scan_prefetch;
+
+	if (command->has_name) {
+		ssdb_key_prefix(ssdb_sock, &name, &name_len);
+		it->name = estrndup(name, name_len);
+		it->name_len = name_len;
+	}
+
+	if (command->filter_prefix == SSDB_FILTER_KEY_PREFIX && ssdb_sock->prefix) {
+		it->prefix = estrndup(ssdb_sock->prefix, ssdb_sock->prefix_len);
+		it->prefix_len = ssdb_sock->prefix_len;
+	}
+
+	if (command->is_score) {
+		it->begin = estrndup(start, start_len);
+		it->begin_len = start_len;
+		it->end = estrndup(end, end_len);
+		it->end_len = end_len;
+	} else {
+		it->begin = ssdb_scan_bound(it, start, start_len, command->is_reverse, &it->begin_len);
+		it->end = ssdb_scan_bound(it, end, end_len, !command->is_reverse, &it->end_len);
+	}
+
+	ssdb_scan_iterator_reset(it TSRMLS_CC);
+
+	return SUCCESS;
+}
+
+PHP_METHOD(SSDBScanIterator, current) {
+	zval *z = NULL;
+	char *data;
+	size_t len;
+	SSDB_SCAN_ITERATOR_FETCH(it);
+
+	ssdb_scan_iterator_ensure(it TSRMLS_CC);
+	if (it->page == NULL || it->page_pos >= it->page_num) {
+		RETURN_NULL();
+	}
+
+	if (!it->command->is_map) {
+		data = SSDB_RESPONSE_BLOCK_DATA(it->page, it->page_pos);
+		len  = SSDB_RESPONSE_BLOCK_LEN(it->page, it->page_pos);
+		if (it->prefix) {
+			data += it->prefix_len;
+			len  -= it->prefix_len;
+		}
+		RETURN_STRINGL(data, len, 1);
+	}
+
+	data = SSDB_RESPONSE_BLOCK_DATA(it->page, it->page_pos * 2 + 1);
+	len  = SSDB_RESPONSE_BLOCK_LEN(it->page, it->page_pos * 2 + 1);
+
+	if (it->command->convert_type == SSDB_CONVERT_TO_LONG) {
+		RETURN_LONG(atol(data));
+	}
+
+	if (it->command->unserialize == SSDB_UNSERIALIZE
+			&& ssdb_unserialize_by(it->serializer, it->compression, data, len, &z)) {
+		RETURN_ZVAL(z, 0, 1);
+	}
+
+	RETURN_STRINGL(data, len, 1);
+}
+
+PHP_METHOD(SSDBScanIterator, key) {
+	char *data;
+	size_t len;
+	SSDB_SCAN_ITERATOR_FETCH(it);
+
+	ssdb_scan_iterator_ensure(it TSRMLS_CC);
+	if (it->page == NULL || it->page_pos >= it->page_num) {
+		RETURN_NULL();
+	}
+
+	if (!it->command->is_map) {
+		RETURN_LONG(it->index);
+	}
+
+	data = SSDB_RESPONSE_BLOCK_DATA(it->page, it->page_pos * 2);
+	len  = SSDB_RESPONSE_BLOCK_LEN(it->page, it->page_pos * 2);
+	if (it->prefix) {
+		data += it->prefix_len;
+		len  -= it->prefix_len;
+	}
+
+	RETURN_STRINGL(data, len, 1);
+}
+
+PHP_METHOD(SSDBScanIterator, next) {
+	SSDB_SCAN_ITERATOR_FETCH(it);
+
+	ssdb_scan_iterator_ensure(it TSRMLS_CC);
+	it->page_pos++;
+	it->index++;
+
+	if (it->page_pos >= it->page_num && !it->finished) {
+		ssdb_scan_iterator_fetch(it TSRMLS_CC);
+	}
+}
+
+PHP_METHOD(SSDBScanIterator, rewind) {
+	SSDB_SCAN_ITERATOR_FETCH(it);
+
+	ssdb_scan_iterator_reset(it TSRMLS_CC);
+	ssdb_scan_iterator_fetch(it TSRMLS_CC);
+}
+
+PHP_METHOD(SSDBScanIterator, valid) {
+	SSDB_SCAN_ITERATOR_FETCH(it);
+
+	ssdb_scan_iterator_ensure(it TSRMLS_CC);
+	RETURN_BOOL(it->page != NULL && it->page_pos < it->page_num);
+}
+
+const zend_function_entry ssdb_scan_iterator_methods[] = {
+	PHP_ME(SSDBScanIterator, current, NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBScanIterator, key,     NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBScanIterator, next,    NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBScanIterator, rewind,  NULL, ZEND_ACC_PUBLIC)
+	PHP_ME(SSDBScanIterator, valid,   NULL, ZEND_ACC_PUBLIC)
+	{NULL, NULL, NULL}
+};
+
+void register_ssdb_scan_iterator_class(TSRMLS_D) {
+	zend_class_entry ce;
+
+	INIT_CLASS_ENTRY(ce, "SSDBScanIterator", ssdb_scan_iterator_methods);
+	ssdb_scan_iterator_ce = zend_register_internal_class(&ce TSRMLS_CC);
+	ssdb_scan_iterator_ce->create_object = ssdb_scan_iterator_create;
+	ssdb_scan_iterator_ce->ce_flags |= ZEND_ACC_FINAL_CLASS;
+
+	memcpy(&ssdb_scan_iterator_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
+	ssdb_scan_iterator_handlers.clone_obj = NULL;
+
+	zend_class_implements(ssdb_scan_iterator_ce TSRMLS_CC, 1, zend_ce_iterator);
+}
@@ -0,0 +1,83 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2014 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: xingqiba ixqbar@gmail.com                                                             |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef EXT_SSDB_SSDB_SCAN_H_
+#define EXT_SSDB_SSDB_SCAN_H_
+
+#include "ssdb_library.h"
+
+#define SSDB_SCAN_DEFAULT_BATCH 1000
+
+typedef struct {
+	const char *type;
+	const char *cmd;
+	int cmd_len;
+	int has_name;     //hscan/zscan需要hash或zset名称
+	int is_map;       //返回key-value对
+	int is_score;     //zscan类,翻页时需同时带上score
+	int is_reverse;
+	int filter_prefix;
+	int unserialize;
+	int convert_type;
+} SSDBScanCommand;
+
+//自动翻页的scan迭代器,内存中最多保留一页数据
+typedef struct {
+	zend_object std;
+	zval *ssdb;
+	const SSDBScanCommand *command;
+	int serializer;
+	int compression;
+	char *prefix;
+	int prefix_len;
+	char *name;
+	int name_len;
+	char *begin;
+	int begin_len;
+	char *start;
+	int start_len;
+	char *score;
+	int score_len;
+	char *end;
+	int end_len;
+	long batch;
+	int prefetch;     //返回当前页前先发出下一页的请求
+	SSDBResponse *page;
+	int page_pos;
+	int page_num;
+	long index;
+	int finished;
+} SSDBScanIterator;
+
+extern zend_class_entry *ssdb_scan_iterator_ce;
+
+int ssdb_scan_iterator_init(zval *return_value, zval *ssdb, SSDBSock *ssdb_sock,
+		char *type, int type_len,
+		char *start, int start_len,
+		char *end, int end_len,
+		long batch,
+		char *name, int name_len TSRMLS_DC);
+void register_ssdb_scan_iterator_class(TSRMLS_D);
+
+PHP_METHOD(SSDBScanIterator, current);
+PHP_METHOD(SSDBScanIterator, key);
+PHP_METHOD(SSDBScanIterator, next);
+PHP_METHOD(SSDBScanIterator, rewind);
+PHP_METHOD(SSDBScanIterator, valid);
+
+#endif /* EXT_SSDB_SSDB_SCAN_H_ */
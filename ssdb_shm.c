@@ -0,0 +1,321 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2014 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: xingqiba ixqbar@gmail.com                                                             |
+  +----------------------------------------------------------------------+
+*/
+
+#include "php.h"
+
+#include <sched.h>
+#include <sys/mman.h>
+
+#include "ssdb_shm.h"
+
+//拿不到锁时放弃缓存直接访问服务端,避免持锁的worker异常退出后全部阻塞;forget改为增加代数
+#define SSDB_SHM_LOCK_SPINS 1000
+
+static SSDBShmCache *ssdb_shm = NULL;
+static size_t ssdb_shm_size = 0;
+
+#define SSDB_SHM_SLOT_BYTES(cache) (XtOffsetOf(SSDBShmSlot, data) + (((cache)->slot_size + sizeof(long) - 1) & ~(sizeof(long) - 1)))
+#define SSDB_SHM_SLOT(cache, i) ((SSDBShmSlot *) ((char *) (cache) + ssdb_shm_slots_offset((cache)->slot_num) + (size_t) (i) * SSDB_SHM_SLOT_BYTES(cache)))
+
+static size_t ssdb_shm_slots_offset(uint32_t slot_num) {
+	size_t offset = XtOffsetOf(SSDBShmCache, buckets) + slot_num * sizeof(int32_t);
+
+	return (offset + sizeof(long) - 1) & ~(sizeof(long) - 1);
+}
+
+static int ssdb_shm_lock(SSDBShmCache *cache) {
+	int i;
+
+	for (i = 0; i < SSDB_SHM_LOCK_SPINS; i++) {
+		if (0 == __sync_lock_test_and_set(&cache->lock, 1)) {
+			return 0;
+		}
+		sched_yield();
+	}
+
+	return -1;
+}
+
+static void ssdb_shm_unlock(SSDBShmCache *cache) {
+	__sync_lock_release(&cache->lock);
+}
+
+//size为共享内存总大小,slot_size为单项server+key+field+value的上限
+int ssdb_shm_init(size_t size, size_t slot_size) {
+	SSDBShmCache *cache;
+	size_t slot_bytes;
+	uint32_t slot_num, i;
+
+	if (size == 0 || slot_size == 0) {
+		return 0;
+	}
+
+	slot_bytes = XtOffsetOf(SSDBShmSlot, data) + ((slot_size + sizeof(long) - 1) & ~(sizeof(long) - 1));
+	slot_num = (size - XtOffsetOf(SSDBShmCache, buckets)) / (slot_bytes + sizeof(int32_t));
+	while (slot_num > 0 && ssdb_shm_slots_offset(slot_num) + slot_num * slot_bytes > size) {
+		slot_num--;
+	}
+
+	if (slot_num == 0) {
+		return -1;
+	}
+
+	cache = (SSDBShmCache *) mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANON, -1, 0);
+	if (cache == MAP_FAILED) {
+		return -1;
+	}
+
+	memset(cache, 0, ssdb_shm_slots_offset(slot_num));
+	cache->slot_num  = slot_num;
+	cache->slot_size = slot_size;
+	for (i = 0; i < slot_num; i++) {
+		cache->buckets[i] = -1;
+		SSDB_SHM_SLOT(cache, i)->used = 0;
+	}
+
+	ssdb_shm = cache;
+	ssdb_shm_size = size;
+
+	return 0;
+}
+
+void ssdb_shm_shutdown(void) {
+	if (ssdb_shm) {
+		munmap(ssdb_shm, ssdb_shm_size);
+		ssdb_shm = NULL;
+		ssdb_shm_size = 0;
+	}
+}
+
+int ssdb_shm_enabled(void) {
+	return ssdb_shm != NULL;
+}
+
+//同一服务端同一个key的全部field在同一个bucket中,写入时可以一起删除
+static uint32_t ssdb_shm_hash(const char *server, int server_len, const char *key, int key_len) {
+	return (uint32_t) (zend_inline_hash_func(key, key_len) * 33 + zend_inline_hash_func(server, server_len));
+}
+
+static int ssdb_shm_match(SSDBShmSlot *slot, uint32_t hash, const char *server, int server_len, const char *key, int key_len) {
+	return slot->hash == hash
+		&& slot->server_len == (uint32_t) server_len
+		&& slot->key_len == (uint32_t) key_len
+		&& 0 == memcmp(slot->data, server, server_len)
+		&& 0 == memcmp(slot->data + server_len, key, key_len);
+}
+
+static void ssdb_shm_unlink(SSDBShmCache *cache, int32_t index) {
+	SSDBShmSlot *slot = SSDB_SHM_SLOT(cache, index);
+	int32_t *link = &cache->buckets[slot->hash % cache->slot_num];
+
+	while (*link >= 0) {
+		if (*link == index) {
+			*link = slot->next;
+			break;
+		}
+		link = &SSDB_SHM_SLOT(cache, *link)->next;
+	}
+
+	slot->used = 0;
+	slot->next = -1;
+}
+
+static int32_t ssdb_shm_find(SSDBShmCache *cache, uint32_t hash, const char *server, int server_len,
+		const char *key, int key_len, const char *field, int field_len) {
+	int32_t index = cache->buckets[hash % cache->slot_num];
+
+	while (index >= 0) {
+		SSDBShmSlot *slot = SSDB_SHM_SLOT(cache, index);
+
+		if (ssdb_shm_match(slot, hash, server, server_len, key, key_len)
+				&& slot->field_len == (uint32_t) field_len
+				&& 0 == memcmp(slot->data + server_len + key_len, field, field_len)) {
+			return index;
+		}
+		index = slot->next;
+	}
+
+	return -1;
+}
+
+//CLOCK: 跳过并清除最近访问过的项,淘汰第一个未被访问的项
+static int32_t ssdb_shm_victim(SSDBShmCache *cache) {
+	uint32_t i;
+
+	for (i = 0; i < cache->slot_num * 2; i++) {
+		int32_t index = cache->hand;
+		SSDBShmSlot *slot = SSDB_SHM_SLOT(cache, index);
+
+		cache->hand = (cache->hand + 1) % cache->slot_num;
+
+		if (!slot->used) {
+			return index;
+		}
+
+		if (slot->ref) {
+			slot->ref = 0;
+			continue;
+		}
+
+		ssdb_shm_unlink(cache, index);
+		cache->evictions++;
+		return index;
+	}
+
+	return -1;
+}
+
+//命中时返回value的副本,过期项在查找时删除
+char *ssdb_shm_get(const char *server, int server_len, const char *key, int key_len, const char *field, int field_len, int *value_len) {
+	SSDBShmCache *cache = ssdb_shm;
+	SSDBShmSlot *slot;
+	uint32_t hash;
+	int32_t index;
+	char *value = NULL;
+
+	if (cache == NULL || ssdb_shm_lock(cache) < 0) {
+		return NULL;
+	}
+
+	hash  = ssdb_shm_hash(server, server_len, key, key_len);
+	index = ssdb_shm_find(cache, hash, server, server_len, key, key_len, field, field_len);
+	if (index >= 0) {
+		slot = SSDB_SHM_SLOT(cache, index);
+		if (slot->expire <= time(NULL)
+				|| slot->generation != cache->generations[hash % SSDB_SHM_GENERATIONS]) {
+			ssdb_shm_unlink(cache, index);
+		} else {
+			slot->ref  = 1;
+			*value_len = slot->value_len;
+			value = emalloc(slot->value_len + 1);
+			memcpy(value, slot->data + server_len + key_len + field_len, slot->value_len);
+			value[slot->value_len] = '\0';
+		}
+	}
+
+	if (value) {
+		cache->hits++;
+	} else {
+		cache->misses++;
+	}
+
+	ssdb_shm_unlock(cache);
+
+	return value;
+}
+
+void ssdb_shm_put(const char *server, int server_len, const char *key, int key_len, const char *field, int field_len, const char *value, int value_len, long ttl) {
+	SSDBShmCache *cache = ssdb_shm;
+	SSDBShmSlot *slot;
+	uint32_t hash;
+	int32_t index;
+
+	if (cache == NULL
+			|| ttl <= 0
+			|| (size_t) server_len + key_len + field_len + value_len > cache->slot_size
+			|| ssdb_shm_lock(cache) < 0) {
+		return;
+	}
+
+	hash  = ssdb_shm_hash(server, server_len, key, key_len);
+	index = ssdb_shm_find(cache, hash, server, server_len, key, key_len, field, field_len);
+	if (index >= 0) {
+		ssdb_shm_unlink(cache, index);
+	} else {
+		index = ssdb_shm_victim(cache);
+	}
+
+	if (index >= 0) {
+		slot = SSDB_SHM_SLOT(cache, index);
+		slot->hash      = hash;
+		slot->used      = 1;
+		slot->ref       = 1;
+		slot->server_len = server_len;
+		slot->key_len    = key_len;
+		slot->field_len  = field_len;
+		slot->value_len  = value_len;
+		slot->expire     = time(NULL) + ttl;
+		slot->generation = cache->generations[hash % SSDB_SHM_GENERATIONS];
+		memcpy(slot->data, server, server_len);
+		memcpy(slot->data + server_len, key, key_len);
+		memcpy(slot->data + server_len + key_len, field, field_len);
+		memcpy(slot->data + server_len + key_len + field_len, value, value_len);
+
+		slot->next = cache->buckets[hash % cache->slot_num];
+		cache->buckets[hash % cache->slot_num] = index;
+	}
+
+	ssdb_shm_unlock(cache);
+}
+
+//删除该服务端上key下的全部field
+void ssdb_shm_forget(const char *server, int server_len, const char *key, int key_len) {
+	SSDBShmCache *cache = ssdb_shm;
+	uint32_t hash;
+	int32_t index, next;
+
+	if (cache == NULL) {
+		return;
+	}
+
+	hash = ssdb_shm_hash(server, server_len, key, key_len);
+
+	//拿不到锁时不能留下旧值,增加所在分段的代数使其中的缓存项全部失效
+	if (ssdb_shm_lock(cache) < 0) {
+		__sync_fetch_and_add(&cache->generations[hash % SSDB_SHM_GENERATIONS], 1);
+		return;
+	}
+
+	index = cache->buckets[hash % cache->slot_num];
+	while (index >= 0) {
+		SSDBShmSlot *slot = SSDB_SHM_SLOT(cache, index);
+
+		next = slot->next;
+		if (ssdb_shm_match(slot, hash, server, server_len, key, key_len)) {
+			ssdb_shm_unlink(cache, index);
+		}
+		index = next;
+	}
+
+	ssdb_shm_unlock(cache);
+}
+
+void ssdb_shm_stats(zval *return_value) {
+	SSDBShmCache *cache = ssdb_shm;
+	long used = 0;
+	uint32_t i;
+
+	if (cache == NULL || ssdb_shm_lock(cache) < 0) {
+		RETURN_FALSE;
+	}
+
+	for (i = 0; i < cache->slot_num; i++) {
+		used += SSDB_SHM_SLOT(cache, i)->used ? 1 : 0;
+	}
+
+	array_init(return_value);
+	add_assoc_long(return_value, "size",      ssdb_shm_size);
+	add_assoc_long(return_value, "slot_size", cache->slot_size);
+	add_assoc_long(return_value, "slots",     cache->slot_num);
+	add_assoc_long(return_value, "used",      used);
+	add_assoc_long(return_value, "hits",      cache->hits);
+	add_assoc_long(return_value, "misses",    cache->misses);
+	add_assoc_long(return_value, "evictions", cache->evictions);
+
+	ssdb_shm_unlock(cache);
+}
@@ -0,0 +1,63 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 5                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2014 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 3.01 of the PHP license,      |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.php.net/license/3_01.txt                                  |
+  | If you did not receive a copy of the PHP license and are unable to   |
+  | obtain it through the world-wide-web, please send a note to          |
+  | license@php.net so we can mail you a copy immediately.               |
+  +----------------------------------------------------------------------+
+  | Author: xingqiba ixqbar@gmail.com                                                             |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef EXT_SSDB_SSDB_SHM_H_
+#define EXT_SSDB_SSDB_SHM_H_
+
+#include <stdint.h>
+
+//失效代数的分段数,forget拿不到锁时增加key所在分段的代数
+#define SSDB_SHM_GENERATIONS 1024
+
+//共享内存中的一个缓存项,data依次保存server、key、field和value
+typedef struct {
+	uint32_t hash;
+	int32_t next;                    //同一bucket中的下一项,-1为结束
+	uint8_t used;
+	uint8_t ref;                     //CLOCK访问位
+	uint32_t server_len;             //host:port,不同服务端的同名key互不影响
+	uint32_t key_len;
+	uint32_t field_len;
+	uint32_t value_len;
+	uint32_t generation;             //写入时所在分段的代数,不一致即失效
+	time_t expire;
+	char data[1];
+} SSDBShmSlot;
+
+//MINIT时mmap的匿名共享内存,fork出的worker共用
+typedef struct {
+	volatile int lock;
+	uint32_t slot_num;
+	uint32_t slot_size;              //每项server+key+field+value的最大字节数
+	uint32_t hand;                   //CLOCK指针
+	long hits;
+	long misses;
+	long evictions;
+	volatile uint32_t generations[SSDB_SHM_GENERATIONS];
+	int32_t buckets[1];
+} SSDBShmCache;
+
+int ssdb_shm_init(size_t size, size_t slot_size);
+void ssdb_shm_shutdown(void);
+int ssdb_shm_enabled(void);
+char *ssdb_shm_get(const char *server, int server_len, const char *key, int key_len, const char *field, int field_len, int *value_len);
+void ssdb_shm_put(const char *server, int server_len, const char *key, int key_len, const char *field, int field_len, const char *value, int value_len, long ttl);
+void ssdb_shm_forget(const char *server, int server_len, const char *key, int key_len);
+void ssdb_shm_stats(zval *return_value);
+
+#endif /* EXT_SSDB_SSDB_SHM_H_ */
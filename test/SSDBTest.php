@@ -23,6 +23,342 @@ class SSDBTest extends PHPUnit_Framework_TestCase {
         $this->assertNull($this->ssdb_handle->get('name'));
     }
 
+    public function testReadCache() {
+        $this->assertTrue($this->ssdb_handle->set('read_cache', 'a'));
+        $this->assertTrue($this->ssdb_handle->hset('read_cache_hash', 'f', 'v'));
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_READ_CACHE, 1));
+        $this->assertEquals('a', $this->ssdb_handle->get('read_cache'));
+        $this->assertEquals(array('f' => 'v'), $this->ssdb_handle->hgetall('read_cache_hash'));
+        $other = new SSDB();
+        $other->connect('127.0.0.1', 8888);
+        $other->option(SSDB::OPT_PREFIX, 'test_');
+        $this->assertTrue($other->set('read_cache', 'b'));
+        $this->assertEquals('a', $this->ssdb_handle->get('read_cache'));
+        $this->assertTrue($this->ssdb_handle->set('read_cache', 'c'));
+        $this->assertEquals('c', $this->ssdb_handle->get('read_cache'));
+        $this->assertTrue($this->ssdb_handle->hset('read_cache_hash', 'g', 'w'));
+        $this->assertEquals('w', $this->ssdb_handle->hget('read_cache_hash', 'g'));
+        $this->assertEquals(1, $this->ssdb_handle->multi_del(array('read_cache')));
+        $this->assertNull($this->ssdb_handle->get('read_cache'));
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_READ_CACHE, 0));
+        $this->assertEquals(2, $this->ssdb_handle->hclear('read_cache_hash'));
+    }
+
+    public function testShmCache() {
+        if (!ini_get('ssdb.shm_cache_size')) {
+            $this->assertFalse($this->ssdb_handle->option(SSDB::OPT_SHM_CACHE, 30));
+            return;
+        }
+        $this->assertTrue($this->ssdb_handle->set('shm_cache', 'a'));
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_SHM_CACHE, 30));
+        $this->assertEquals('a', $this->ssdb_handle->get('shm_cache'));
+        $stats = ssdb_shm_cache_stats();
+        $this->assertEquals('a', $this->ssdb_handle->get('shm_cache'));
+        $after = ssdb_shm_cache_stats();
+        $this->assertEquals($stats['hits'] + 1, $after['hits']);
+        $this->assertTrue($this->ssdb_handle->set('shm_cache', 'b'));
+        $this->assertEquals('b', $this->ssdb_handle->get('shm_cache'));
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_SHM_CACHE, 0));
+        $this->assertTrue($this->ssdb_handle->del('shm_cache'));
+    }
+
+    public function testMsgpack() {
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_SERIALIZER, SSDB::SERIALIZER_MSGPACK));
+        $value = array(1, -300, 'a' => 'msgpack', 'nested' => array(true, false, null, 1.5), 70000 => str_repeat('x', 300));
+        $this->assertTrue($this->ssdb_handle->set('msgpack', $value));
+        $this->assertSame($value, $this->ssdb_handle->get('msgpack'));
+        $this->assertTrue($this->ssdb_handle->set('msgpack', 5));
+        $this->assertSame(5, $this->ssdb_handle->get('msgpack'));
+        $object = new ArrayObject(array('a' => 1));
+        $this->assertTrue($this->ssdb_handle->hset('msgpack_hash', 'o', $object));
+        $this->assertEquals($object, $this->ssdb_handle->hget('msgpack_hash', 'o'));
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_SERIALIZER, SSDB::SERIALIZER_NONE));
+        $this->assertTrue($this->ssdb_handle->set('msgpack', '5'));
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_SERIALIZER, SSDB::SERIALIZER_MSGPACK));
+        $this->assertSame('5', $this->ssdb_handle->get('msgpack'));
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_SERIALIZER, SSDB::SERIALIZER_NONE));
+        $this->assertTrue($this->ssdb_handle->del('msgpack'));
+        $this->assertEquals(1, $this->ssdb_handle->hclear('msgpack_hash'));
+    }
+
+    public function testCompression() {
+        if (!$this->ssdb_handle->option(SSDB::OPT_COMPRESSION, SSDB::COMPRESSION_LZ4)
+                && !$this->ssdb_handle->option(SSDB::OPT_COMPRESSION, SSDB::COMPRESSION_ZSTD)) {
+            $this->markTestSkipped('no compression codec compiled in');
+        }
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_COMPRESSION_THRESHOLD, 64));
+        $value = str_repeat('compression ', 100);
+        $this->assertTrue($this->ssdb_handle->set('compression', $value));
+        $this->assertTrue($this->ssdb_handle->hset('compression_hash', 'f', $value));
+        $this->assertLessThan(strlen($value), $this->ssdb_handle->strlen('compression'));
+        $this->assertEquals($value, $this->ssdb_handle->get('compression'));
+        $this->assertEquals(array('f' => $value), $this->ssdb_handle->hgetall('compression_hash'));
+        $raw = "\xC1\x01\x00\x00\x00\x10X";
+        $this->assertTrue($this->ssdb_handle->set('compression_raw', $raw));
+        $this->assertSame($raw, $this->ssdb_handle->get('compression_raw'));
+        $this->assertTrue($this->ssdb_handle->set('compression_raw', "\xC0"));
+        $this->assertSame("\xC0", $this->ssdb_handle->get('compression_raw'));
+        //开启压缩之前写入的0xC0开头的值按原样返回
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_COMPRESSION, SSDB::COMPRESSION_NONE));
+        $this->assertTrue($this->ssdb_handle->set('compression_raw', "\xC0"));
+        $this->assertTrue($this->ssdb_handle->set('compression_raw2', "\xC0abcdefg"));
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_COMPRESSION, SSDB::COMPRESSION_LZ4) || $this->ssdb_handle->option(SSDB::OPT_COMPRESSION, SSDB::COMPRESSION_ZSTD));
+        $this->assertSame("\xC0", $this->ssdb_handle->get('compression_raw'));
+        $this->assertSame("\xC0abcdefg", $this->ssdb_handle->get('compression_raw2'));
+        $this->assertTrue($this->ssdb_handle->del('compression_raw2'));
+        $this->assertTrue($this->ssdb_handle->del('compression_raw'));
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_COMPRESSION, SSDB::COMPRESSION_NONE));
+        $this->assertNotEquals($value, $this->ssdb_handle->get('compression'));
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_COMPRESSION, SSDB::COMPRESSION_LZ4) || $this->ssdb_handle->option(SSDB::OPT_COMPRESSION, SSDB::COMPRESSION_ZSTD));
+        $this->assertEquals($value, $this->ssdb_handle->get('compression'));
+        $this->assertTrue($this->ssdb_handle->del('compression'));
+        $this->assertEquals(1, $this->ssdb_handle->hclear('compression_hash'));
+    }
+
+    public function testCompressionDict() {
+        if (!$this->ssdb_handle->option(SSDB::OPT_COMPRESSION, SSDB::COMPRESSION_ZSTD_DICT)) {
+            $this->markTestSkipped('ssdb.compression_dict not loaded');
+        }
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_COMPRESSION_THRESHOLD, 64));
+        $value = json_encode(array('id' => 10001, 'name' => 'xingqiba', 'tags' => array('a', 'b', 'c'), 'bio' => str_repeat('dict ', 40)));
+        $this->assertTrue($this->ssdb_handle->hset('compression_dict', 'f', $value));
+        $this->assertEquals($value, $this->ssdb_handle->hget('compression_dict', 'f'));
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_COMPRESSION, SSDB::COMPRESSION_ZSTD));
+        $this->assertEquals($value, $this->ssdb_handle->hget('compression_dict', 'f'));
+        $this->assertEquals(1, $this->ssdb_handle->hclear('compression_dict'));
+    }
+
+    public function testNoreply() {
+        $this->assertSame($this->ssdb_handle, $this->ssdb_handle->noreply());
+        $this->assertTrue($this->ssdb_handle->incr('noreply_hits', 2));
+        $this->assertEquals(3, $this->ssdb_handle->incr('noreply_hits'));
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_NOREPLY, 1));
+        $this->assertTrue($this->ssdb_handle->hincr('noreply_hash', 'a', 5));
+        $this->assertTrue($this->ssdb_handle->qpush_back('noreply_queue', 'x'));
+        $this->assertTrue($this->ssdb_handle->ping());
+        $this->assertInternalType('int', $this->ssdb_handle->dbsize());
+        $this->assertEquals('5', $this->ssdb_handle->hget('noreply_hash', 'a'));
+        $this->assertEquals('x', $this->ssdb_handle->qpop_front('noreply_queue'));
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_NOREPLY, 0));
+        $this->assertTrue($this->ssdb_handle->del('noreply_hits'));
+        $this->assertEquals(1, $this->ssdb_handle->hclear('noreply_hash'));
+    }
+
+    public function testDefer() {
+        for ($i = 0; $i < 10; $i++) {
+            $this->assertTrue($this->ssdb_handle->defer()->incr('defer_hits'));
+            $this->assertTrue($this->ssdb_handle->defer()->hincr('defer_hash', 'a', 2));
+        }
+        $this->assertTrue($this->ssdb_handle->defer()->del('defer_hits'));
+        $this->assertTrue($this->ssdb_handle->defer()->incr('defer_hits', 5));
+        $this->assertNull($this->ssdb_handle->get('defer_hits'));
+        $this->assertEquals(4, $this->ssdb_handle->flush());
+        $this->assertEquals(0, $this->ssdb_handle->flush());
+        $this->assertEquals('5', $this->ssdb_handle->get('defer_hits'));
+        $this->assertEquals('20', $this->ssdb_handle->hget('defer_hash', 'a'));
+        $this->assertTrue($this->ssdb_handle->del('defer_hits'));
+        $this->assertEquals(1, $this->ssdb_handle->hclear('defer_hash'));
+    }
+
+    public function testDeferReadCache() {
+        $this->assertTrue($this->ssdb_handle->set('defer_cache', 'old'));
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_READ_CACHE, 1));
+        $this->assertTrue($this->ssdb_handle->defer()->set('defer_cache', 'new'));
+        $this->assertEquals('old', $this->ssdb_handle->get('defer_cache'));
+        $this->assertEquals(1, $this->ssdb_handle->flush());
+        $this->assertEquals('new', $this->ssdb_handle->get('defer_cache'));
+        $this->assertEquals('new', $this->ssdb_handle->get('defer_cache'));
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_READ_CACHE, 0));
+        $this->assertTrue($this->ssdb_handle->del('defer_cache'));
+    }
+
+    public function testBatch() {
+        $this->assertTrue($this->ssdb_handle->set('batch_a', 'a'));
+        $this->assertTrue($this->ssdb_handle->hset('batch_hash', 'f', 'v'));
+        $this->assertTrue($this->ssdb_handle->zset('batch_zset', 'm', 7));
+        $promises = $this->ssdb_handle->batch(function ($ssdb) {
+            return array($ssdb->get('batch_a'), $ssdb->get('batch_a'), $ssdb->get('batch_none'), $ssdb->hget('batch_hash', 'f'), $ssdb->zget('batch_zset', 'm'));
+        });
+        $this->assertInstanceOf('SSDBPromise', $promises[0]);
+        $this->assertTrue($promises[0]->isResolved());
+        $this->assertEquals(array('a', 'a', null, 'v', 7), array_map(function ($promise) { return $promise->value(); }, $promises));
+        $this->ssdb_handle->beginBatch();
+        $promise = $this->ssdb_handle->get('batch_a');
+        $this->assertFalse($promise->isResolved());
+        $this->assertEquals('a', $promise->value());
+        $this->assertTrue($this->ssdb_handle->endBatch());
+        $this->assertFalse($this->ssdb_handle->endBatch());
+        $this->assertTrue($this->ssdb_handle->del('batch_a'));
+        $this->assertEquals(1, $this->ssdb_handle->hclear('batch_hash'));
+        $this->assertEquals(1, $this->ssdb_handle->zclear('batch_zset'));
+    }
+
+    public function testBatchOrder() {
+        $this->assertTrue($this->ssdb_handle->set('batch_order', 1));
+        $this->ssdb_handle->beginBatch();
+        $before = $this->ssdb_handle->get('batch_order');
+        $this->assertTrue($this->ssdb_handle->set('batch_order', 2));
+        $this->assertTrue($before->isResolved());
+        $after = $this->ssdb_handle->get('batch_order');
+        $this->assertEquals(3, $this->ssdb_handle->incr('batch_order'));
+        $this->assertTrue($this->ssdb_handle->endBatch());
+        $this->assertEquals('1', $before->value());
+        $this->assertEquals('2', $after->value());
+        $this->assertTrue($this->ssdb_handle->del('batch_order'));
+    }
+
+    public function testResultSet() {
+        $this->assertEquals(2, $this->ssdb_handle->multi_hset('result_set', array('a' => 1, 'b' => 2)));
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_RESULT_SET, 1));
+        $result = $this->ssdb_handle->hscan('result_set', '', '', 10);
+        $this->assertInstanceOf('SSDBResultSet', $result);
+        $this->assertCount(2, $result);
+        $this->assertEquals(array('a', 'b'), $result->keys());
+        $this->assertEquals('2', $result['b']);
+        $this->assertNull($result['c']);
+        $this->assertEquals(array('a' => '1', 'b' => '2'), iterator_to_array($result));
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_RESULT_SET, 0));
+        $this->assertEquals(array('a' => '1', 'b' => '2'), $this->ssdb_handle->hscan('result_set', '', '', 10));
+        $this->assertEquals(2, $this->ssdb_handle->hclear('result_set'));
+    }
+
+    public function testScanIterator() {
+        $this->assertEquals(5, $this->ssdb_handle->multi_hset('scan_iterator', array('a' => 1, 'b' => 2, 'c' => 3, 'd' => 4, 'e' => 5)));
+        $iterator = $this->ssdb_handle->scanIterator('hscan', '', '', 2, 'scan_iterator');
+        $this->assertInstanceOf('SSDBScanIterator', $iterator);
+        $this->assertEquals(array('a' => '1', 'b' => '2', 'c' => '3', 'd' => '4', 'e' => '5'), iterator_to_array($iterator));
+        $this->assertEquals(array('e' => '5', 'd' => '4'), iterator_to_array(new LimitIterator($this->ssdb_handle->scanIterator('hrscan', '', '', 2, 'scan_iterator'), 0, 2)));
+        $this->assertEquals(5, $this->ssdb_handle->hclear('scan_iterator'));
+    }
+
+    public function testScanPrefetch() {
+        $this->assertEquals(5, $this->ssdb_handle->multi_hset('scan_prefetch', array('a' => 1, 'b' => 2, 'c' => 3, 'd' => 4, 'e' => 5)));
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_SCAN_PREFETCH, 1));
+        $result = array();
+        foreach ($this->ssdb_handle->scanIterator('hscan', '', '', 2, 'scan_prefetch') as $key => $value) {
+            //预取请求未读取时插入同步命令
+            $this->assertEquals($value, $this->ssdb_handle->hget('scan_prefetch', $key));
+            $result[$key] = $value;
+        }
+        $this->assertEquals(array('a' => '1', 'b' => '2', 'c' => '3', 'd' => '4', 'e' => '5'), $result);
+        foreach ($this->ssdb_handle->scanIterator('hscan', '', '', 2, 'scan_prefetch') as $key => $value) {
+            break;
+        }
+        $this->assertEquals('1', $this->ssdb_handle->hget('scan_prefetch', 'a'));
+        $this->assertTrue($this->ssdb_handle->option(SSDB::OPT_SCAN_PREFETCH, 0));
+        $this->assertEquals(5, $this->ssdb_handle->hclear('scan_prefetch'));
+    }
+
+    public function testPool() {
+        ini_set('ssdb.pool_max_idle', 2);
+        $ssdb = new SSDB();
+        $this->assertTrue($ssdb->pconnect('127.0.0.1', 8888));
+        $this->assertTrue($ssdb->close());
+        $this->assertTrue($ssdb->pconnect('127.0.0.1', 8888));
+        $this->assertTrue($ssdb->ping());
+        $stats = ssdb_pool_stats();
+        $this->assertArrayHasKey('phpssdb:127.0.0.1:8888:30', $stats);
+        $this->assertEquals(1, $stats['phpssdb:127.0.0.1:8888:30']['active']);
+        $this->assertGreaterThanOrEqual(1, $stats['phpssdb:127.0.0.1:8888:30']['hits']);
+        $this->assertTrue($ssdb->close());
+        ini_set('ssdb.pool_max_idle', 0);
+    }
+
+    public function testConnectMulti() {
+        $ssdb = new SSDB();
+        $this->assertTrue($ssdb->connectMulti(array('127.0.0.1:1', '127.0.0.1:8888'), 3));
+        $this->assertTrue($ssdb->ping());
+        $this->assertTrue($ssdb->connectMulti(array('127.0.0.1:8888', '127.0.0.1:1'), 3, true));
+        $this->assertTrue($ssdb->ping());
+        $this->assertFalse($ssdb->connectMulti(array('127.0.0.1:1'), 1));
+    }
+
+    public function testReadPolicy() {
+        $ssdb = new SSDB();
+        $this->assertTrue($ssdb->connectMulti(array('127.0.0.1:8888', 'localhost:8888'), 3, true));
+        $this->assertTrue($ssdb->option(SSDB::OPT_READ_POLICY, SSDB::READ_ROUND_ROBIN));
+        $this->assertTrue($ssdb->set('read_policy', 'replica'));
+        for ($i = 0; $i < 4; $i++) {
+            $this->assertEquals('replica', $ssdb->get('read_policy'));
+        }
+        $this->assertTrue($ssdb->option(SSDB::OPT_READ_POLICY, SSDB::READ_LATENCY));
+        $this->assertEquals('replica', $ssdb->get('read_policy'));
+        $this->assertFalse($ssdb->option(SSDB::OPT_READ_POLICY, 9));
+        $this->assertTrue($ssdb->del('read_policy'));
+    }
+
+    public function testBatchReadPolicy() {
+        $ssdb = new SSDB();
+        $this->assertTrue($ssdb->connectMulti(array('127.0.0.1:8888', 'localhost:8888'), 3, true));
+        $this->assertTrue($ssdb->option(SSDB::OPT_READ_POLICY, SSDB::READ_ROUND_ROBIN));
+        $this->assertTrue($ssdb->set('batch_route', 'a'));
+        $this->assertTrue($ssdb->hset('batch_route_hash', 'f', 'v'));
+        $this->assertTrue($ssdb->zset('batch_route_zset', 'm', 3));
+        $ssdb->beginBatch();
+        $get = $ssdb->get('batch_route');
+        $hget = $ssdb->hget('batch_route_hash', 'f');
+        $zget = $ssdb->zget('batch_route_zset', 'm');
+        $this->assertEquals(1, $ssdb->hsize('batch_route_hash'));
+        $this->assertTrue($get->isResolved());
+        $this->assertEquals(1, $ssdb->hsize('batch_route_hash'));
+        $this->assertTrue($ssdb->endBatch());
+        $this->assertEquals('a', $get->value());
+        $this->assertEquals('v', $hget->value());
+        $this->assertEquals(3, $zget->value());
+        $this->assertEquals('a', $ssdb->get('batch_route'));
+        $this->assertTrue($ssdb->del('batch_route'));
+        $this->assertEquals(1, $ssdb->hclear('batch_route_hash'));
+        $this->assertEquals(1, $ssdb->zclear('batch_route_zset'));
+    }
+
+    public function testCluster() {
+        $cluster = new SSDBCluster(array('127.0.0.1:8888', 'localhost:8888'), SSDBCluster::HASH_KETAMA);
+        $this->assertTrue($cluster->option(SSDB::OPT_PREFIX, 'test_'));
+        $this->assertTrue($cluster->set('cluster_a', 'a'));
+        $this->assertEquals('a', $cluster->get('cluster_a'));
+        $this->assertInstanceOf('SSDB', $cluster->node('cluster_a'));
+        $this->assertEquals(2, $cluster->multi_set(array('cluster_b' => 'b', 'cluster_c' => 'c')));
+        $this->assertEquals(array('cluster_c' => 'c', 'cluster_a' => 'a', 'cluster_b' => 'b'), $cluster->multi_get(array('cluster_c', 'cluster_x', 'cluster_a', 'cluster_b')));
+        $this->assertEquals(3, $cluster->multi_del(array('cluster_a', 'cluster_b', 'cluster_c')));
+        $this->assertCount(2, $cluster->nodes());
+    }
+
+    public function testClusterReadCache() {
+        $cluster = new SSDBCluster(array('127.0.0.1:8888', 'localhost:8888'));
+        $this->assertTrue($cluster->option(SSDB::OPT_PREFIX, 'test_'));
+        $this->assertTrue($cluster->option(SSDB::OPT_READ_CACHE, 1));
+        $this->assertTrue($cluster->set('cluster_cache', 'a'));
+        $this->assertEquals('a', $cluster->get('cluster_cache'));
+        $this->assertEquals(1, $cluster->multi_set(array('cluster_cache' => 'b')));
+        $this->assertEquals('b', $cluster->get('cluster_cache'));
+        $this->assertEquals(1, $cluster->multi_del(array('cluster_cache')));
+        $this->assertNull($cluster->get('cluster_cache'));
+    }
+
+    public function testMultiSetLargeValue() {
+        $values = array('writev_a' => str_repeat('a', 65536), 'writev_b' => 'b', 'writev_c' => str_repeat('c', 8192));
+        $this->assertEquals(3, $this->ssdb_handle->multi_set($values));
+        $this->assertEquals($values, $this->ssdb_handle->multi_get(array_keys($values)));
+        $this->assertEquals(3, $this->ssdb_handle->multi_del(array_keys($values)));
+    }
+
+    public function testBinaryMapKey() {
+        $values = array(10 => 'z', "a\0b" => 'x', "a\0c" => 'y');
+        $this->assertEquals(3, $this->ssdb_handle->multi_hset('binary_map', $values));
+        $this->assertSame($values, $this->ssdb_handle->hgetall('binary_map'));
+        $this->assertEquals(3, $this->ssdb_handle->hclear('binary_map'));
+    }
+
+    public function testCommandTable() {
+        $this->assertTrue($this->ssdb_handle->zset('big_score', 'a', 9007199254740993));
+        $this->assertSame(9007199254740993, $this->ssdb_handle->zget('big_score', 'a'));
+        $this->assertSame(9007199254740994, $this->ssdb_handle->zincr('big_score', 'a', 1));
+        $this->assertSame(array('a' => 9007199254740994), $this->ssdb_handle->zrange('big_score', 0, 10));
+        $this->assertNull($this->ssdb_handle->zrange('big_score', 0, 0));
+        $this->assertEquals(1, $this->ssdb_handle->zclear('big_score'));
+        $this->assertNull($this->ssdb_handle->expire('', 10));
+    }
+
     public function testSet() {
         $this->assertTrue($this->ssdb_handle->set('name', 'xingqiba'));
     }
@@ -110,5 +446,27 @@ class SSDBTest extends PHPUnit_Framework_TestCase {
         $this->assertEquals(strlen("xingqiba"), $this->ssdb_handle->strlen('name'));
     }
 
+    public function testPipeline() {
+        $this->assertSame($this->ssdb_handle, $this->ssdb_handle->pipeline());
+        $this->ssdb_handle->set('name', 'xingqiba')->get('name')->incr('hits', 2)->del('name');
+        $result = $this->ssdb_handle->exec();
+        $this->assertCount(4, $result);
+        $this->assertTrue($result[0]);
+        $this->assertEquals('xingqiba', $result[1]);
+        $this->assertEquals(2, $result[2]);
+        $this->assertTrue($result[3]);
+        $this->assertNull($this->ssdb_handle->get('name'));
+        $this->assertTrue($this->ssdb_handle->del('hits'));
+
+        $this->ssdb_handle->pipeline();
+        try {
+            $this->ssdb_handle->write("4\nping\n\n");
+            $this->fail('write() should throw in pipeline mode');
+        } catch (SSDBException $e) {
+            $this->assertEquals('Command not supported in pipeline mode', $e->getMessage());
+        }
+        $this->assertEquals(array(), $this->ssdb_handle->exec());
+    }
+
 
 }
\ No newline at end of file